@@ -0,0 +1,60 @@
+// Firmware globals and render entry points shared between main.cpp, the
+// support modules and the host-side tests
+#ifndef APP_H
+#define APP_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+#include <Adafruit_SSD1306.h>
+#include <ChronosESP32.h>
+#include "oled_flush.h"
+#include "lcd_flush.h"
+#include "icon_cache.h"
+#include "redraw_trigger.h"
+#include "nav_snapshot.h"
+#include "i2c_bus.h"
+#include "display_registry.h"
+
+#define LCD_ADDRESS 0x27
+#define OLED_ADDRESS 0x3C
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+
+// Fastest clocks tried on each panel: the SSD1306 usually runs well past
+// its rated 400 kHz, the PCF8574 backpack (rated 100 kHz) often manages
+// 400 kHz; the self-test settles what this unit can really do
+#define OLED_I2C_MAX_CLOCK I2C_CLOCK_FAST_PLUS
+#define LCD_I2C_MAX_CLOCK I2C_CLOCK_FAST
+
+// The LCD takes at most one model per interval (the OLED takes every one):
+// its liquid crystal needs a few hundred ms to settle anyway, and its
+// transfers then never hold the OLED back
+#define LCD_MIN_FRAME_MS 250
+
+// Switched with a double press of the BOOT button
+enum DisplayPage
+{
+  PAGE_MAIN, // navigation, or connection status
+  PAGE_TRIP, // clock and trip summary
+  PAGE_COUNT
+};
+
+// Stepped by holding the second press of a double press
+#define BRIGHTNESS_LEVELS 4
+
+extern I2cBus i2cBus;
+extern LiquidCrystal_I2C lcd;
+extern Adafruit_SSD1306 oled;
+extern OledDeltaFlush oledFlush;
+extern LcdTextFlush lcdFlush;
+extern IconCache iconCache;
+extern DisplayRegistry displays;
+extern ChronosESP32 Chronos;
+extern RedrawTrigger redrawTrigger;
+extern uint32_t displayFrameCount; // Models handed to the displays
+extern uint32_t chronosMaxGapUs;   // Longest time between two Chronos.loop() calls
+
+void updateDisplayLCD(const NavSnapshot &nav);
+void updateDisplayOLED(const NavSnapshot &nav);
+
+#endif
@@ -0,0 +1,43 @@
+// Page-native 1-bpp bitmap blitter for the SSD1306 buffer
+// Adafruit_GFX::drawBitmap() goes through drawPixel() for every set bit.
+// blitBitmap() instead transposes each 8x8 block of the row-major source
+// with 32-bit word operations and ORs (or clears / XORs) whole page bytes.
+// A destination y on a page boundary writes each byte once; other y values
+// split every byte across two pages. Clipped or rotated draws fall back to
+// drawBitmap().
+#ifndef BITMAP_BLIT_H
+#define BITMAP_BLIT_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+
+struct BlitStats
+{
+  uint32_t aligned;   // blits with y on a page boundary
+  uint32_t unaligned; // blits shifted across page boundaries
+  uint32_t fallbacks; // clipped/rotated blits handed to drawBitmap()
+};
+
+// Same arguments and result as Adafruit_GFX::drawBitmap() (transparent
+// background; color is SSD1306_WHITE, SSD1306_BLACK or SSD1306_INVERSE)
+void blitBitmap(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t *bitmap,
+                int16_t w, int16_t h, uint16_t color);
+
+// Convert a row-major bitmap to page-major bytes: (h + 7) / 8 pages of w
+// bytes each, LSB on top, as the SSD1306 buffer stores them
+void bitmapToPages(const uint8_t *bitmap, int16_t w, int16_t h, uint8_t *pages);
+
+// Draw bitmapToPages() output at a page-aligned, fully visible position.
+// Returns false (drawing nothing) otherwise.
+bool blitPages(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t *pages,
+               int16_t w, int16_t h, uint16_t color);
+
+const BlitStats &blitStats();
+
+// On-target check and timing against drawBitmap(); build with -DBLIT_BENCH
+// and it runs once from setup(). Leaves the display buffer cleared.
+#ifdef BLIT_BENCH
+void blitBenchmark(Adafruit_SSD1306 &display, Print &out);
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+// Interrupt-driven gestures on the BOOT button
+// An edge ISR timestamps every level change into a small lock-free queue;
+// buttonPoll() debounces the edges and runs the gesture state machine on
+// them, so press timing does not depend on how long a loop() iteration
+// took. The pin itself is only read back once after the debounce dropped
+// an edge or the queue overflowed, to catch a bounce that ended opposite
+// to the last accepted edge.
+//
+//   short   press < BUTTON_SHORT_MAX, no second press within BUTTON_DOUBLE_GAP
+//   double  two short presses
+//   repeat  second press held: fires after BUTTON_REPEAT_DELAY, then every
+//           BUTTON_REPEAT_INTERVAL until released
+//   long    held for BUTTON_LONG_PRESS (fires while still held)
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <Arduino.h>
+
+#define BUTTON_DEBOUNCE_MS 30
+#define BUTTON_SHORT_MAX 1000
+#define BUTTON_DOUBLE_GAP 300
+#define BUTTON_REPEAT_DELAY 500
+#define BUTTON_REPEAT_INTERVAL 250
+#define BUTTON_LONG_PRESS 3000
+
+#define BUTTON_QUEUE_SIZE 16 // power of two
+
+enum ButtonGesture : uint8_t
+{
+  GESTURE_NONE,
+  GESTURE_SHORT,
+  GESTURE_DOUBLE,
+  GESTURE_REPEAT,
+  GESTURE_LONG,
+};
+
+struct ButtonStats
+{
+  uint32_t edges;     // edges seen by the ISR
+  uint32_t bounces;   // edges dropped by the debounce
+  uint32_t overflows; // edges lost to a full queue
+  uint32_t gestures;  // gestures reported
+};
+
+// Active-low button with pull-up; attaches the edge interrupt
+void buttonBegin(uint8_t pin);
+
+// Next recognised gesture, or GESTURE_NONE. Call until it returns NONE.
+ButtonGesture buttonPoll();
+
+// Time until a held or released button can produce a gesture without
+// another edge (0xFFFFFFFF when nothing is pending)
+uint32_t buttonMsUntilDue();
+
+const ButtonStats &buttonStats();
+
+#endif
@@ -0,0 +1,217 @@
+// Declarative screen layouts
+// Each widget is one row of a table: the NavSnapshot field it shows, its
+// box, text size and how over-long text is fitted. The renderers draw from
+// these tables, static_asserts keep every box on the panel and clear of
+// the others. Host previews and the golden-image tests
+// (test/test_render_golden) render through the same tables.
+#ifndef DISPLAY_LAYOUT_H
+#define DISPLAY_LAYOUT_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "nav_snapshot.h"
+#include "icon_cache.h"
+#include "text_fit.h"
+
+#define LAYOUT_GLYPH_WIDTH 6 // classic GFX font cell: 5 px glyph + 1 px spacing
+#define LAYOUT_GLYPH_HEIGHT 8
+
+#define LAYOUT_OLED_WIDTH 128
+#define LAYOUT_OLED_HEIGHT 64
+#define LAYOUT_LCD_COLS 16
+#define LAYOUT_LCD_ROWS 2
+
+// Marquee: over-long text scrolls MARQUEE_STEP_PX every MARQUEE_STEP_MS,
+// resting at the start of the text for MARQUEE_PAUSE_MS each pass
+#define MARQUEE_STEP_MS 50
+#define MARQUEE_STEP_PX 2
+#define MARQUEE_PAUSE_MS 1500
+#define MARQUEE_GAP_PX 32 // between the end of the text and its next pass
+#define MARQUEE_IDLE 0xFFFFFFFF
+
+enum LayoutField : uint8_t
+{
+  FIELD_ETA,
+  FIELD_TITLE,
+  FIELD_DURATION,
+  FIELD_DISTANCE,
+  FIELD_DIRECTIONS,
+  FIELD_CLOCK,
+  FIELD_ICON, // 48x48 turn icon
+};
+
+enum LayoutFit : uint8_t
+{
+  FIT_CLIP,     // cut at the box edge
+  FIT_ELLIPSIS, // cut short and end with "..."
+  FIT_WRAP,     // word-wrap; what does not fit flows on into the next widget of the same field
+  FIT_MARQUEE,  // one line; scrolls horizontally when the text does not fit
+  FIT_BITMAP,   // not text
+};
+
+// OLED navigation screen, in pixels:
+//   id, field, x, y, w, h, text size, fit
+#define OLED_NAV_LAYOUT(X)                                             \
+  X(OLED_ETA, FIELD_ETA, 0, 0, 48, 8, 1, FIT_CLIP)                     \
+  X(OLED_TITLE, FIELD_TITLE, 68, 0, 60, 16, 2, FIT_CLIP)               \
+  X(OLED_ICON, FIELD_ICON, 0, 8, 48, 48, 0, FIT_BITMAP)                \
+  X(OLED_DURATION, FIELD_DURATION, 68, 30, 48, 8, 1, FIT_CLIP)         \
+  X(OLED_DISTANCE, FIELD_DISTANCE, 68, 40, 48, 8, 1, FIT_CLIP)         \
+  X(OLED_DIRECTIONS_TOP, FIELD_DIRECTIONS, 50, 48, 78, 8, 1, FIT_WRAP) \
+  X(OLED_DIRECTIONS, FIELD_DIRECTIONS, 0, 56, 128, 8, 1, FIT_MARQUEE)
+
+// LCD navigation line, in character cells (row 0 is clock and status)
+#define LCD_NAV_LAYOUT(X)                                              \
+  X(LCD_DISTANCE, FIELD_DISTANCE, 0, 1, 7, 1, 1, FIT_CLIP)             \
+  X(LCD_DIRECTIONS, FIELD_DIRECTIONS, 8, 1, 8, 1, 1, FIT_CLIP)
+
+struct LayoutWidget
+{
+  LayoutField field;
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+  uint8_t size;
+  LayoutFit fit;
+};
+
+#define LAYOUT_ROW(id, field, x, y, w, h, size, fit) {field, x, y, w, h, size, fit},
+#define LAYOUT_ID(id, field, x, y, w, h, size, fit) id,
+
+enum OledWidget : uint8_t
+{
+  OLED_NAV_LAYOUT(LAYOUT_ID) OLED_WIDGET_COUNT
+};
+enum LcdWidget : uint8_t
+{
+  LCD_NAV_LAYOUT(LAYOUT_ID) LCD_WIDGET_COUNT
+};
+
+constexpr LayoutWidget oledNavLayout[] = {OLED_NAV_LAYOUT(LAYOUT_ROW)};
+constexpr LayoutWidget lcdNavLayout[] = {LCD_NAV_LAYOUT(LAYOUT_ROW)};
+
+#undef LAYOUT_ROW
+#undef LAYOUT_ID
+
+// Compile-time checks (single-expression constexpr, so C++11 is enough)
+constexpr bool layoutInside(const LayoutWidget &w, int16_t width, int16_t height)
+{
+  return w.x >= 0 && w.y >= 0 && w.w > 0 && w.h > 0 && w.x + w.w <= width && w.y + w.h <= height;
+}
+
+constexpr bool layoutOverlap(const LayoutWidget &a, const LayoutWidget &b)
+{
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+// Text widgets must hold at least one glyph at their size
+constexpr bool layoutFitsGlyph(const LayoutWidget &w, int16_t glyphW, int16_t glyphH)
+{
+  return w.fit == FIT_BITMAP || (w.w >= glyphW * w.size && w.h >= glyphH * w.size);
+}
+
+constexpr bool layoutAllInside(const LayoutWidget *w, size_t n, int16_t width, int16_t height)
+{
+  return n == 0 || (layoutInside(w[0], width, height) && layoutAllInside(w + 1, n - 1, width, height));
+}
+
+constexpr bool layoutClearOf(const LayoutWidget &a, const LayoutWidget *w, size_t n)
+{
+  return n == 0 || (!layoutOverlap(a, w[0]) && layoutClearOf(a, w + 1, n - 1));
+}
+
+constexpr bool layoutNoOverlaps(const LayoutWidget *w, size_t n)
+{
+  return n < 2 || (layoutClearOf(w[0], w + 1, n - 1) && layoutNoOverlaps(w + 1, n - 1));
+}
+
+constexpr bool layoutAllFitGlyphs(const LayoutWidget *w, size_t n, int16_t glyphW, int16_t glyphH)
+{
+  return n == 0 || (layoutFitsGlyph(w[0], glyphW, glyphH) && layoutAllFitGlyphs(w + 1, n - 1, glyphW, glyphH));
+}
+
+static_assert(layoutAllInside(oledNavLayout, OLED_WIDGET_COUNT, LAYOUT_OLED_WIDTH, LAYOUT_OLED_HEIGHT),
+              "OLED widget outside the 128x64 panel");
+static_assert(layoutNoOverlaps(oledNavLayout, OLED_WIDGET_COUNT), "OLED widgets overlap");
+static_assert(layoutAllFitGlyphs(oledNavLayout, OLED_WIDGET_COUNT, LAYOUT_GLYPH_WIDTH, LAYOUT_GLYPH_HEIGHT),
+              "OLED widget smaller than one glyph");
+// Marquee rows are one full-width page: the panel edge clips the scrolling
+// text, and every step rewrites that page and nothing else
+constexpr bool layoutMarqueeRows(const LayoutWidget *w, size_t n, int16_t width)
+{
+  return n == 0 || ((w[0].fit != FIT_MARQUEE || (w[0].x == 0 && w[0].w == width && w[0].y % 8 == 0 &&
+                                                  w[0].h == LAYOUT_GLYPH_HEIGHT && w[0].size == 1)) &&
+                    layoutMarqueeRows(w + 1, n - 1, width));
+}
+
+static_assert(layoutMarqueeRows(oledNavLayout, OLED_WIDGET_COUNT, LAYOUT_OLED_WIDTH),
+              "OLED marquee must be a full-width, page-aligned size-1 row");
+static_assert(layoutAllInside(lcdNavLayout, LCD_WIDGET_COUNT, LAYOUT_LCD_COLS, LAYOUT_LCD_ROWS),
+              "LCD widget outside the 16x2 panel");
+static_assert(layoutNoOverlaps(lcdNavLayout, LCD_WIDGET_COUNT), "LCD widgets overlap");
+
+// The snapshot text a widget shows ("" for bitmaps)
+const char *layoutText(const NavSnapshot &nav, LayoutField field);
+
+struct LayoutStats
+{
+  uint32_t drawn;   // widgets rasterised
+  uint32_t skipped; // widgets unchanged since the last frame
+  uint32_t marqueeSteps;
+};
+
+// Per-widget dirty state for one screen: a widget is redrawn only when the
+// content it shows changed. invalidate() whenever the rest of the buffer
+// was redrawn (screen switch, splash), which makes every widget dirty and
+// stops the marquee until the next draw().
+//
+// The marquee is stepped by animate() between frames and redraws only its
+// own page, so the delta flush sends one page (~140 bytes) per step
+// instead of a frame. The SSD1306 continuous-scroll commands are not used:
+// they rotate the 128 columns already in GDDRAM (there is no off-screen
+// strip to feed new text from), and while they run the panel RAM no longer
+// matches the flush shadow, so every later update would need a full frame.
+class OledLayoutRenderer
+{
+public:
+  // Redraw the changed widgets in the display buffer (all of it after
+  // invalidate())
+  void draw(Adafruit_SSD1306 &display, IconCache &icons, const NavSnapshot &nav);
+
+  // Scroll the marquee one step if due; true when the buffer changed
+  bool animate(Adafruit_SSD1306 &display);
+
+  // ms until animate() has a step to draw (MARQUEE_IDLE when nothing scrolls)
+  uint32_t msUntilAnimate() const;
+
+  void invalidate()
+  {
+    valid = false;
+    marqueeOn = false;
+  }
+
+  const LayoutStats &stats() const { return counters; }
+
+private:
+  // Returns how much of text the widget took (see FIT_WRAP)
+  size_t drawText(Adafruit_SSD1306 &display, const LayoutWidget &w, const char *text);
+  void drawMarquee(Adafruit_SSD1306 &display);
+
+  uint32_t prints[OLED_WIDGET_COUNT];
+  bool valid = false;
+
+  // Text of the scrolling widget, kept for the steps between frames
+  char marqueeText[NAV_TEXT_LONG];
+  const LayoutWidget *marqueeWidget = nullptr;
+  bool marqueeOn = false;
+  int16_t marqueeOffset = 0;  // pixels scrolled
+  int16_t marqueePeriod = 0;  // text width plus gap
+  unsigned long marqueeAt = 0; // millis() of the next step
+  LayoutStats counters = {};
+};
+
+// Write a widget's text into its cells of a 16-character LCD row
+void layoutLcdText(char *row, const LayoutWidget &w, const char *text);
+
+#endif
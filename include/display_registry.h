@@ -0,0 +1,98 @@
+// Every panel found on the bus, each refreshed at its own pace
+// The render model (NavSnapshot) is built once per change by the redraw
+// trigger and handed to submit(). Each registered panel draws it through
+// its own callbacks and keeps its own dirty state (flush shadows, widget
+// prints), and a panel with a minimum frame interval only takes the latest
+// model once that interval has passed. A slow HD44780 update therefore
+// never delays an OLED frame: the panels' transfers are stepped side by
+// side and each one's frames complete independently.
+#ifndef DISPLAY_REGISTRY_H
+#define DISPLAY_REGISTRY_H
+
+#include <Arduino.h>
+#include "nav_snapshot.h"
+
+#define DISPLAY_MAX 2
+#define DISPLAY_IDLE 0xFFFFFFFF
+
+enum DisplayType : uint8_t
+{
+  DISPLAY_NONE,
+  DISPLAY_LCD,
+  DISPLAY_OLED
+};
+
+// How the registry drives one panel
+struct DisplayOps
+{
+  void (*draw)(const NavSnapshot &nav); // draw the model and commit it
+  bool (*service)();                    // send the next slice; true once idle
+  uint32_t (*animate)();                // optional, see DisplayRegistry::animate()
+};
+
+struct DisplayStats
+{
+  uint32_t frames;        // models drawn
+  uint32_t framesDone;    // ... and fully sent
+  uint32_t deferred;      // models held back by the frame interval
+  uint32_t superseded;    // ... and replaced by a newer one before drawing
+  uint32_t lastLatencyUs; // event to pixels for the last event-driven frame
+  uint32_t maxLatencyUs;
+};
+
+class DisplayRegistry
+{
+public:
+  // Forget every panel (before probing the bus again)
+  void clear() { count = 0; }
+
+  // Register a panel; minFrameMs paces its redraws (0 = every model)
+  bool add(DisplayType type, uint32_t minFrameMs, const DisplayOps &ops);
+
+  bool has(DisplayType type) const;
+  bool empty() const { return count == 0; }
+
+  // Panels as a bit mask of (1 << DisplayType), for the boot cache
+  uint8_t mask() const;
+
+  // A new render model for every panel (copied: held-back panels draw it
+  // later)
+  void submit(const NavSnapshot &nav);
+
+  // Step every panel's transfer; true when all of them are idle
+  bool service();
+
+  // Draw held-back models whose interval has passed and step the
+  // animations of every panel whose own transfer is done, so a slow panel
+  // never holds back another one's marquee. 0 when something was queued,
+  // else ms until the next due item or DISPLAY_IDLE.
+  uint32_t animate();
+
+  const DisplayStats *stats(DisplayType type) const;
+
+private:
+  struct Device
+  {
+    DisplayType type;
+    uint32_t minFrameMs;
+    DisplayOps ops;
+    bool due;               // latest model not drawn yet
+    bool sending;           // a drawn frame is still going out
+    bool busy;              // its last service() had a transfer going
+    unsigned long drawnAt;  // millis() of the last draw
+    RedrawRequest inFlight; // request behind the frame being sent
+    DisplayStats stats;
+  };
+
+  bool drawDue();
+
+  Device devices[DISPLAY_MAX];
+  uint8_t count = 0;
+  NavSnapshot latest = {};
+};
+
+// Called by the registry when a panel's frame is fully sent; implemented by
+// the application
+void displayFrameDone(DisplayType type, bool primary, const RedrawRequest &request);
+
+#endif
@@ -0,0 +1,35 @@
+// Free-heap and fragmentation tracking for long drives
+// Samples the allocator counters every HEAP_REPORT_INTERVAL so a slow leak
+// or a fragmenting heap shows up in the log long before an allocation fails.
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+
+#define HEAP_REPORT_INTERVAL 60000
+
+struct HeapHealth
+{
+  uint32_t samples;
+  uint32_t freeBytes;       // free heap at the last sample
+  uint32_t minFreeBytes;    // allocator low-water mark since boot
+  uint32_t largestBlock;    // biggest single allocation possible right now
+  uint32_t minLargestBlock; // smallest largestBlock seen
+  uint8_t fragmentation;    // % of free heap outside the largest block
+  uint8_t maxFragmentation;
+  int32_t freeDrift;        // free heap now minus at the first sample
+};
+
+class HeapMonitor
+{
+public:
+  void sample();
+  void print(Print &out) const;
+  const HeapHealth &health() const { return current; }
+
+private:
+  HeapHealth current = {};
+  uint32_t firstFree = 0;
+};
+
+#endif
@@ -0,0 +1,143 @@
+// Shared I2C bus: per-device clock, error accounting and recovery
+// Each device is attached once. attach() runs a self-test at every
+// candidate clock up to the device's limit (fastest first) and keeps the
+// first clock that passes, so a panel that copes with 1 MHz gets it and a
+// marginal one falls back to 400 or 100 kHz. All transfers then go through
+// write(), which switches to the device's clock under the bus lock and
+// counts errors. Only probe() is retried after a NACK: Arduino-ESP32
+// reports a NACK on the address and on any data byte alike, and a device
+// that refused a data byte may already have taken the ones before it, so a
+// write is never resent here. Its failure goes back to the caller, whose
+// flush sends the window again from its address commands. If the lines
+// are found held low after a failure (a slave that lost sync keeps SDA
+// down), the bus is recovered with nine SCL pulses and a STOP.
+//
+// Code that drives the bus through a library (Adafruit_SSD1306,
+// LiquidCrystal_I2C) holds an I2cLock while it does.
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_SDA_PIN 21
+#define I2C_SCL_PIN 22
+
+#define I2C_CLOCK_STANDARD 100000
+#define I2C_CLOCK_FAST 400000
+#define I2C_CLOCK_FAST_PLUS 1000000
+
+#define I2C_SELF_TEST_ROUNDS 8 // transactions that must all pass per clock
+#define I2C_PROBE_RETRIES 2    // resends of a probe after a NACK
+#define I2C_RECOVERY_PULSES 9  // enough to clock out any byte a slave is sending
+#define I2C_RECOVERY_HALF_PERIOD_US 5
+#define I2C_MAX_DEVICES 4
+
+// endTransmission() result for a NACK, on the address or on a data byte
+// (Arduino-ESP32 2.x numbering)
+#define I2C_ERROR_NACK 2
+
+// How attach() checks a clock. Without readback every round writes all of
+// bytes as one transaction and needs it ACKed; with readback each round
+// writes one byte (cycling through bytes) and must read the same value back.
+struct I2cProbe
+{
+  const uint8_t *bytes;
+  uint8_t length;
+  bool readback;
+};
+
+struct I2cDeviceStats
+{
+  uint8_t address;
+  uint32_t clock;        // negotiated; 0 when the device did not answer
+  uint32_t transactions; // write() attempts
+  uint32_t errors;       // write() calls that failed
+  uint32_t retries;      // probes repeated after a NACK
+};
+
+struct I2cBusStats
+{
+  uint32_t stuck;            // times SDA or SCL was found held low
+  uint32_t recoveries;       // ... and released by the pulse sequence
+  uint32_t failedRecoveries; // ... and still low afterwards
+};
+
+class I2cBus
+{
+public:
+  // Take the pins (recovering a stuck bus first) and start the driver
+  bool begin(TwoWire *wire, uint8_t sda, uint8_t scl);
+
+  // Find the fastest clock up to maxClock the device passes probe at;
+  // returns it, or 0 when the device does not answer at all
+  uint32_t attach(uint8_t address, uint32_t maxClock, const I2cProbe &probe);
+
+  // Register a device at a clock it was attached at before (kept across
+  // deep sleep): no bus traffic. The caller's first write tells whether it
+  // is still there.
+  bool attachAt(uint8_t address, uint32_t clock);
+
+  // Address only, at the device's clock: true when it ACKs (retried, as
+  // nothing reaches the device)
+  bool probe(uint8_t address);
+
+  // One write transaction at the device's clock: data, or a control byte
+  // followed by data. Not retried; false when any byte was refused
+  bool write(uint8_t address, const uint8_t *data, size_t length);
+  bool write(uint8_t address, uint8_t control, const uint8_t *data, size_t length);
+
+  // Exclusive use of the bus for library calls; recursive, so a holder can
+  // still call write()
+  void lock();
+  void unlock();
+
+  // SDA or SCL held low while the bus should be idle
+  bool stuck() const;
+
+  // Nine SCL pulses and a STOP, then restart the driver; true when both
+  // lines are released
+  bool recover();
+
+  // Clock and counters of every device, one line each
+  void print(Print &out) const;
+
+  const I2cDeviceStats *device(uint8_t address) const;
+  const I2cBusStats &stats() const { return counters; }
+  uint8_t deviceCount() const { return devices; }
+  const I2cDeviceStats &deviceAt(uint8_t index) const { return table[index]; }
+
+private:
+  I2cDeviceStats *find(uint8_t address);
+  bool transfer(I2cDeviceStats *device, bool hasControl, uint8_t control, const uint8_t *data, size_t length);
+  bool selfTest(uint8_t address, const I2cProbe &probe);
+  void useClock(uint32_t clock);
+  void take();
+  void give();
+
+  TwoWire *wire = nullptr;
+  uint8_t sda = I2C_SDA_PIN;
+  uint8_t scl = I2C_SCL_PIN;
+  uint32_t clock = 0; // 0: unknown (a library may have changed it)
+  I2cDeviceStats table[I2C_MAX_DEVICES] = {};
+  uint8_t devices = 0;
+  I2cBusStats counters = {};
+#ifdef ARDUINO_ARCH_ESP32
+  SemaphoreHandle_t mutex = nullptr;
+#endif
+};
+
+// Holds the bus for the enclosing scope
+class I2cLock
+{
+public:
+  explicit I2cLock(I2cBus &bus) : bus(bus) { bus.lock(); }
+  ~I2cLock() { bus.unlock(); }
+  I2cLock(const I2cLock &) = delete;
+  I2cLock &operator=(const I2cLock &) = delete;
+
+private:
+  I2cBus &bus;
+};
+
+#endif
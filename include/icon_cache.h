@@ -0,0 +1,74 @@
+// Cache of navigation icons converted to SSD1306 page layout
+// Google Maps cycles through a small set of turn icons. Each one is keyed by
+// an FNV-1a hash of its 288 raw bytes; the page-major copy sits in a small
+// LRU and the most used entries are written to SPIFFS so they are warm
+// again after a reboot or deep sleep.
+#ifndef ICON_CACHE_H
+#define ICON_CACHE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <Adafruit_SSD1306.h>
+#include "nav_snapshot.h"
+
+#define ICON_WIDTH 48
+#define ICON_HEIGHT 48
+#define ICON_PAGE_BYTES (ICON_WIDTH * ((ICON_HEIGHT + 7) / 8))
+
+#define ICON_CACHE_SLOTS 8
+#define ICON_CACHE_FILE "/icons.bin"
+#define ICON_CACHE_SAVE_INTERVAL 600000 // Write new icons to flash at most every 10 minutes
+
+struct IconCacheStats
+{
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t restored;      // entries loaded from flash at boot
+  uint32_t restoredHits;  // hits on those entries
+  uint32_t saves;         // cache file writes
+  uint64_t convertCycles; // spent converting on misses (at PROF_CLOCK_MHZ)
+  uint64_t savedCycles;   // hits x average conversion cost (as saved with the file until a miss)
+};
+
+class IconCache
+{
+public:
+  // Load the persisted entries; fs may be null (RAM-only cache)
+  void begin(fs::FS *fs);
+
+  // Draw a 48x48 row-major icon, converting it only on a cache miss
+  void draw(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t icon[NAV_ICON_BYTES]);
+
+  // Write the cache file if entries changed since the last write; with
+  // force == false only once ICON_CACHE_SAVE_INTERVAL has passed
+  bool save(bool force);
+
+  const IconCacheStats &stats() const { return counters; }
+  void printStats(Print &out) const;
+
+private:
+  struct Entry
+  {
+    uint32_t hash;
+    uint32_t lastUse; // LRU clock value
+    uint16_t uses;
+    bool restored;
+    uint8_t pages[ICON_PAGE_BYTES];
+  };
+
+  Entry *find(uint32_t hash);
+  Entry *insert(uint32_t hash, const uint8_t *icon);
+  uint32_t convertCost() const; // average over this boot's misses, else the file's
+
+  fs::FS *fs = nullptr;
+  Entry entries[ICON_CACHE_SLOTS];
+  uint8_t count = 0;
+  uint32_t useClock = 0;
+  bool dirty = false;
+  unsigned long lastSave = 0;
+  uint32_t restoredCost = 0; // conversion cost stored with the cache file
+  IconCacheStats counters = {};
+};
+
+#endif
@@ -0,0 +1,89 @@
+// Shadow-DDRAM text transfer for the 16x2 I2C LCD
+// Keeps a copy of the 32 character cells on the panel and writes only the
+// cells that changed, moving the cursor only where a run of changes starts.
+// Characters go straight to the PCF8574 backpack: every nibble's
+// data/enable sequence for one step is packed into a single I2C
+// transaction, instead of LiquidCrystal_I2C's one transaction per expander
+// write (six per character). commit() takes the two rows and step() sends a
+// few cells per call, one frame at a time. A frame that hit a bus error is
+// written once more in full.
+#ifndef LCD_FLUSH_H
+#define LCD_FLUSH_H
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+
+#define LCD_COLS 16
+#define LCD_ROWS 2
+
+// Cells step() writes per call (and per I2C transaction) by default
+#define LCD_STEP_CHARS 4
+
+// PCF8574 pins on the common backpack: P0 RS, P1 RW, P2 EN, P3 backlight,
+// P4-P7 D4-D7
+#define LCD_PCF_RS 0x01
+#define LCD_PCF_EN 0x04
+#define LCD_PCF_BACKLIGHT 0x08
+
+// Bytes for one HD44780 write: data, EN high, EN low for each nibble
+#define LCD_PCF_BYTES_PER_WRITE 6
+
+struct LcdFlushStats
+{
+  uint32_t frames;       // frames completed
+  uint32_t chars;        // cells written
+  uint32_t skipped;      // cells left alone because the panel already had them
+  uint32_t cursorMoves;  // set-DDRAM-address commands
+  uint32_t transactions; // I2C transactions started
+  uint32_t steps;        // step() calls that wrote something
+};
+
+class LcdTextFlush
+{
+public:
+  // The panel must already be initialised (LiquidCrystal_I2C::init());
+  // its contents are unknown until the first frame is written in full
+  void begin(I2cBus *bus, uint8_t address);
+
+  // Queue both rows (padded to the full width so old text is overwritten).
+  // If a frame is still being written, these rows follow right after it.
+  void commit(const char *row0, const char *row1);
+
+  // Write up to budget changed cells; returns true when idle
+  bool step(uint8_t budget = LCD_STEP_CHARS);
+
+  // Commit and write everything now (splash and sleep screens)
+  void flush(const char *row0, const char *row1);
+
+  bool busy() const { return sending || commitPending; }
+
+  // Panel contents changed behind our back (splash screens, clear())
+  void invalidate();
+
+  // Applied with the next step(), even if no cell changes
+  void setBacklight(bool on);
+
+  const LcdFlushStats &stats() const { return totals; }
+
+private:
+  void queueWrite(uint8_t *out, uint8_t value, bool data) const;
+
+  I2cBus *bus = nullptr;
+  uint8_t address = 0;
+  uint8_t backlight = LCD_PCF_BACKLIGHT;
+  bool backlightChanged = false;
+  char sendText[LCD_ROWS][LCD_COLS];    // frame being written
+  char pendingText[LCD_ROWS][LCD_COLS]; // next frame, committed while busy
+  char shadow[LCD_ROWS][LCD_COLS];      // what the panel shows
+  bool shadowValid = false;
+  bool writeFailed = false; // this frame hit a bus error
+  bool repairing = false;   // this frame is a full rewrite after one
+  bool sending = false;
+  bool commitPending = false;
+  uint8_t position = 0; // next cell of sendText to compare, row-major
+  uint8_t cursor = 0xFF; // cell the panel's address counter points at
+
+  LcdFlushStats totals = {};
+};
+
+#endif
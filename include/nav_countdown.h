@@ -0,0 +1,90 @@
+// Live distance countdown between Chronos updates
+// The phone sends the distance to the next turn (nav.title) and to the
+// destination (nav.distance) as text, and only when it pushes a packet, so
+// on screen they fall in coarse steps and sit still in between.
+// NavCountdown parses every packet that changed (nav_parse.h) and, until
+// the next one, counts both distances down by dead reckoning from the
+// speed: nav.speed, or when the phone sends none, the rate the turn
+// distance fell between packets. The live values are printed in the
+// phone's own format, and each new packet snaps them back to what the
+// phone says. Renderer-owned: no locking.
+#ifndef NAV_COUNTDOWN_H
+#define NAV_COUNTDOWN_H
+
+#include <Arduino.h>
+#include "nav_snapshot.h"
+#include "nav_parse.h"
+
+#define NAV_COUNTDOWN_MAX_MS 10000    // stop extrapolating this long after a packet
+#define NAV_COUNTDOWN_MIN_STEP_MS 200 // redraw at most this often, whatever pace() says
+#define NAV_COUNTDOWN_IDLE 0xFFFFFFFF
+#define NAV_SPEED_MAX_MM_S 70000 // 250 km/h; faster estimates are noise
+#define NAV_SPEED_STALE_MS 30000 // turn steps further apart say nothing about speed
+
+// The numbers in the last packet
+struct NavFigures
+{
+  bool hasTurn;
+  NavDistance turn;     // nav.title
+  unsigned long turnAt; // millis() when it last changed
+  bool hasRemaining;
+  NavDistance remaining; // nav.distance
+  unsigned long remainingAt;
+  bool hasSpeed;
+  bool speedEstimated; // from the turn distance, not nav.speed
+  uint32_t speedMmS;
+  bool hasEta;
+  uint16_t etaMinute; // minutes since midnight
+  bool hasDuration;
+  uint32_t durationS;
+};
+
+struct NavCountdownStats
+{
+  uint32_t packets;  // models whose navigation text changed
+  uint32_t unparsed; // non-empty distance, speed, ETA or duration fields not understood
+  uint32_t steps;    // countdown redraws between packets
+};
+
+class NavCountdown
+{
+public:
+  // Parse a new render model if the phone's text changed; true then
+  bool observe(const NavSnapshot &nav, unsigned long now);
+
+  // Put the live distances into nav.title and nav.distance; true when the
+  // text differs from the last apply()
+  bool apply(NavSnapshot &nav, unsigned long now);
+
+  // Step no more often than every ms (the refresh policy's frame interval);
+  // from the next apply()
+  void pace(uint32_t ms) { minStepMs = max(ms, (uint32_t)NAV_COUNTDOWN_MIN_STEP_MS); }
+
+  // Between packets: apply() to the model when due, true if it changed
+  bool step(NavSnapshot &nav, unsigned long now);
+
+  // ms until the shown text changes (NAV_COUNTDOWN_IDLE when it will not)
+  uint32_t msUntilStep(unsigned long now) const;
+
+  // Distance left now, by dead reckoning from a packet's value
+  uint32_t liveMm(const NavDistance &distance, unsigned long at, unsigned long now) const;
+
+  const NavFigures &figures() const { return state; }
+  const NavCountdownStats &stats() const { return counters; }
+
+private:
+  bool show(char *field, char *shown, const NavDistance &distance, unsigned long at, unsigned long now);
+  uint32_t msUntilChange(const NavDistance &distance, unsigned long at, unsigned long now) const;
+
+  uint32_t print = 0; // of the text last parsed
+  NavFigures state = {};
+  uint32_t speedEstimate = 0;
+  char shownTurn[NAV_TEXT_SHORT] = "";
+  char shownRemaining[NAV_TEXT_SHORT] = "";
+  bool counting = false;
+  unsigned long stepAt = 0; // millis() of the next change
+  uint32_t minStepMs = NAV_COUNTDOWN_MIN_STEP_MS;
+  NavCountdownStats counters = {};
+};
+
+#endif
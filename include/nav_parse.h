@@ -0,0 +1,47 @@
+// Numbers out of the preformatted Chronos navigation strings
+// The phone sends distances, speed, ETA and duration as display text
+// ("1.5 km", "42 km/h", "10:45", "1 hr 5 min"). These parsers turn them
+// into integers (distances and speeds in millimetres, so fixed point with
+// three decimals of a metre) without touching the heap, and remember how a
+// distance was written so navFormatDistance() can print a new value the
+// same way. Anything they do not recognise returns false and leaves out
+// untouched.
+#ifndef NAV_PARSE_H
+#define NAV_PARSE_H
+
+#include <Arduino.h>
+
+#define NAV_DISTANCE_MAX_MM 0xFFFFFFFFu // ~4295 km
+
+// A distance and the way it was written
+struct NavDistance
+{
+  uint32_t mm;
+  uint32_t unitUm;  // one unit as written, in micrometres (km = 10^9)
+  uint8_t decimals; // digits after the separator
+  char separator;   // '.' or ','
+  char gap[3];      // between number and unit: "", " " or a UTF-8 no-break space
+  char unit[4];     // as written: "m", "km", "mi", "ft", "yd" in any case
+};
+
+// "250m", "1.5 km", "2,4 km", "0.3 mi", "800 ft"
+bool navParseDistance(const char *text, NavDistance &out);
+
+// "42 km/h", "26 mph", "12 m/s"; millimetres per second
+bool navParseSpeed(const char *text, uint32_t &mmPerS);
+
+// "10:45", "9:05 pm"; minutes since midnight
+bool navParseClock(const char *text, uint16_t &minuteOfDay);
+
+// "12 min", "1 hr 5 min", "1h05m", "2 days 3 hours", "45 s"; seconds
+bool navParseDuration(const char *text, uint32_t &seconds);
+
+// Print mm in the style of written: same unit, decimals, separator and gap,
+// rounded to the nearest last digit. Kilometres below 1 km are printed in
+// whole metres, as the phone does. Returns the length (snprintf rules).
+int navFormatDistance(char *out, size_t size, const NavDistance &written, uint32_t mm);
+
+// Smallest change navFormatDistance() shows at mm, in millimetres
+uint32_t navDistanceStep(const NavDistance &written, uint32_t mm);
+
+#endif
@@ -0,0 +1,70 @@
+// Fixed-size copy of the navigation state handed from the BLE/loop task to
+// the renderer, and the seqlock that publishes it without blocking the writer
+#ifndef NAV_SNAPSHOT_H
+#define NAV_SNAPSHOT_H
+
+#include <Arduino.h>
+#include <ChronosESP32.h>
+#include <atomic>
+
+#define NAV_TEXT_SHORT 24
+#define NAV_TEXT_LONG 128
+#define NAV_ICON_BYTES 288 // 48x48, 1 bpp, row-major
+
+// Why a frame was asked for; travels with the snapshot so the renderer can
+// measure event-to-pixel latency
+struct RedrawRequest
+{
+  bool fromEvent;   // triggered by a Chronos event rather than the heartbeat
+  uint32_t eventUs; // micros() of that event
+};
+
+struct NavSnapshot
+{
+  bool connected;
+  bool active;
+  bool isNavigation;
+  bool hasIcon;
+  char title[NAV_TEXT_SHORT];
+  char eta[NAV_TEXT_SHORT];
+  char duration[NAV_TEXT_SHORT];
+  char distance[NAV_TEXT_SHORT];
+  char speed[NAV_TEXT_SHORT];
+  char directions[NAV_TEXT_LONG];
+  char appVersion[NAV_TEXT_SHORT];
+  char clock[6]; // "HH:MM"
+  bool showNavigation; // navigation screen: data, or held through a short dropout
+  uint8_t page;        // DisplayPage
+  uint8_t brightness;  // 0..BRIGHTNESS_LEVELS-1
+  uint16_t refreshMs;  // refresh policy's frame interval; paces the countdown
+  uint8_t icon[NAV_ICON_BYTES];
+  RedrawRequest request;
+};
+
+// Copy the Chronos state into a snapshot, truncating over-long strings
+void navSnapshotFill(NavSnapshot &out, const Navigation &nav, bool connected, const String &appVersion);
+
+#define FNV1A_SEED 2166136261u
+
+// 32-bit FNV-1a; chain calls by passing the previous result as hash
+uint32_t fnv1a(uint32_t hash, const void *data, size_t len);
+
+// FNV-1a over every navigation field the renderers look at (not the
+// connection flag, clock or request, which change independently)
+uint32_t navSnapshotFingerprint(const NavSnapshot &nav);
+
+// Single-writer seqlock. The writer never waits; a reader that overlaps a
+// write sees an odd or changed sequence number and copies again.
+class NavSeqlock
+{
+public:
+  void publish(const NavSnapshot &snapshot);
+  void read(NavSnapshot &out) const;
+  uint32_t sequence() const { return seq.load(std::memory_order_acquire); }
+
+private:
+  std::atomic<uint32_t> seq{0};
+  NavSnapshot data = {};
+};
+
+#endif
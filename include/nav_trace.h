@@ -0,0 +1,101 @@
+// Navigation trace capture and parsing
+// With capture on ("trace on" on the serial console) every change the
+// redraw trigger sees is written to Serial as one text line: what changed,
+// when (millis()), and nothing else. Connection, navigation text and the
+// icon go on separate lines, so a distance update costs a few bytes and
+// the 288-byte icon is only sent when it changes. The first lines after
+// "trace on" carry the whole state.
+//
+//   @T <ms> c <0|1>                      connection
+//   @T <ms> n <flags> <key>=<text>...    flags: active 1, navigation 2, icon 4
+//   @T <ms> i <icon as 576 hex digits>
+//
+// Fields are tab separated; keys are t title, e eta, u duration, d
+// distance, s speed, r directions; tab, CR, LF and backslash in the text
+// are escaped as \t \r \n \\. Each line goes out in one Serial.write(), so
+// telemetry frames and log lines only ever fall between trace lines and a
+// serial monitor capture can be replayed as it is. A line blocks the loop
+// for its UART time (an icon line ~50 ms at 115200 baud): capture is for
+// recording test drives, not for normal use.
+//
+// NavTraceReader turns such a capture back into events; the host replay
+// driver (test/native/fakes/scenarios.h) feeds them to the firmware.
+#ifndef NAV_TRACE_H
+#define NAV_TRACE_H
+
+#include <Arduino.h>
+#include "nav_snapshot.h"
+
+#define NAV_TRACE_LINE_MAX 640 // longest line: an icon, or every text field fully escaped
+#define NAV_TRACE_FIELDS 6
+
+enum NavTraceKind : uint8_t
+{
+  NAV_TRACE_CONNECTION,
+  NAV_TRACE_NAV,
+  NAV_TRACE_ICON,
+};
+
+struct NavTraceStats
+{
+  uint32_t lines; // written, or read back
+  uint32_t bytes;
+};
+
+class NavTraceWriter
+{
+public:
+  // Start writing to out (the whole state first); nullptr stops
+  void start(Print *out);
+  bool capturing() const { return out != nullptr; }
+
+  // Write a line for each part of nav that changed since the last call
+  void capture(const NavSnapshot &nav, unsigned long now);
+
+  const NavTraceStats &stats() const { return counters; }
+
+private:
+  void emit(size_t length);
+
+  Print *out = nullptr;
+  bool primed = false; // false: the next capture writes everything
+  bool connected = false;
+  uint8_t flags = 0;
+  uint32_t fieldPrints[NAV_TRACE_FIELDS] = {};
+  uint32_t iconPrint = 0;
+  char line[NAV_TRACE_LINE_MAX];
+  NavTraceStats counters = {};
+};
+
+// What a trace line said, and the whole state after it
+struct NavTraceEvent
+{
+  uint32_t ms;
+  NavTraceKind kind;
+  NavSnapshot state; // connection, navigation text and icon
+};
+
+class NavTraceReader
+{
+public:
+  // Feed a capture a byte at a time; anything that is not a trace line is
+  // skipped. True when c completed a line, whose event() is then current.
+  bool feed(char c);
+
+  const NavTraceEvent &event() const { return current; }
+  const NavTraceStats &stats() const { return counters; }
+  uint32_t rejected() const { return malformed; } // trace lines that did not parse
+
+private:
+  bool parse();
+
+  uint8_t matched = 0; // of the "@T\t" marker
+  size_t length = 0;
+  bool overflow = false;
+  char line[NAV_TRACE_LINE_MAX];
+  NavTraceEvent current = {};
+  NavTraceStats counters = {};
+  uint32_t malformed = 0;
+};
+
+#endif
@@ -0,0 +1,107 @@
+// Shadow-framebuffer delta flush for the SSD1306 OLED
+// Keeps a copy of the last frame pushed to the panel and, on each flush,
+// sends only the column runs of each 8-row page that actually changed,
+// using the SSD1306 column/page address window.
+//
+// Transmission is split into bounded I2C transactions: commit() snapshots
+// the changed runs of the display buffer into the shadow and queues them,
+// step() sends the next slice. A frame is fully sent before the next one is
+// committed, and the renderer can draw the next frame into the display
+// buffer meanwhile, so frames never tear into each other. After a bus
+// error the whole buffer is sent once more as soon as the frame ends.
+#ifndef OLED_FLUSH_H
+#define OLED_FLUSH_H
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+#include <Adafruit_SSD1306.h>
+
+#define OLED_FLUSH_MAX_WIDTH 128
+#define OLED_FLUSH_MAX_PAGES 8
+
+// Unchanged columns between two dirty runs cheaper to resend than to open a
+// new window for (window setup costs ~8 bytes on the bus)
+#define OLED_FLUSH_MERGE_GAP 8
+
+// Queued windows per frame; past this each page collapses to a single run
+#define OLED_FLUSH_MAX_WINDOWS 24
+
+// Largest data payload per I2C transaction (control byte takes one slot)
+#ifdef I2C_BUFFER_LENGTH
+#define OLED_FLUSH_CHUNK (I2C_BUFFER_LENGTH - 1)
+#else
+#define OLED_FLUSH_CHUNK 31
+#endif
+
+// Bytes step() may put on the bus per call by default (~3 ms at 400 kHz)
+#define OLED_STEP_BUDGET 128
+
+struct OledFlushStats
+{
+  uint32_t frames;       // frames completed
+  uint32_t fullFrames;   // frames that had to push the whole buffer
+  uint32_t windows;      // column windows sent
+  uint32_t bytes;        // bytes written to the bus (control + payload)
+  uint32_t transactions; // I2C transactions started
+  uint32_t steps;        // step() calls that sent something
+};
+
+class OledDeltaFlush
+{
+public:
+  void begin(Adafruit_SSD1306 *display, I2cBus *bus, uint8_t address);
+
+  // Queue the changes in the display buffer for transmission. If a frame
+  // is still being sent, the buffer is picked up as soon as it completes.
+  void commit();
+
+  // Send up to budget bytes of the queued frame; returns true when idle
+  bool step(uint16_t budget = OLED_STEP_BUDGET);
+
+  // Commit and send everything now (splash and sleep screens)
+  void flush();
+
+  // Something queued or waiting to be committed
+  bool busy() const { return windowCount > 0 || commitPending; }
+
+  // Force the next commit to push the whole buffer (panel contents unknown)
+  void invalidate() { shadowValid = false; }
+
+  const OledFlushStats &stats() const { return totals; }
+  const OledFlushStats &lastFrame() const { return frame; }
+
+private:
+  struct Window
+  {
+    uint8_t page;
+    uint8_t col0;
+    uint8_t col1;
+  };
+
+  void queueChanges();
+  void finishFrame();
+
+  Adafruit_SSD1306 *display = nullptr;
+  I2cBus *bus = nullptr;
+  uint8_t address = 0;
+  uint8_t width = 0;
+  uint8_t pages = 0;
+  bool shadowValid = false;
+  bool commitPending = false;
+  bool frameFailed = false; // a write of the frame in flight failed
+  bool repairing = false;   // the frame in flight is a full resend after one
+
+  // Shadow = the last committed frame; queued windows are sent from it
+  uint8_t shadow[OLED_FLUSH_MAX_WIDTH * OLED_FLUSH_MAX_PAGES];
+  Window windows[OLED_FLUSH_MAX_WINDOWS];
+  uint8_t windowCount = 0;
+  uint8_t windowIndex = 0;
+  uint8_t sentInWindow = 0; // payload bytes of the current window already sent
+  bool windowOpen = false;  // address window of the current run set up
+
+  OledFlushStats totals = {};
+  OledFlushStats frame = {};
+  OledFlushStats current = {};
+};
+
+#endif
@@ -0,0 +1,67 @@
+// Idle the loop task between deadlines instead of spinning
+// Each loop() reports how soon it needs to run again (frame in flight,
+// the held button's next gesture, redraw poll); powerIdle() then blocks
+// the loop task until the earliest deadline or a powerWake() (BLE
+// callbacks, the button ISR).
+// While blocked the idle task runs, so DFS drops the clock and, when the
+// sdkconfig enables tickless idle, the chip enters automatic light sleep.
+// Host builds (and POWER_SCHEDULER=0) never block and only account busy
+// time.
+//
+// Light sleep stops GPIO edge interrupts, so the wake pin needs a level
+// wake. On the ESP32 the wake level and the interrupt type share the pin's
+// int_type field: a permanent gpio_wakeup_enable() would be undone by the
+// button's CHANGE interrupt, or would turn that interrupt level-triggered
+// and storm while the button is held. So the level wake is armed only
+// while powerIdle() blocks, at the level opposite to the pin's current one
+// (the next change, press or release). The first interrupt it raises goes
+// through the button ISR, whose powerWakeFromISR() puts the pin back to
+// any-edge; powerIdle() does the same when it wakes on a deadline. ext0 and
+// ext1 are left to deep sleep: they hand the pad to the RTC mux, which
+// light sleep does not give back.
+#ifndef POWER_SCHEDULER_H
+#define POWER_SCHEDULER_H
+
+#include <Arduino.h>
+
+#ifndef POWER_SCHEDULER
+#ifdef ARDUINO_ARCH_ESP32
+#define POWER_SCHEDULER 1
+#else
+#define POWER_SCHEDULER 0
+#endif
+#endif
+
+#define POWER_BLE_SERVICE_MS 20 // Chronos.loop() handles queued BLE writes; keep latency low
+#define POWER_MIN_CPU_MHZ 80    // BLE needs an 80 MHz APB
+
+struct PowerStats
+{
+  uint64_t busyUs;     // loop() running
+  uint64_t idleUs;     // loop task blocked in powerIdle()
+  uint32_t sleeps;     // powerIdle() calls that blocked
+  uint32_t earlyWakes; // ... ended by the button or powerWake()
+  bool lightSleep;     // automatic light sleep configured
+};
+
+// Call from setup() on the loop task: power management, with wakePin
+// (active low) as a light sleep wake source
+void powerBegin(uint8_t wakePin);
+
+// The next loop() must start within ms (0 = don't block)
+void powerRunWithin(uint32_t ms);
+
+// End of loop(): block until the earliest deadline
+void powerIdle();
+
+// Cut the current powerIdle() short. The wake pin's ISR must call
+// powerWakeFromISR(): it also disarms the level wake.
+void powerWake();
+void powerWakeFromISR();
+
+const PowerStats &powerStats();
+
+// Share of time loop() was running, in percent
+uint8_t powerDutyCycle();
+
+#endif
@@ -0,0 +1,97 @@
+// Scoped cycle-counter probes feeding log2 latency histograms
+// PROF_SCOPE(point) times the rest of the enclosing block with the CPU cycle
+// counter and adds it to that point's histogram: 32 buckets where bucket i
+// counts durations of [2^i, 2^(i+1)) cycles, plus exact min/max. All of it
+// sits in static memory; "prof" on the serial console prints the table.
+// Build with PROFILER=0 and the probes compile to nothing.
+//
+// With DFS the CPU clock moves between samples (80 MHz when the loop has
+// idled, the maximum while busy), so a raw cycle count means nothing once
+// several are added up. Every duration is scaled to cycles at
+// PROF_CLOCK_MHZ when it is taken, by the clock running at that moment (a
+// scope that spans a clock change is counted at the clock it ends at).
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef PROFILER
+#define PROFILER 1
+#endif
+
+#define PROFILE_POINTS(X)                  \
+  X(PROF_LOOP, "loop")                     \
+  X(PROF_CHRONOS_LOOP, "Chronos.loop")     \
+  X(PROF_RENDER_OLED, "updateDisplayOLED") \
+  X(PROF_RENDER_LCD, "updateDisplayLCD")   \
+  X(PROF_DISPLAY_SEND, "displayService")   \
+  X(PROF_SAVE_TIME, "saveCurrentTime")     \
+  X(PROF_BUTTON, "buttonPoll")
+
+#define PROFILE_ENUM(name, label) name,
+enum ProfilePoint : uint8_t
+{
+  PROFILE_POINTS(PROFILE_ENUM) PROF_POINT_COUNT
+};
+#undef PROFILE_ENUM
+
+#define PROF_BUCKETS 32
+#define PROF_CLOCK_MHZ 240 // unit of every cycle count kept
+
+// Cycles counted at the current CPU clock, as cycles at PROF_CLOCK_MHZ
+inline uint32_t profilerCycles(uint32_t cycles)
+{
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  if (mhz == PROF_CLOCK_MHZ || mhz == 0)
+  {
+    return cycles;
+  }
+  uint64_t scaled = (uint64_t)cycles * PROF_CLOCK_MHZ / mhz;
+  return scaled > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)scaled;
+}
+
+// Cycles at PROF_CLOCK_MHZ
+struct ProfileHistogram
+{
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+  uint32_t buckets[PROF_BUCKETS];
+};
+
+#if PROFILER
+
+void profilerRecord(ProfilePoint point, uint32_t cycles);
+const ProfileHistogram &profilerHistogram(ProfilePoint point);
+
+// Upper bound, in cycles, of the bucket holding the given percentile
+uint32_t profilerPercentile(const ProfileHistogram &histogram, uint8_t percent);
+
+void profilerReset();
+void profilerDump(Print &out);
+
+class ProfScope
+{
+public:
+  explicit ProfScope(ProfilePoint point) : point(point), start(ESP.getCycleCount()) {}
+  ~ProfScope() { profilerRecord(point, profilerCycles(ESP.getCycleCount() - start)); }
+
+private:
+  ProfilePoint point;
+  uint32_t start;
+};
+
+#define PROF_CONCAT2(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT2(a, b)
+#define PROF_SCOPE(point) ProfScope PROF_CONCAT(profScope, __LINE__)(point)
+
+#else
+
+#define PROF_SCOPE(point) do { } while (0)
+inline void profilerReset() {}
+inline void profilerDump(Print &out) { out.println("Profiler disabled (build with -DPROFILER=1)"); }
+
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+// Event-driven redraw scheduling
+// Fingerprints the navigation data and the cheap per-loop screen state
+// (connection, clock minute, hold timer) and asks for a frame only when
+// one of them changes, with a heartbeat as a safety net. How often it
+// samples navigation and how slow the heartbeat is come from the refresh
+// policy (refresh_policy.h), re-evaluated on every sample.
+#ifndef REDRAW_TRIGGER_H
+#define REDRAW_TRIGGER_H
+
+#include <Arduino.h>
+#include <ChronosESP32.h>
+#include "nav_snapshot.h"
+#include "refresh_policy.h"
+
+struct RedrawStats
+{
+  uint32_t frames;          // redraws requested
+  uint32_t framesDone;      // redraws that reached the display
+  uint32_t changeFrames;    // ... because something changed
+  uint32_t heartbeatFrames; // ... because the heartbeat expired
+  uint32_t events;          // Chronos navigation/connection events seen
+  uint32_t rateChanges;     // refresh policy picked another mode
+  uint32_t lastEventUs;     // micros() of the event behind the last frame
+  uint32_t lastFrameUs;     // micros() when that frame reached the display
+  uint32_t lastLatencyUs;   // event to pixels for the last event-driven frame
+  uint32_t maxLatencyUs;
+  uint64_t totalLatencyUs;
+  uint32_t latencySamples;
+};
+
+class RedrawTrigger
+{
+public:
+  void begin(ChronosESP32 *chronos);
+
+  // Swap the refresh policy (refreshAdaptive by default)
+  void setPolicy(RefreshPolicy policy);
+
+  // Called from the Chronos callbacks (BLE task context)
+  void notifyEvent();
+
+  // True when a frame should be drawn now; screenState is any cheap value
+  // that changes whenever the screen would look different. frame is
+  // refreshed from Chronos whenever navigation is sampled (on events and
+  // every rate().frameMs), which is the only place the Navigation
+  // Strings get copied; frame->request describes the trigger and is handed
+  // back to frameDone().
+  bool poll(uint32_t screenState, NavSnapshot *frame);
+
+  // Call from the renderer once the requested frame is on the display
+  void frameDone(const RedrawRequest &request);
+
+  // Time until poll() samples navigation or the heartbeat fires anyway
+  uint32_t msUntilDue() const;
+
+  // What the policy chose at the last navigation sample
+  const RefreshRate &rate() const { return current; }
+
+  const RedrawStats &stats() const { return counters; }
+
+private:
+  void adopt(const RefreshRate &rate);
+
+  ChronosESP32 *chronos = nullptr;
+  RefreshPolicy policy = refreshAdaptive;
+  RefreshState sampled = {}; // at the last navigation sample
+  RefreshRate current = refreshAdaptive({});
+  volatile bool eventPending = false;
+  volatile uint32_t eventUs = 0;
+  uint32_t navPrint = 0;
+  uint32_t lastScreenState = 0;
+  unsigned long lastNavPoll = 0;
+  unsigned long lastRequest = 0;
+  bool firstFrame = true;
+  RedrawStats counters = {};
+};
+
+#endif
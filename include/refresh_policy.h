@@ -0,0 +1,60 @@
+// How often the screen is refreshed, from what it shows
+// The redraw trigger asks the policy for a rate every time it samples
+// navigation. The adaptive policy refreshes several times a second within
+// REFRESH_APPROACH_MM of a turn, once a second in normal guidance, every
+// few seconds on a long stretch, and leaves the idle and disconnected
+// screens to their events and the minute of the clock. frameMs paces both
+// the Chronos poll and the turn countdown (it travels to the renderer in
+// NavSnapshot::refreshMs); heartbeatMs is the redraw safety net.
+// A policy is a plain function, so benches can swap in refreshFixed (one
+// rate whatever the screen shows) to compare.
+#ifndef REFRESH_POLICY_H
+#define REFRESH_POLICY_H
+
+#include <Arduino.h>
+#include "nav_snapshot.h"
+
+#define REFRESH_APPROACH_MM 200000 // closer to the turn than 200 m
+#define REFRESH_CRUISE_MM 5000000  // further than 5 km
+
+// refreshFixed
+#define NAV_POLL_INTERVAL 1000  // Re-fingerprint navigation even without a Chronos event
+#define DISPLAY_HEARTBEAT 10000 // Redraw at least this often
+
+enum RefreshMode : uint8_t
+{
+  REFRESH_DISCONNECTED,
+  REFRESH_IDLE,     // connected, no navigation
+  REFRESH_CRUISE,   // next turn beyond REFRESH_CRUISE_MM
+  REFRESH_GUIDANCE, // navigating; also when the title is not a distance
+  REFRESH_APPROACH, // within REFRESH_APPROACH_MM of the turn
+  REFRESH_MODES
+};
+
+struct RefreshRate
+{
+  RefreshMode mode;
+  uint32_t frameMs;     // a change shows within this; countdown step floor
+  uint32_t heartbeatMs; // redraw at least this often
+};
+
+// What the policy decides on, as sampled from Chronos
+struct RefreshState
+{
+  bool connected;
+  bool active;
+  bool hasTurn;
+  uint32_t turnMm; // distance to the next turn (nav.title)
+};
+
+typedef RefreshRate (*RefreshPolicy)(const RefreshState &state);
+
+// Read connection, navigation state and turn distance out of a snapshot
+RefreshState refreshState(const NavSnapshot &nav);
+
+RefreshRate refreshAdaptive(const RefreshState &state);
+RefreshRate refreshFixed(const RefreshState &state);
+
+const char *refreshModeName(RefreshMode mode);
+
+#endif
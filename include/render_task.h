@@ -0,0 +1,51 @@
+// Display rendering off the BLE/loop task
+// On the ESP32 frames are drawn by a dedicated task pinned to the core the
+// Arduino loop does not use; the loop only publishes a NavSnapshot and
+// wakes it. Host builds (and RENDER_TASK=0) render inline instead.
+#ifndef RENDER_TASK_H
+#define RENDER_TASK_H
+
+#include "nav_snapshot.h"
+
+#ifndef RENDER_TASK
+#ifdef ARDUINO_ARCH_ESP32
+#define RENDER_TASK 1
+#else
+#define RENDER_TASK 0
+#endif
+#endif
+
+#define RENDER_TASK_CORE 0 // loop() runs on core 1
+#define RENDER_TASK_STACK 8192
+#define RENDER_TASK_PRIORITY 1
+
+#define RENDER_NOTHING_DUE 0xFFFFFFFF
+
+// Draws one frame from a snapshot and queues it for the panel, sends the
+// next slice of a queued frame (true once idle), and steps animations on
+// the panels that are idle (0 when it queued one, else ms until the next
+// step or RENDER_NOTHING_DUE); implemented by the application
+void renderFrame(const NavSnapshot &nav);
+bool displayService();
+uint32_t displayAnimate();
+
+void renderTaskBegin();
+
+// Hand a new frame to the renderer (never blocks when RENDER_TASK is on)
+void renderSubmit(const NavSnapshot &nav);
+
+// Called every loop(): without the render task this sends one slice of
+// the frame in flight, so no single loop() blocks for a whole frame.
+// False while a slice is still waiting to be sent.
+bool renderService();
+
+// When the next animation step is due (RENDER_NOTHING_DUE with the render
+// task, which times its own steps)
+uint32_t renderMsUntilDue();
+
+// Exclusive access to the displays for code outside the renderer
+// (sleep screen etc.); waits for an in-flight frame to finish
+void renderLock();
+void renderUnlock();
+
+#endif
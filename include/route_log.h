@@ -0,0 +1,102 @@
+// Append-only route log on the spiffs partition
+// Every change to the navigation state is kept as a small delta record:
+// the ms since the previous record, a mask of the fields that changed and
+// their new values. Records fill a page-sized batch in RAM; only whole
+// pages reach flash, each one a single 251-byte append (the data area of
+// one 256-byte SPIFFS page), so a record costs its own size in flash wear
+// and the log grows by one SPIFFS page at a time whatever the packet rate.
+//
+// The partition is shared with the icon cache, so the circle is a ring of
+// segment files rather than raw sectors: when the newest segment is full
+// the oldest one is removed and started again. The first record of a
+// segment carries every field, so whatever is left of the log decodes
+// from its first page. Each page carries a sequence number and a CRC; at
+// boot the newest valid page tells where to go on, and a page torn by a
+// power cut fails its CRC and is skipped.
+//
+// The loop only encodes records into RAM. Pages are written by a
+// low-priority task (ROUTE_LOG_TASK) that also streams the log out on the
+// "route" serial command: no flash write is on the loop's call path, and
+// there is at most one 251-byte page program per ROUTE_LOG_WRITE_PERIOD
+// (routeLogFlush() before deep sleep aside). A program still stalls the
+// loop, as SPIFFS turns the flash cache off on both cores while it runs;
+// RouteLogStats::maxWriteUs keeps the worst case.
+#ifndef ROUTE_LOG_H
+#define ROUTE_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "nav_snapshot.h"
+
+#ifndef ROUTE_LOG_TASK
+#ifdef ARDUINO_ARCH_ESP32
+#define ROUTE_LOG_TASK 1
+#else
+#define ROUTE_LOG_TASK 0
+#endif
+#endif
+
+#define ROUTE_LOG_PAGE_BYTES 251      // SPIFFS page data area: 256 minus its 5-byte header
+#define ROUTE_LOG_SEGMENTS 8          // files in the ring
+#define ROUTE_LOG_SEGMENT_PAGES 64    // 16 KB each, 128 KB of the partition in all
+#define ROUTE_LOG_QUEUE 4             // sealed pages waiting for the writer (power of two)
+#define ROUTE_LOG_FLUSH_MS 300000     // a part-filled page goes to flash after 5 minutes
+#define ROUTE_LOG_WRITE_PERIOD 1000   // ms between writer runs on the task, one page each
+#define ROUTE_LOG_TASK_PRIORITY 0     // idle time only, like the telemetry drain
+#define ROUTE_LOG_TASK_STACK 4096
+#define ROUTE_LOG_DIRECTIONS_MAX 96   // longer directions are cut to fit a page
+#define ROUTE_LOG_MAGIC 0x4C52        // "RL"
+
+// Record field mask
+#define ROUTE_FIELD_FLAGS 0x01 // connected 1, active 2, navigation 4, icon 8
+#define ROUTE_FIELD_TITLE 0x02
+#define ROUTE_FIELD_DISTANCE 0x04
+#define ROUTE_FIELD_ETA 0x08
+#define ROUTE_FIELD_DURATION 0x10
+#define ROUTE_FIELD_SPEED 0x20
+#define ROUTE_FIELD_DIRECTIONS 0x40
+#define ROUTE_FIELD_ICON 0x80 // FNV-1a of the icon bitmap
+
+// One flash page: the header, then records back to back (zero padded)
+struct __attribute__((packed)) RouteLogPage
+{
+  uint16_t magic;
+  uint16_t length;   // record bytes used
+  uint32_t crc;      // CRC-32 of the page with this field zero
+  uint32_t sequence; // pages written since the log was created
+  uint32_t ms;       // millis() of the first record
+  uint32_t epoch;    // wall clock then (0 if never set)
+  uint8_t records[ROUTE_LOG_PAGE_BYTES - 20];
+};
+
+struct RouteLogStats
+{
+  uint32_t records;    // changes logged since boot
+  uint32_t sealed;     // pages handed to the writer
+  uint32_t written;    // pages appended to flash
+  uint32_t dropped;    // pages lost with the queue full
+  uint32_t errors;     // failed or short writes, and pages skipped after one
+  uint32_t stored;     // valid pages found at boot
+  uint32_t damaged;    // pages failing their CRC at boot
+  uint32_t maxWriteUs; // longest page append, the loop stalled with it
+};
+
+// Find where the log left off; fs may be null (log disabled)
+void routeLogBegin(fs::FS *fs);
+
+// Log what changed in the navigation state since the last call (RAM only)
+void routeLogRecord(const NavSnapshot &nav, unsigned long now);
+
+// From loop(): seal a page left part-filled for ROUTE_LOG_FLUSH_MS; without
+// the task this also writes sealed pages and runs a requested dump
+void routeLogService();
+
+// Before deep sleep: write everything, including a part-filled page
+void routeLogFlush();
+
+// Stream the whole log to out as text, oldest first (done by the writer)
+void routeLogDump(Print &out);
+
+const RouteLogStats &routeLogStats();
+
+#endif
@@ -0,0 +1,149 @@
+// Binary telemetry log
+// Fixed 16-byte records (timestamp, event id, three integer fields) go into
+// a lock-free RAM ring from any task and are written to Serial in framed
+// binary form by a low-priority drain task, instead of formatting text on
+// the hot path. tools/telemetry_decode.py turns the stream back into text;
+// it reads the event table below, so keep each X(...) entry on one line.
+//
+// TELEMETRY_LEVEL selects what is compiled in (0 off, 1 errors, 2 info,
+// 3 debug). Levels left out compile to dead code that still names its
+// arguments, so nothing is evaluated and no local is left unused. It is
+// independent of CORE_DEBUG_LEVEL, which keeps controlling the
+// ESP-IDF/Arduino core log_x() output.
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define TEL_LEVEL_ERROR 1
+#define TEL_LEVEL_INFO 2
+#define TEL_LEVEL_DEBUG 3
+
+#ifndef TELEMETRY_LEVEL
+#define TELEMETRY_LEVEL TEL_LEVEL_INFO
+#endif
+
+#ifndef TELEMETRY_TASK
+#ifdef ARDUINO_ARCH_ESP32
+#define TELEMETRY_TASK 1
+#else
+#define TELEMETRY_TASK 0
+#endif
+#endif
+
+#define TELEMETRY_RING_SIZE 256 // records, power of two (4 KB)
+#define TELEMETRY_DRAIN_PERIOD 50 // ms between drains on the task
+#define TELEMETRY_DRAIN_BATCH 32  // records per drain
+#define TELEMETRY_TASK_PRIORITY 0 // below everything else; idle time only
+#define TELEMETRY_TASK_STACK 2048
+
+// Serial framing: sync bytes, the record, then the low byte of its sum
+#define TELEMETRY_SYNC0 0xA5
+#define TELEMETRY_SYNC1 0x5A
+
+// Event id, decoder format (%a %b %c are the record fields, %t text chunk)
+#define TELEMETRY_EVENTS(X)                                                 \
+  X(TEL_BOOT, "boot: wake cause %a")                                       \
+  X(TEL_BOOT_FRAME, "boot: first frame at %b us (fast boot %a)")            \
+  X(TEL_CONNECTION, "chronos connected=%a")                                 \
+  X(TEL_NAV, "nav: flags %a (1 active, 2 navigation, 4 icon), print %b")    \
+  X(TEL_NAV_TEXT, "%t")                                                     \
+  X(TEL_FRAME, "frame %c: latency %b us (event %a)")                        \
+  X(TEL_HEAP, "heap: free %b, largest block %c, fragmentation %a%")         \
+  X(TEL_ICONS, "icons: %b hits, %c misses, %a restored")                    \
+  X(TEL_LOOP_GAP, "Chronos.loop() max gap %b us")                           \
+  X(TEL_POWER, "power: loop busy %a%, idle %b ms over %c sleeps")           \
+  X(TEL_SLEEP, "entering deep sleep")                                       \
+  X(TEL_TIME, "time: source %a (1 rtc, 2 nvs), slept %b ms")                \
+  X(TEL_I2C_CLOCK, "i2c: device %a at %b Hz (0 = no answer)")              \
+  X(TEL_I2C, "i2c: device %a, %b errors, %c retries")                      \
+  X(TEL_I2C_BUS, "i2c: bus recovered %b times, %c failed")                 \
+  X(TEL_PANEL_FRAME, "panel %a (1 lcd, 2 oled) frame %c: latency %b us")   \
+  X(TEL_COUNTDOWN, "countdown: %b packets, %c steps, %a fields unparsed")  \
+  X(TEL_ROUTE_LOG, "route log: %c records, %b pages written, %a dropped")   \
+  X(TEL_ROUTE_LOG_WRITE, "route log: longest page write %b us, %c errors")  \
+  X(TEL_REFRESH, "refresh: mode %a, frame every %b ms, heartbeat %c ms")    \
+  X(TEL_DROPPED, "telemetry: %b records dropped (ring full)")
+
+#define TELEMETRY_ENUM(name, format) name,
+enum TelemetryEvent : uint8_t
+{
+  TELEMETRY_EVENTS(TELEMETRY_ENUM)
+};
+#undef TELEMETRY_ENUM
+
+// TEL_NAV_TEXT field ids (record field a = field << 8 | offset)
+enum TelemetryTextField : uint8_t
+{
+  TEL_TEXT_TITLE,
+  TEL_TEXT_ETA,
+  TEL_TEXT_DURATION,
+  TEL_TEXT_DISTANCE,
+  TEL_TEXT_DIRECTIONS,
+  TEL_TEXT_SPEED,
+};
+
+struct TelemetryRecord
+{
+  uint32_t us; // micros() when logged
+  uint8_t event;
+  uint8_t level;
+  uint16_t a;
+  uint32_t b;
+  uint32_t c;
+};
+static_assert(sizeof(TelemetryRecord) == 16, "telemetry records are 16 bytes on the wire");
+
+struct TelemetryStats
+{
+  uint32_t logged;
+  uint32_t dropped;
+  uint32_t drained;
+};
+
+void telemetryLog(uint8_t level, TelemetryEvent event, uint16_t a, uint32_t b, uint32_t c);
+
+// A string as TEL_NAV_TEXT chunks of 8 bytes (ends with the chunk holding
+// the terminator)
+void telemetryText(uint8_t level, TelemetryTextField field, const char *text);
+
+// Start the drain task (or nothing without TELEMETRY_TASK)
+void telemetryBegin();
+
+// Drain from loop() when there is no task
+void telemetryService();
+
+// Write up to max records to out; returns how many
+uint32_t telemetryDrain(Print &out, uint32_t max);
+
+// Drain everything, waiting for a concurrent drain (before deep sleep)
+void telemetryFlush(Print &out);
+
+TelemetryStats telemetryStats();
+
+#if TELEMETRY_LEVEL >= TEL_LEVEL_ERROR
+#define TEL_ERROR(event, a, b, c) telemetryLog(TEL_LEVEL_ERROR, event, a, b, c)
+#else
+#define TEL_ERROR(event, a, b, c) \
+  do { if (0) telemetryLog(TEL_LEVEL_ERROR, event, a, b, c); } while (0)
+#endif
+
+#if TELEMETRY_LEVEL >= TEL_LEVEL_INFO
+#define TEL_INFO(event, a, b, c) telemetryLog(TEL_LEVEL_INFO, event, a, b, c)
+#else
+#define TEL_INFO(event, a, b, c) \
+  do { if (0) telemetryLog(TEL_LEVEL_INFO, event, a, b, c); } while (0)
+#endif
+
+#if TELEMETRY_LEVEL >= TEL_LEVEL_DEBUG
+#define TEL_DEBUG(event, a, b, c) telemetryLog(TEL_LEVEL_DEBUG, event, a, b, c)
+#define TEL_DEBUG_TEXT(field, text) telemetryText(TEL_LEVEL_DEBUG, field, text)
+#else
+#define TEL_DEBUG(event, a, b, c) \
+  do { if (0) telemetryLog(TEL_LEVEL_DEBUG, event, a, b, c); } while (0)
+#define TEL_DEBUG_TEXT(field, text) \
+  do { if (0) telemetryText(TEL_LEVEL_DEBUG, field, text); } while (0)
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+// Pixel-width text fitting for the classic 5x7 GFX font
+// Every glyph of the built-in font sits in a 5-column cell but many use
+// fewer columns ('i', '.', ':', ' '). The table below holds each glyph's
+// first inked column and ink width, so text is measured and drawn
+// proportionally: ink plus TEXT_GLYPH_GAP, scaled by the text size.
+// Measuring, wrapping and ellipsis work in one pass over the characters,
+// with no copies and no allocation.
+#ifndef TEXT_FIT_H
+#define TEXT_FIT_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+#define TEXT_FIRST_GLYPH 0x20
+#define TEXT_LAST_GLYPH 0x7E
+#define TEXT_GLYPH_GAP 1    // blank column after each glyph
+#define TEXT_LINE_HEIGHT 8  // at text size 1
+#define TEXT_ELLIPSIS "..."
+
+// Left ink column (high nibble) and ink width (low nibble); space is 2 wide
+#define GLYPH(left, width) (uint8_t)((left) << 4 | (width))
+constexpr uint8_t textGlyphs[TEXT_LAST_GLYPH - TEXT_FIRST_GLYPH + 1] = {
+    GLYPH(0, 2), GLYPH(2, 1), GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(1, 3), //  !"#$%&'
+    GLYPH(1, 3), GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(1, 3), GLYPH(0, 5), GLYPH(2, 2), GLYPH(0, 5), // ()*+,-./
+    GLYPH(0, 5), GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // 01234567
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(2, 1), GLYPH(1, 2), GLYPH(1, 4), GLYPH(0, 5), GLYPH(1, 4), GLYPH(0, 5), // 89:;<=>?
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // @ABCDEFG
+    GLYPH(0, 5), GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // HIJKLMNO
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // PQRSTUVW
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(1, 4), GLYPH(0, 5), GLYPH(1, 4), GLYPH(0, 5), GLYPH(0, 5), // XYZ[\]^_
+    GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(1, 4), GLYPH(0, 5), // `abcdefg
+    GLYPH(0, 5), GLYPH(1, 3), GLYPH(0, 4), GLYPH(0, 4), GLYPH(1, 3), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // hijklmno
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), // pqrstuvw
+    GLYPH(0, 5), GLYPH(0, 5), GLYPH(0, 5), GLYPH(1, 3), GLYPH(2, 1), GLYPH(1, 3), GLYPH(0, 5),              // xyz{|}~
+};
+#undef GLYPH
+
+// Codes outside the table draw as a full cell
+constexpr uint8_t textGlyph(char c)
+{
+  return ((uint8_t)c >= TEXT_FIRST_GLYPH && (uint8_t)c <= TEXT_LAST_GLYPH) ? textGlyphs[(uint8_t)c - TEXT_FIRST_GLYPH]
+                                                                           : 0x05;
+}
+
+// Pixels the cursor moves for one glyph at size 1
+constexpr uint8_t textAdvance(char c)
+{
+  return (textGlyph(c) & 0x0F) + TEXT_GLYPH_GAP;
+}
+
+// Width of a string literal at size 1, trailing gap included
+constexpr uint16_t textAdvanceOf(const char *text)
+{
+  return *text == '\0' ? 0 : textAdvance(*text) + textAdvanceOf(text + 1);
+}
+
+static_assert(textAdvanceOf("W") == 6 && textAdvanceOf(".") == 3, "glyph table out of step with glcdfont");
+
+// Inked width of the first length characters at the given size (the gap
+// after the last glyph does not count)
+uint16_t textWidth(const char *text, size_t length, uint8_t size);
+
+// One line of a wrapped text
+struct TextLine
+{
+  size_t length; // characters of text drawn on this line
+  size_t next;   // where the following line starts (spaces skipped)
+  bool ellipsis; // text was cut; draw TEXT_ELLIPSIS after length
+};
+
+// Longest run of text that fits maxWidth pixels at size. Breaks after the
+// last whole word that fits (mid-word only if a word is wider than the
+// line). On the last line, text that does not fit is cut and marked for
+// an ellipsis instead.
+TextLine textWrap(const char *text, int16_t maxWidth, uint8_t size, bool lastLine);
+
+// Draw length characters proportionally with their top-left at x, y;
+// returns the x after the last glyph
+int16_t textDraw(Adafruit_GFX &gfx, int16_t x, int16_t y, const char *text, size_t length, uint8_t size,
+                 uint16_t color);
+
+// Wrap text over the lines of a w x h box; returns how much of text was
+// drawn (the rest can continue in another box)
+size_t textBox(Adafruit_GFX &gfx, int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint8_t size,
+               uint16_t color, bool ellipsis);
+
+#endif
@@ -0,0 +1,43 @@
+// Wall-clock persistence across deep sleep and power loss
+// Before deep sleep the time and the RTC timer are stored in RTC memory;
+// on wake the time is restored and the time spent asleep added back from
+// the RTC timer, which keeps running. NVS is only the power-loss fallback:
+// written at most once per TIME_NVS_INTERVAL (counted in wall time, so
+// sleep/wake cycles don't reset it), never every minute.
+#ifndef TIME_KEEPER_H
+#define TIME_KEEPER_H
+
+#include <Arduino.h>
+
+#define TIME_NVS_INTERVAL 3600 // seconds between NVS writes
+#define TIME_VALID_EPOCH 1600000000 // earlier means the clock was never set
+
+enum TimeSource
+{
+  TIME_FROM_NONE, // system clock left as it was
+  TIME_FROM_RTC,  // RTC memory plus time asleep
+  TIME_FROM_NVS,  // last NVS copy (time without power is lost)
+};
+
+struct TimeKeeperStats
+{
+  TimeSource source;
+  uint32_t sleptMs;   // time asleep added back on the last wake
+  uint32_t nvsWrites; // since boot
+};
+
+// Restore the clock at boot
+void timeKeeperBegin(bool wokeFromDeepSleep);
+
+// Periodic NVS copy; cheap unless one is due
+void timeKeeperService();
+
+// Snapshot the clock into RTC memory right before deep sleep
+void timeKeeperBeforeSleep();
+
+// Write the time to NVS now (also used by timeKeeperService())
+void saveCurrentTime();
+
+const TimeKeeperStats &timeKeeperStats();
+
+#endif
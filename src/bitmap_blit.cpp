@@ -0,0 +1,235 @@
+#include "bitmap_blit.h"
+
+static BlitStats counters = {};
+
+const BlitStats &blitStats() { return counters; }
+
+// Transpose an 8x8 bit block (Hacker's Delight 7-3). rows[0] is the top row,
+// MSB leftmost; cols[i] receives column i with the top row in bit 0, which
+// is the SSD1306 page byte layout.
+static inline void transpose8(const uint8_t rows[8], uint8_t cols[8])
+{
+  // Loading the rows bottom-up makes the result LSB-top
+  uint32_t x = ((uint32_t)rows[7] << 24) | ((uint32_t)rows[6] << 16) | ((uint32_t)rows[5] << 8) | rows[4];
+  uint32_t y = ((uint32_t)rows[3] << 24) | ((uint32_t)rows[2] << 16) | ((uint32_t)rows[1] << 8) | rows[0];
+  uint32_t t;
+
+  t = (x ^ (x >> 7)) & 0x00AA00AA;
+  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;
+  y = y ^ t ^ (t << 7);
+
+  t = (x ^ (x >> 14)) & 0x0000CCCC;
+  x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC;
+  y = y ^ t ^ (t << 14);
+
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+
+  cols[0] = x >> 24;
+  cols[1] = x >> 16;
+  cols[2] = x >> 8;
+  cols[3] = x;
+  cols[4] = y >> 24;
+  cols[5] = y >> 16;
+  cols[6] = y >> 8;
+  cols[7] = y;
+}
+
+static inline void plot(uint8_t *dst, uint8_t bits, uint16_t color)
+{
+  if (color == SSD1306_WHITE)
+  {
+    *dst |= bits;
+  }
+  else if (color == SSD1306_BLACK)
+  {
+    *dst &= ~bits;
+  }
+  else
+  {
+    *dst ^= bits;
+  }
+}
+
+void blitBitmap(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t *bitmap,
+                int16_t w, int16_t h, uint16_t color)
+{
+  uint8_t *buffer = display.getBuffer();
+  int16_t width = display.width();
+  int16_t height = display.height();
+
+  if (w <= 0 || h <= 0)
+  {
+    return;
+  }
+  if (buffer == nullptr || display.getRotation() != 0 || x < 0 || y < 0 || x + w > width || y + h > height)
+  {
+    counters.fallbacks++;
+    display.drawBitmap(x, y, bitmap, w, h, color);
+    return;
+  }
+
+  int16_t rowBytes = (w + 7) / 8;
+  uint8_t shift = y & 7;
+  uint8_t *pageRow = buffer + (y / 8) * width + x;
+  if (shift == 0)
+  {
+    counters.aligned++;
+  }
+  else
+  {
+    counters.unaligned++;
+  }
+
+  for (int16_t band = 0; band < h; band += 8)
+  {
+    int16_t bandRows = min((int16_t)8, (int16_t)(h - band));
+    const uint8_t *src = bitmap + band * rowBytes;
+
+    for (int16_t group = 0; group < rowBytes; group++)
+    {
+      // Rows past the bitmap height stay clear, so they never draw
+      uint8_t rows[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      for (int16_t r = 0; r < bandRows; r++)
+      {
+        rows[r] = pgm_read_byte(src + r * rowBytes + group);
+      }
+      if ((rows[0] | rows[1] | rows[2] | rows[3] | rows[4] | rows[5] | rows[6] | rows[7]) == 0)
+      {
+        continue;
+      }
+
+      uint8_t cols[8];
+      transpose8(rows, cols);
+      int16_t count = min((int16_t)8, (int16_t)(w - group * 8));
+      uint8_t *dst = pageRow + group * 8;
+
+      for (int16_t c = 0; c < count; c++)
+      {
+        if (cols[c] == 0)
+        {
+          continue;
+        }
+        if (shift == 0)
+        {
+          plot(dst + c, cols[c], color);
+        }
+        else
+        {
+          // Straddles two pages; rows that spill are inside the bitmap, so
+          // the page below is on screen
+          plot(dst + c, cols[c] << shift, color);
+          uint8_t spill = cols[c] >> (8 - shift);
+          if (spill != 0)
+          {
+            plot(dst + c + width, spill, color);
+          }
+        }
+      }
+    }
+    pageRow += width;
+  }
+}
+
+void bitmapToPages(const uint8_t *bitmap, int16_t w, int16_t h, uint8_t *pages)
+{
+  int16_t rowBytes = (w + 7) / 8;
+  for (int16_t band = 0; band < h; band += 8)
+  {
+    int16_t bandRows = min((int16_t)8, (int16_t)(h - band));
+    const uint8_t *src = bitmap + band * rowBytes;
+    uint8_t *dst = pages + (band / 8) * w;
+
+    for (int16_t group = 0; group < rowBytes; group++)
+    {
+      uint8_t rows[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      for (int16_t r = 0; r < bandRows; r++)
+      {
+        rows[r] = pgm_read_byte(src + r * rowBytes + group);
+      }
+      uint8_t cols[8];
+      transpose8(rows, cols);
+      int16_t count = min((int16_t)8, (int16_t)(w - group * 8));
+      memcpy(dst + group * 8, cols, count);
+    }
+  }
+}
+
+bool blitPages(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t *pages,
+               int16_t w, int16_t h, uint16_t color)
+{
+  uint8_t *buffer = display.getBuffer();
+  int16_t width = display.width();
+  if (buffer == nullptr || display.getRotation() != 0 || (y & 7) != 0 || x < 0 || y < 0 ||
+      x + w > width || y + h > display.height())
+  {
+    return false;
+  }
+
+  counters.aligned++;
+  uint8_t *dst = buffer + (y / 8) * width + x;
+  for (int16_t page = 0; page < (h + 7) / 8; page++)
+  {
+    for (int16_t c = 0; c < w; c++)
+    {
+      plot(dst + c, pages[c], color);
+    }
+    pages += w;
+    dst += width;
+  }
+  return true;
+}
+
+#ifdef BLIT_BENCH
+void blitBenchmark(Adafruit_SSD1306 &display, Print &out)
+{
+  static uint8_t bitmap[48 * 6];
+  static uint8_t expected[128 * 64 / 8];
+  const size_t bufferSize = min((size_t)(display.width() * display.height() / 8), sizeof(expected));
+  const int runs = 200;
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < sizeof(bitmap); i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    bitmap[i] = seed >> 16;
+  }
+
+  bool ok = true;
+  for (int16_t y = 0; y < 16; y++)
+  {
+    display.clearDisplay();
+    display.drawBitmap(3, y, bitmap, 48, 48, SSD1306_WHITE);
+    memcpy(expected, display.getBuffer(), bufferSize);
+    display.clearDisplay();
+    blitBitmap(display, 3, y, bitmap, 48, 48, SSD1306_WHITE);
+    ok = ok && memcmp(expected, display.getBuffer(), bufferSize) == 0;
+  }
+
+  uint32_t start = micros();
+  for (int i = 0; i < runs; i++)
+  {
+    display.drawBitmap(0, 8, bitmap, 48, 48, SSD1306_WHITE);
+  }
+  uint32_t gfxUs = micros() - start;
+  start = micros();
+  for (int i = 0; i < runs; i++)
+  {
+    blitBitmap(display, 0, 8, bitmap, 48, 48, SSD1306_WHITE);
+  }
+  uint32_t blitUs = micros() - start;
+  start = micros();
+  for (int i = 0; i < runs; i++)
+  {
+    blitBitmap(display, 0, 5, bitmap, 48, 48, SSD1306_WHITE);
+  }
+  uint32_t shiftedUs = micros() - start;
+  display.clearDisplay();
+
+  out.printf("Blit self-test %s | 48x48: drawBitmap %lu us, blit %lu us (aligned), %lu us (unaligned)\n",
+             ok ? "passed" : "FAILED", (unsigned long)(gfxUs / runs), (unsigned long)(blitUs / runs),
+             (unsigned long)(shiftedUs / runs));
+}
+#endif
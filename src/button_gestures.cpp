@@ -0,0 +1,225 @@
+#include "button_gestures.h"
+#include <atomic>
+#include "power_scheduler.h"
+
+struct ButtonEdge
+{
+  uint32_t ms;
+  bool pressed;
+};
+
+enum ButtonState : uint8_t
+{
+  BUTTON_IDLE,
+  BUTTON_FIRST_PRESS,   // down, timing short vs long
+  BUTTON_WAIT_SECOND,   // short press released, double still possible
+  BUTTON_SECOND_PRESS,  // down again: double on release, repeat if held
+  BUTTON_REPEATING,
+  BUTTON_WAIT_RELEASE,  // long press reported; ignore the release
+};
+
+// Single producer (the ISR), single consumer (buttonPoll)
+static ButtonEdge edgeQueue[BUTTON_QUEUE_SIZE];
+static std::atomic<uint8_t> edgeHead(0);
+static std::atomic<uint8_t> edgeTail(0);
+static std::atomic<uint32_t> isrEdges(0);
+static std::atomic<uint32_t> isrOverflows(0);
+
+static uint8_t buttonPin = 0;
+static ButtonState state = BUTTON_IDLE;
+static bool debouncedPressed = false;
+static uint32_t lastEdgeMs = 0;
+static uint32_t stateSinceMs = 0; // when the current state was entered
+static uint32_t nextRepeatMs = 0;
+static bool pinSuspect = false; // an edge was dropped: the pin may disagree
+static uint32_t overflowsSeen = 0;
+static ButtonStats counters = {};
+
+static void IRAM_ATTR buttonEdgeISR()
+{
+  uint8_t head = edgeHead.load(std::memory_order_relaxed);
+  isrEdges.fetch_add(1, std::memory_order_relaxed);
+  if ((uint8_t)(head - edgeTail.load(std::memory_order_acquire)) >= BUTTON_QUEUE_SIZE)
+  {
+    isrOverflows.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  edgeQueue[head % BUTTON_QUEUE_SIZE] = {(uint32_t)millis(), digitalRead(buttonPin) == LOW};
+  edgeHead.store(head + 1, std::memory_order_release);
+  powerWakeFromISR();
+}
+
+void buttonBegin(uint8_t pin)
+{
+  buttonPin = pin;
+  pinMode(pin, INPUT_PULLUP);
+  state = BUTTON_IDLE;
+  debouncedPressed = digitalRead(pin) == LOW;
+  // Held through boot (BOOT held at power-up, or the wake press itself):
+  // wait for the release rather than reporting a gesture
+  if (debouncedPressed)
+  {
+    state = BUTTON_WAIT_RELEASE;
+  }
+  lastEdgeMs = millis();
+  pinSuspect = false;
+  overflowsSeen = isrOverflows.load();
+  edgeTail.store(edgeHead.load());
+  attachInterrupt(digitalPinToInterrupt(pin), buttonEdgeISR, CHANGE);
+}
+
+static ButtonGesture enter(ButtonState next, uint32_t ms, ButtonGesture gesture)
+{
+  state = next;
+  stateSinceMs = ms;
+  if (gesture != GESTURE_NONE)
+  {
+    counters.gestures++;
+  }
+  return gesture;
+}
+
+// Debounced press or release
+static ButtonGesture onEdge(bool pressed, uint32_t ms)
+{
+  switch (state)
+  {
+  case BUTTON_IDLE:
+    return pressed ? enter(BUTTON_FIRST_PRESS, ms, GESTURE_NONE) : GESTURE_NONE;
+  case BUTTON_FIRST_PRESS:
+    if (!pressed)
+    {
+      // Between short and long: released without a gesture
+      return enter(ms - stateSinceMs < BUTTON_SHORT_MAX ? BUTTON_WAIT_SECOND : BUTTON_IDLE, ms, GESTURE_NONE);
+    }
+    break;
+  case BUTTON_WAIT_SECOND:
+    return pressed ? enter(BUTTON_SECOND_PRESS, ms, GESTURE_NONE) : GESTURE_NONE;
+  case BUTTON_SECOND_PRESS:
+    return pressed ? GESTURE_NONE : enter(BUTTON_IDLE, ms, GESTURE_DOUBLE);
+  case BUTTON_REPEATING:
+  case BUTTON_WAIT_RELEASE:
+    return pressed ? GESTURE_NONE : enter(BUTTON_IDLE, ms, GESTURE_NONE);
+  }
+  return GESTURE_NONE;
+}
+
+// Gestures that come from time passing rather than an edge
+static ButtonGesture onTime(uint32_t ms)
+{
+  uint32_t elapsed = ms - stateSinceMs;
+  switch (state)
+  {
+  case BUTTON_FIRST_PRESS:
+    return elapsed >= BUTTON_LONG_PRESS ? enter(BUTTON_WAIT_RELEASE, ms, GESTURE_LONG) : GESTURE_NONE;
+  case BUTTON_WAIT_SECOND:
+    return elapsed >= BUTTON_DOUBLE_GAP ? enter(BUTTON_IDLE, ms, GESTURE_SHORT) : GESTURE_NONE;
+  case BUTTON_SECOND_PRESS:
+    if (elapsed >= BUTTON_REPEAT_DELAY)
+    {
+      nextRepeatMs = ms + BUTTON_REPEAT_INTERVAL;
+      return enter(BUTTON_REPEATING, ms, GESTURE_REPEAT);
+    }
+    break;
+  case BUTTON_REPEATING:
+    if ((int32_t)(ms - nextRepeatMs) >= 0)
+    {
+      nextRepeatMs += BUTTON_REPEAT_INTERVAL;
+      counters.gestures++;
+      return GESTURE_REPEAT;
+    }
+    break;
+  default:
+    break;
+  }
+  return GESTURE_NONE;
+}
+
+ButtonGesture buttonPoll()
+{
+  // Edges first, in order; each may complete a gesture
+  uint8_t tail = edgeTail.load(std::memory_order_relaxed);
+  while (tail != edgeHead.load(std::memory_order_acquire))
+  {
+    ButtonEdge edge = edgeQueue[tail % BUTTON_QUEUE_SIZE];
+    edgeTail.store(++tail, std::memory_order_release);
+
+    // The first edge of a change counts, the bounce after it does not
+    if (edge.pressed == debouncedPressed || edge.ms - lastEdgeMs < BUTTON_DEBOUNCE_MS)
+    {
+      counters.bounces++;
+      pinSuspect = true;
+      continue;
+    }
+    debouncedPressed = edge.pressed;
+    lastEdgeMs = edge.ms;
+
+    // A gesture timeout that expired before this edge comes first
+    ButtonGesture gesture = onTime(edge.ms);
+    if (gesture == GESTURE_NONE)
+    {
+      gesture = onEdge(edge.pressed, edge.ms);
+    }
+    else
+    {
+      onEdge(edge.pressed, edge.ms);
+    }
+    if (gesture != GESTURE_NONE)
+    {
+      return gesture;
+    }
+  }
+
+  uint32_t now = millis();
+  // A dropped bounce may have left the pin opposite to the last accepted
+  // edge (as may a full queue): once it has settled, read the pin once
+  uint32_t overflows = isrOverflows.load(std::memory_order_relaxed);
+  pinSuspect |= overflows != overflowsSeen;
+  overflowsSeen = overflows;
+  if (pinSuspect && now - lastEdgeMs >= BUTTON_DEBOUNCE_MS)
+  {
+    pinSuspect = false;
+    bool pressed = digitalRead(buttonPin) == LOW;
+    if (pressed != debouncedPressed)
+    {
+      debouncedPressed = pressed;
+      lastEdgeMs = now;
+      ButtonGesture gesture = onEdge(pressed, now);
+      if (gesture != GESTURE_NONE)
+      {
+        return gesture;
+      }
+    }
+  }
+  return onTime(now);
+}
+
+uint32_t buttonMsUntilDue()
+{
+  uint32_t elapsed = millis() - stateSinceMs;
+  uint32_t due;
+  switch (state)
+  {
+  case BUTTON_FIRST_PRESS:
+    due = BUTTON_LONG_PRESS;
+    break;
+  case BUTTON_WAIT_SECOND:
+    due = BUTTON_DOUBLE_GAP;
+    break;
+  case BUTTON_SECOND_PRESS:
+    due = BUTTON_REPEAT_DELAY;
+    break;
+  case BUTTON_REPEATING:
+    return max((int32_t)(nextRepeatMs - millis()), (int32_t)0);
+  default:
+    return 0xFFFFFFFF;
+  }
+  return elapsed >= due ? 0 : due - elapsed;
+}
+
+const ButtonStats &buttonStats()
+{
+  counters.edges = isrEdges.load(std::memory_order_relaxed);
+  counters.overflows = isrOverflows.load(std::memory_order_relaxed);
+  return counters;
+}
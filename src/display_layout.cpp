@@ -0,0 +1,154 @@
+#include "display_layout.h"
+
+const char *layoutText(const NavSnapshot &nav, LayoutField field)
+{
+  switch (field)
+  {
+  case FIELD_ETA:
+    return nav.eta;
+  case FIELD_TITLE:
+    return nav.title;
+  case FIELD_DURATION:
+    return nav.duration;
+  case FIELD_DISTANCE:
+    return nav.distance;
+  case FIELD_DIRECTIONS:
+    return nav.directions;
+  case FIELD_CLOCK:
+    return nav.clock;
+  default:
+    return "";
+  }
+}
+
+size_t OledLayoutRenderer::drawText(Adafruit_SSD1306 &display, const LayoutWidget &w, const char *text)
+{
+  if (w.fit == FIT_CLIP)
+  {
+    // One line, cut at the last glyph that fits (no word breaking)
+    size_t length = 0;
+    int16_t x = 0;
+    while (text[length] != '\0' && x + (textGlyph(text[length]) & 0x0F) * w.size <= w.w)
+    {
+      x += textAdvance(text[length]) * w.size;
+      length++;
+    }
+    textDraw(display, w.x, w.y, text, length, w.size, SSD1306_WHITE);
+    return length;
+  }
+  if (w.fit == FIT_MARQUEE)
+  {
+    size_t length = strlen(text);
+    if (textWidth(text, length, w.size) <= w.w)
+    {
+      textDraw(display, w.x, w.y, text, length, w.size, SSD1306_WHITE);
+      return length;
+    }
+
+    // Start at the beginning of the text and rest there before scrolling
+    snprintf(marqueeText, sizeof(marqueeText), "%s", text);
+    marqueeWidget = &w;
+    marqueeOn = true;
+    marqueeOffset = 0;
+    marqueePeriod = textAdvanceOf(marqueeText) * w.size + MARQUEE_GAP_PX;
+    marqueeAt = millis() + MARQUEE_PAUSE_MS;
+    drawMarquee(display);
+    return length;
+  }
+  return textBox(display, w.x, w.y, w.w, w.h, text, w.size, SSD1306_WHITE, w.fit == FIT_ELLIPSIS);
+}
+
+void OledLayoutRenderer::drawMarquee(Adafruit_SSD1306 &display)
+{
+  const LayoutWidget &w = *marqueeWidget;
+  size_t length = strlen(marqueeText);
+  display.fillRect(w.x, w.y, w.w, w.h, SSD1306_BLACK);
+
+  // The tail of one pass and the head of the next (the panel edge clips)
+  for (int16_t x = w.x - marqueeOffset; x < w.x + w.w; x += marqueePeriod)
+  {
+    textDraw(display, x, w.y, marqueeText, length, w.size, SSD1306_WHITE);
+  }
+}
+
+bool OledLayoutRenderer::animate(Adafruit_SSD1306 &display)
+{
+  if (!valid || !marqueeOn || (long)(millis() - marqueeAt) < 0)
+  {
+    return false;
+  }
+
+  marqueeOffset += MARQUEE_STEP_PX;
+  marqueeAt = millis() + MARQUEE_STEP_MS;
+  if (marqueeOffset >= marqueePeriod)
+  {
+    marqueeOffset = 0; // Back at the start: rest there again
+    marqueeAt = millis() + MARQUEE_PAUSE_MS;
+  }
+  drawMarquee(display);
+  counters.marqueeSteps++;
+  return true;
+}
+
+uint32_t OledLayoutRenderer::msUntilAnimate() const
+{
+  if (!valid || !marqueeOn)
+  {
+    return MARQUEE_IDLE;
+  }
+  long wait = (long)(marqueeAt - millis());
+  return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void OledLayoutRenderer::draw(Adafruit_SSD1306 &display, IconCache &icons, const NavSnapshot &nav)
+{
+  // Something else drew over the screen: start from a blank buffer
+  if (!valid)
+  {
+    display.clearDisplay();
+  }
+  // A FIT_WRAP widget hands the rest of its text to the next widget of
+  // the same field. Both share one print, so they are always redrawn (or
+  // skipped) together and the hand-over offset is never stale.
+  size_t flowed = 0;
+  for (uint8_t i = 0; i < OLED_WIDGET_COUNT; i++)
+  {
+    const LayoutWidget &w = oledNavLayout[i];
+    bool continues = i > 0 && oledNavLayout[i - 1].fit == FIT_WRAP && oledNavLayout[i - 1].field == w.field;
+    if (!continues)
+    {
+      flowed = 0;
+    }
+    uint32_t print = w.fit == FIT_BITMAP ? fnv1a(FNV1A_SEED, nav.icon, sizeof(nav.icon))
+                                         : fnv1a(FNV1A_SEED, layoutText(nav, w.field), strlen(layoutText(nav, w.field)));
+    if (valid && prints[i] == print)
+    {
+      counters.skipped++;
+      continue;
+    }
+    prints[i] = print;
+    counters.drawn++;
+    if (marqueeWidget == &w)
+    {
+      marqueeOn = false; // drawText() restarts it if the new text overflows
+    }
+
+    display.fillRect(w.x, w.y, w.w, w.h, SSD1306_BLACK);
+    if (w.fit == FIT_BITMAP)
+    {
+      icons.draw(display, w.x, w.y, nav.icon);
+    }
+    else
+    {
+      flowed += drawText(display, w, layoutText(nav, w.field) + flowed);
+    }
+  }
+  valid = true;
+}
+
+void layoutLcdText(char *row, const LayoutWidget &w, const char *text)
+{
+  size_t length = strnlen(text, w.w);
+  memcpy(row + w.x, text, length);
+  memset(row + w.x + length, ' ', w.w - length);
+}
@@ -0,0 +1,147 @@
+#include "display_registry.h"
+
+bool DisplayRegistry::add(DisplayType type, uint32_t minFrameMs, const DisplayOps &ops)
+{
+  if (count >= DISPLAY_MAX || has(type))
+  {
+    return false;
+  }
+  Device &device = devices[count++];
+  device = {};
+  device.type = type;
+  device.minFrameMs = minFrameMs;
+  device.ops = ops;
+  device.drawnAt = millis() - minFrameMs; // First model draws at once
+  return true;
+}
+
+bool DisplayRegistry::has(DisplayType type) const
+{
+  return stats(type) != nullptr;
+}
+
+uint8_t DisplayRegistry::mask() const
+{
+  uint8_t bits = 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    bits |= 1 << devices[i].type;
+  }
+  return bits;
+}
+
+void DisplayRegistry::submit(const NavSnapshot &nav)
+{
+  memcpy(&latest, &nav, sizeof(latest));
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Device &device = devices[i];
+    if (device.due)
+    {
+      device.stats.superseded++;
+    }
+    device.due = true;
+  }
+  drawDue();
+  for (uint8_t i = 0; i < count; i++)
+  {
+    devices[i].stats.deferred += devices[i].due ? 1 : 0;
+  }
+}
+
+bool DisplayRegistry::drawDue()
+{
+  bool drew = false;
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Device &device = devices[i];
+    if (!device.due)
+    {
+      continue;
+    }
+    if (now - device.drawnAt < device.minFrameMs)
+    {
+      continue;
+    }
+
+    // A frame still going out is replaced by this one as soon as it ends
+    device.ops.draw(latest);
+    device.due = false;
+    device.drawnAt = now;
+    device.sending = true;
+    device.inFlight = latest.request;
+    device.stats.frames++;
+    drew = true;
+  }
+  return drew;
+}
+
+bool DisplayRegistry::service()
+{
+  bool idle = true;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Device &device = devices[i];
+    device.busy = !device.ops.service();
+    if (device.busy)
+    {
+      idle = false;
+      continue;
+    }
+    if (device.sending)
+    {
+      device.sending = false;
+      device.stats.framesDone++;
+      if (device.inFlight.fromEvent)
+      {
+        device.stats.lastLatencyUs = micros() - device.inFlight.eventUs;
+        device.stats.maxLatencyUs = max(device.stats.maxLatencyUs, device.stats.lastLatencyUs);
+      }
+      displayFrameDone(device.type, i == 0, device.inFlight);
+    }
+  }
+  return idle;
+}
+
+uint32_t DisplayRegistry::animate()
+{
+  if (drawDue())
+  {
+    return 0;
+  }
+
+  uint32_t wait = DISPLAY_IDLE;
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < count; i++)
+  {
+    Device &device = devices[i];
+    if (device.due)
+    {
+      wait = min(wait, (uint32_t)(device.minFrameMs - (now - device.drawnAt)));
+    }
+    // Only this panel's own transfer holds its animation back
+    if (device.ops.animate != nullptr && !device.busy)
+    {
+      uint32_t next = device.ops.animate();
+      if (next == 0)
+      {
+        return 0;
+      }
+      wait = min(wait, next);
+    }
+  }
+  return wait;
+}
+
+const DisplayStats *DisplayRegistry::stats(DisplayType type) const
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (devices[i].type == type)
+    {
+      return &devices[i].stats;
+    }
+  }
+  return nullptr;
+}
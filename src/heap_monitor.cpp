@@ -0,0 +1,30 @@
+#include "heap_monitor.h"
+
+void HeapMonitor::sample()
+{
+  uint32_t freeBytes = ESP.getFreeHeap();
+  uint32_t largest = ESP.getMaxAllocHeap();
+  uint8_t fragmentation = freeBytes > 0 ? 100 - (uint8_t)((uint64_t)largest * 100 / freeBytes) : 0;
+
+  if (current.samples == 0)
+  {
+    firstFree = freeBytes;
+    current.minLargestBlock = largest;
+  }
+  current.samples++;
+  current.freeBytes = freeBytes;
+  current.minFreeBytes = ESP.getMinFreeHeap();
+  current.largestBlock = largest;
+  current.minLargestBlock = min(current.minLargestBlock, largest);
+  current.fragmentation = fragmentation;
+  current.maxFragmentation = max(current.maxFragmentation, fragmentation);
+  current.freeDrift = (int32_t)(freeBytes - firstFree);
+}
+
+void HeapMonitor::print(Print &out) const
+{
+  out.printf("Heap: free %lu (min %lu, drift %ld) | largest block %lu (min %lu) | fragmentation %u%% (max %u%%)\n",
+             (unsigned long)current.freeBytes, (unsigned long)current.minFreeBytes, (long)current.freeDrift,
+             (unsigned long)current.largestBlock, (unsigned long)current.minLargestBlock,
+             current.fragmentation, current.maxFragmentation);
+}
@@ -0,0 +1,287 @@
+#include "i2c_bus.h"
+
+// Candidate clocks, fastest first
+static const uint32_t clockSteps[] = {I2C_CLOCK_FAST_PLUS, I2C_CLOCK_FAST, I2C_CLOCK_STANDARD};
+
+bool I2cBus::begin(TwoWire *wire, uint8_t sda, uint8_t scl)
+{
+  this->wire = wire;
+  this->sda = sda;
+  this->scl = scl;
+#ifdef ARDUINO_ARCH_ESP32
+  if (mutex == nullptr)
+  {
+    mutex = xSemaphoreCreateRecursiveMutex();
+  }
+#endif
+
+  // A slave reset mid-byte (brown-out, deep sleep while sending) can still
+  // be holding SDA from before the reboot
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, INPUT_PULLUP);
+  bool released = true;
+  if (stuck())
+  {
+    released = recover();
+  }
+  wire->begin(sda, scl);
+  clock = 0;
+  return released;
+}
+
+uint32_t I2cBus::attach(uint8_t address, uint32_t maxClock, const I2cProbe &probe)
+{
+  take();
+  I2cDeviceStats *device = find(address);
+  if (device == nullptr && devices < I2C_MAX_DEVICES)
+  {
+    device = &table[devices++];
+    *device = {};
+    device->address = address;
+  }
+
+  uint32_t chosen = 0;
+  for (uint32_t step : clockSteps)
+  {
+    if (step <= maxClock)
+    {
+      useClock(step);
+      if (selfTest(address, probe))
+      {
+        chosen = step;
+        break;
+      }
+    }
+  }
+  if (device != nullptr)
+  {
+    device->clock = chosen;
+  }
+  give();
+  return chosen;
+}
+
+bool I2cBus::attachAt(uint8_t address, uint32_t clock)
+{
+  take();
+  I2cDeviceStats *device = find(address);
+  if (device == nullptr && devices < I2C_MAX_DEVICES)
+  {
+    device = &table[devices++];
+    *device = {};
+    device->address = address;
+  }
+  if (device != nullptr)
+  {
+    device->clock = clock;
+  }
+  give();
+  return device != nullptr && clock != 0;
+}
+
+bool I2cBus::selfTest(uint8_t address, const I2cProbe &probe)
+{
+  for (uint8_t round = 0; round < I2C_SELF_TEST_ROUNDS; round++)
+  {
+    wire->beginTransmission(address);
+    if (probe.readback)
+    {
+      uint8_t value = probe.bytes[round % probe.length];
+      wire->write(value);
+      if (wire->endTransmission() != 0 || wire->requestFrom(address, (uint8_t)1) != 1 ||
+          wire->read() != value)
+      {
+        return false;
+      }
+    }
+    else
+    {
+      wire->write(probe.bytes, probe.length);
+      if (wire->endTransmission() != 0)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool I2cBus::probe(uint8_t address)
+{
+  return transfer(find(address), false, 0, nullptr, 0);
+}
+
+bool I2cBus::write(uint8_t address, const uint8_t *data, size_t length)
+{
+  return transfer(find(address), false, 0, data, length);
+}
+
+bool I2cBus::write(uint8_t address, uint8_t control, const uint8_t *data, size_t length)
+{
+  return transfer(find(address), true, control, data, length);
+}
+
+bool I2cBus::transfer(I2cDeviceStats *device, bool hasControl, uint8_t control, const uint8_t *data, size_t length)
+{
+  if (device == nullptr || device->clock == 0)
+  {
+    return false; // Not attached, or not answering
+  }
+
+  take();
+  useClock(device->clock);
+  uint8_t result = 0;
+  for (uint8_t attempt = 0;; attempt++)
+  {
+    wire->beginTransmission(device->address);
+    if (hasControl)
+    {
+      wire->write(control);
+    }
+    if (length > 0)
+    {
+      wire->write(data, length);
+    }
+    result = wire->endTransmission();
+    device->transactions++;
+    // A NACK may come after the device took part of the payload, and a
+    // resend would hand it those bytes twice
+    bool payload = hasControl || length > 0;
+    if (result != I2C_ERROR_NACK || payload || attempt >= I2C_PROBE_RETRIES)
+    {
+      break;
+    }
+    device->retries++;
+  }
+
+  if (result != 0)
+  {
+    device->errors++;
+    if (stuck())
+    {
+      recover();
+    }
+  }
+  give();
+  return result == 0;
+}
+
+bool I2cBus::stuck() const
+{
+  return digitalRead(sda) == LOW || digitalRead(scl) == LOW;
+}
+
+bool I2cBus::recover()
+{
+  take();
+  counters.stuck++;
+  wire->end();
+
+  // Clock until the slave finishes its byte and lets go of SDA
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, OUTPUT_OPEN_DRAIN);
+  digitalWrite(scl, HIGH);
+  for (uint8_t pulse = 0; pulse < I2C_RECOVERY_PULSES && digitalRead(sda) == LOW; pulse++)
+  {
+    digitalWrite(scl, LOW);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    digitalWrite(scl, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  }
+
+  // STOP (SDA rising while SCL is high) resets every slave's bus logic
+  pinMode(sda, OUTPUT_OPEN_DRAIN);
+  digitalWrite(scl, LOW);
+  digitalWrite(sda, LOW);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  digitalWrite(scl, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  digitalWrite(sda, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, INPUT_PULLUP);
+  bool released = !stuck();
+  if (released)
+  {
+    counters.recoveries++;
+  }
+  else
+  {
+    counters.failedRecoveries++;
+  }
+
+  wire->begin(sda, scl);
+  clock = 0;
+  give();
+  return released;
+}
+
+void I2cBus::useClock(uint32_t frequency)
+{
+  if (clock != frequency)
+  {
+    wire->setClock(frequency);
+    clock = frequency;
+  }
+}
+
+void I2cBus::lock()
+{
+  take();
+  clock = 0; // The library may set its own clock
+}
+
+void I2cBus::unlock() { give(); }
+
+void I2cBus::print(Print &out) const
+{
+  for (uint8_t i = 0; i < devices; i++)
+  {
+    const I2cDeviceStats &d = table[i];
+    out.printf("I2C 0x%02X: %lu Hz | %lu transactions, %lu errors, %lu retries\n", d.address,
+               (unsigned long)d.clock, (unsigned long)d.transactions, (unsigned long)d.errors,
+               (unsigned long)d.retries);
+  }
+  out.printf("I2C bus: stuck %lu times, %lu recovered, %lu not\n", (unsigned long)counters.stuck,
+             (unsigned long)counters.recoveries, (unsigned long)counters.failedRecoveries);
+}
+
+const I2cDeviceStats *I2cBus::device(uint8_t address) const
+{
+  for (uint8_t i = 0; i < devices; i++)
+  {
+    if (table[i].address == address)
+    {
+      return &table[i];
+    }
+  }
+  return nullptr;
+}
+
+I2cDeviceStats *I2cBus::find(uint8_t address) { return const_cast<I2cDeviceStats *>(device(address)); }
+
+#ifdef ARDUINO_ARCH_ESP32
+
+void I2cBus::take()
+{
+  if (mutex != nullptr)
+  {
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  }
+}
+
+void I2cBus::give()
+{
+  if (mutex != nullptr)
+  {
+    xSemaphoreGiveRecursive(mutex);
+  }
+}
+
+#else
+
+void I2cBus::take() {}
+void I2cBus::give() {}
+
+#endif
@@ -0,0 +1,221 @@
+#include "icon_cache.h"
+#include "bitmap_blit.h"
+#include "profiler.h"
+
+#define ICON_CACHE_MAGIC 0x324E4349 // "ICN2"
+
+// On-flash layout: header, then one record per entry, most used first
+struct IconFileHeader
+{
+  uint32_t magic;
+  uint16_t count;
+  uint16_t recordSize;
+  uint32_t checksum;      // FNV-1a over all records
+  uint32_t convertCycles; // cost of one conversion, so hits on restored entries count as saved
+};
+
+struct IconFileRecord
+{
+  uint32_t hash;
+  uint16_t uses;
+  uint16_t reserved;
+  uint8_t pages[ICON_PAGE_BYTES];
+};
+
+void IconCache::begin(fs::FS *fs)
+{
+  this->fs = fs;
+  count = 0;
+  useClock = 0;
+  dirty = false;
+  counters = {};
+  restoredCost = 0;
+  lastSave = millis();
+  if (fs == nullptr)
+  {
+    return;
+  }
+
+  File file = fs->open(ICON_CACHE_FILE, FILE_READ);
+  if (!file)
+  {
+    return;
+  }
+
+  IconFileHeader header;
+  if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != ICON_CACHE_MAGIC ||
+      header.recordSize != sizeof(IconFileRecord) || header.count > ICON_CACHE_SLOTS)
+  {
+    file.close();
+    return;
+  }
+
+  uint32_t checksum = FNV1A_SEED;
+  for (uint16_t i = 0; i < header.count; i++)
+  {
+    IconFileRecord record;
+    if (file.read((uint8_t *)&record, sizeof(record)) != sizeof(record))
+    {
+      break;
+    }
+    checksum = fnv1a(checksum, &record, sizeof(record));
+
+    Entry &entry = entries[count++];
+    entry.hash = record.hash;
+    entry.uses = record.uses;
+    entry.lastUse = 0;
+    entry.restored = true;
+    memcpy(entry.pages, record.pages, sizeof(entry.pages));
+  }
+  file.close();
+
+  // A torn or stale file is ignored rather than half trusted
+  if (count != header.count || checksum != header.checksum)
+  {
+    count = 0;
+    return;
+  }
+  counters.restored = count;
+  restoredCost = header.convertCycles;
+}
+
+uint32_t IconCache::convertCost() const
+{
+  return counters.misses > 0 ? (uint32_t)(counters.convertCycles / counters.misses) : restoredCost;
+}
+
+IconCache::Entry *IconCache::find(uint32_t hash)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (entries[i].hash == hash)
+    {
+      return &entries[i];
+    }
+  }
+  return nullptr;
+}
+
+IconCache::Entry *IconCache::insert(uint32_t hash, const uint8_t *icon)
+{
+  Entry *entry;
+  if (count < ICON_CACHE_SLOTS)
+  {
+    entry = &entries[count++];
+  }
+  else
+  {
+    entry = &entries[0];
+    for (uint8_t i = 1; i < count; i++)
+    {
+      if (entries[i].lastUse < entry->lastUse)
+      {
+        entry = &entries[i];
+      }
+    }
+    counters.evictions++;
+  }
+
+  entry->hash = hash;
+  entry->uses = 0;
+  entry->restored = false;
+  bitmapToPages(icon, ICON_WIDTH, ICON_HEIGHT, entry->pages);
+  dirty = true;
+  return entry;
+}
+
+void IconCache::draw(Adafruit_SSD1306 &display, int16_t x, int16_t y, const uint8_t icon[NAV_ICON_BYTES])
+{
+  uint32_t hash = fnv1a(FNV1A_SEED, icon, NAV_ICON_BYTES);
+  Entry *entry = find(hash);
+
+  if (entry != nullptr)
+  {
+    counters.hits++;
+    if (entry->restored)
+    {
+      counters.restoredHits++;
+    }
+    counters.savedCycles += convertCost();
+  }
+  else
+  {
+    counters.misses++;
+    uint32_t start = ESP.getCycleCount();
+    entry = insert(hash, icon);
+    counters.convertCycles += profilerCycles(ESP.getCycleCount() - start);
+  }
+
+  entry->lastUse = ++useClock;
+  if (entry->uses < 0xFFFF)
+  {
+    entry->uses++;
+  }
+
+  if (!blitPages(display, x, y, entry->pages, ICON_WIDTH, ICON_HEIGHT, SSD1306_WHITE))
+  {
+    blitBitmap(display, x, y, icon, ICON_WIDTH, ICON_HEIGHT, SSD1306_WHITE);
+  }
+}
+
+bool IconCache::save(bool force)
+{
+  if (fs == nullptr || !dirty || (!force && millis() - lastSave < ICON_CACHE_SAVE_INTERVAL))
+  {
+    return false;
+  }
+  lastSave = millis();
+
+  // Most used first, so a smaller cache on the next boot keeps the hot set
+  uint8_t order[ICON_CACHE_SLOTS];
+  for (uint8_t i = 0; i < count; i++)
+  {
+    order[i] = i;
+    for (uint8_t j = i; j > 0 && entries[order[j]].uses > entries[order[j - 1]].uses; j--)
+    {
+      uint8_t swap = order[j];
+      order[j] = order[j - 1];
+      order[j - 1] = swap;
+    }
+  }
+
+  static IconFileRecord records[ICON_CACHE_SLOTS];
+  IconFileHeader header = {ICON_CACHE_MAGIC, count, sizeof(IconFileRecord), FNV1A_SEED, convertCost()};
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const Entry &entry = entries[order[i]];
+    IconFileRecord &record = records[i];
+    record.hash = entry.hash;
+    record.uses = entry.uses;
+    record.reserved = 0;
+    memcpy(record.pages, entry.pages, sizeof(record.pages));
+    header.checksum = fnv1a(header.checksum, &record, sizeof(record));
+  }
+
+  File file = fs->open(ICON_CACHE_FILE, FILE_WRITE);
+  if (!file)
+  {
+    return false;
+  }
+  bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            file.write((const uint8_t *)records, count * sizeof(IconFileRecord)) == count * sizeof(IconFileRecord);
+  file.close();
+
+  if (ok)
+  {
+    dirty = false;
+    counters.saves++;
+  }
+  return ok;
+}
+
+void IconCache::printStats(Print &out) const
+{
+  uint32_t lookups = counters.hits + counters.misses;
+  out.printf("Icons: %lu hits, %lu misses (%lu%% hit rate), %lu from flash (%lu hits), %lu evictions, %lu us saved\n",
+             (unsigned long)counters.hits, (unsigned long)counters.misses,
+             (unsigned long)(lookups > 0 ? counters.hits * 100ULL / lookups : 0),
+             (unsigned long)counters.restored, (unsigned long)counters.restoredHits,
+             (unsigned long)counters.evictions,
+             (unsigned long)(counters.savedCycles / PROF_CLOCK_MHZ));
+}
@@ -0,0 +1,155 @@
+#include "lcd_flush.h"
+
+#define LCD_SET_DDRAM 0x80
+#define LCD_ROW1_ADDRESS 0x40
+
+static void copyRow(char *dst, const char *src)
+{
+  size_t length = strnlen(src, LCD_COLS);
+  memcpy(dst, src, length);
+  memset(dst + length, ' ', LCD_COLS - length);
+}
+
+void LcdTextFlush::begin(I2cBus *bus, uint8_t address)
+{
+  this->bus = bus;
+  this->address = address;
+  sending = false;
+  commitPending = false;
+  invalidate();
+}
+
+void LcdTextFlush::invalidate()
+{
+  shadowValid = false;
+  cursor = 0xFF;
+}
+
+void LcdTextFlush::commit(const char *row0, const char *row1)
+{
+  char(*dst)[LCD_COLS] = sending ? pendingText : sendText;
+  copyRow(dst[0], row0);
+  copyRow(dst[1], row1);
+
+  if (sending)
+  {
+    commitPending = true;
+    return;
+  }
+  sending = true;
+  position = 0;
+}
+
+void LcdTextFlush::setBacklight(bool on)
+{
+  uint8_t bits = on ? LCD_PCF_BACKLIGHT : 0;
+  backlightChanged = backlightChanged || bits != backlight;
+  backlight = bits;
+}
+
+void LcdTextFlush::flush(const char *row0, const char *row1)
+{
+  commit(row0, row1);
+  while (!step())
+  {
+  }
+}
+
+// Expander bytes for one 8-bit HD44780 write in 4-bit mode. Data is set up
+// with EN low, latched on EN's falling edge, and held for one more byte.
+void LcdTextFlush::queueWrite(uint8_t *out, uint8_t value, bool data) const
+{
+  uint8_t mode = backlight | (data ? LCD_PCF_RS : 0);
+  uint8_t high = (value & 0xF0) | mode;
+  uint8_t low = ((value << 4) & 0xF0) | mode;
+  out[0] = high;
+  out[1] = high | LCD_PCF_EN;
+  out[2] = high;
+  out[3] = low;
+  out[4] = low | LCD_PCF_EN;
+  out[5] = low;
+}
+
+bool LcdTextFlush::step(uint8_t budget)
+{
+  if (!sending || bus == nullptr)
+  {
+    return true;
+  }
+
+  // One transaction per step: a cursor move per run plus budget cells
+  uint8_t packet[LCD_STEP_CHARS * 2 * LCD_PCF_BYTES_PER_WRITE];
+  budget = min(budget, (uint8_t)LCD_STEP_CHARS);
+  size_t length = 0;
+
+  while (position < LCD_ROWS * LCD_COLS && budget > 0)
+  {
+    uint8_t row = position / LCD_COLS;
+    uint8_t col = position % LCD_COLS;
+    char c = sendText[row][col];
+
+    if (shadowValid && shadow[row][col] == c)
+    {
+      totals.skipped++;
+      position++;
+      continue;
+    }
+
+    if (cursor != position)
+    {
+      queueWrite(packet + length, LCD_SET_DDRAM | (row ? LCD_ROW1_ADDRESS : 0) | col, false);
+      length += LCD_PCF_BYTES_PER_WRITE;
+      totals.cursorMoves++;
+    }
+    queueWrite(packet + length, (uint8_t)c, true);
+    length += LCD_PCF_BYTES_PER_WRITE;
+    shadow[row][col] = c;
+    totals.chars++;
+    position++;
+    budget--;
+
+    // The address counter runs on past column 15 into unused DDRAM, not
+    // onto the next row
+    cursor = (col + 1 < LCD_COLS) ? position : 0xFF;
+  }
+
+  // Nothing to write, but the backlight pin still has to change
+  if (backlightChanged && length == 0)
+  {
+    packet[length++] = backlight;
+  }
+  backlightChanged = false;
+
+  if (length > 0)
+  {
+    writeFailed = !bus->write(address, packet, length) || writeFailed;
+    totals.transactions++;
+    totals.steps++;
+  }
+
+  if (position >= LCD_ROWS * LCD_COLS)
+  {
+    totals.frames++;
+    shadowValid = !writeFailed;
+    sending = false;
+    bool repair = writeFailed && !repairing && !commitPending;
+    repairing = writeFailed;
+    writeFailed = false;
+    if (repair)
+    {
+      // Cells may have gone astray: write the same frame again, all of it
+      // (if that fails too, wait for the next frame)
+      cursor = 0xFF;
+      sending = true;
+      position = 0;
+    }
+    else if (commitPending)
+    {
+      memcpy(sendText, pendingText, sizeof(sendText));
+      commitPending = false;
+      sending = true;
+      position = 0;
+    }
+  }
+  return !busy();
+}
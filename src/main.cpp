@@ -5,9 +5,24 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <time.h>
-#include <Preferences.h>
+#include <SPIFFS.h>
 #include <ChronosESP32.h>
 #include "credentials.h"
+#include "app.h"
+#include "redraw_trigger.h"
+#include "render_task.h"
+#include "heap_monitor.h"
+#include "bitmap_blit.h"
+#include "icon_cache.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "time_keeper.h"
+#include "power_scheduler.h"
+#include "button_gestures.h"
+#include "display_layout.h"
+#include "nav_countdown.h"
+#include "route_log.h"
+#include "nav_trace.h"
 
 //////////////////////
 // Wi-Fi settings (from credentials.h) - DISABLED (not needed for Chronos BLE)
@@ -23,43 +38,67 @@
 // const int daylightOffset_sec = 0;
 
 //////////////////////
-// Display (Auto-detect LCD or OLED)
+// Displays (every panel found on the bus)
 //////////////////////
-#define LCD_ADDRESS 0x27
-#define OLED_ADDRESS 0x3C
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 64
 #define OLED_RESET -1
 
+I2cBus i2cBus; // Shared by both panels: clocks, error counters, recovery
 LiquidCrystal_I2C lcd(LCD_ADDRESS, 16, 2);
 Adafruit_SSD1306 oled(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledDeltaFlush oledFlush; // Sends only the changed parts of each OLED frame
+LcdTextFlush lcdFlush;    // Writes only the LCD cells that changed
+IconCache iconCache;      // Turn icons in page layout, persisted to SPIFFS
+OledLayoutRenderer oledLayout; // Navigation screen widgets, redrawn when changed
 
-enum DisplayType
-{
-  DISPLAY_NONE,
-  DISPLAY_LCD,
-  DISPLAY_OLED
-};
-DisplayType displayType = DISPLAY_NONE;
+DisplayRegistry displays; // Each panel paced and dirty-tracked on its own
+NavCountdown navCountdown; // Turn distance counted down between Chronos updates
+NavSnapshot renderModel;   // The last snapshot, with the live distances
+NavTraceWriter navTrace;   // "trace on": navigation changes to Serial for host replay
 
 //////////////////////
 // ChronosESP32 BLE
 //////////////////////
 ChronosESP32 Chronos("ESP32-Nav");
 
-unsigned long lastDisplayUpdate = 0;
+RedrawTrigger redrawTrigger; // Redraws on navigation/connection changes
+
+uint32_t displayFrameCount = 0;
+uint32_t chronosMaxGapUs = 0; // Longest time between two Chronos.loop() calls
+unsigned long lastChronosLoopUs = 0;
 unsigned long lastValidNavTime = 0; // Track when we last had valid navigation data
 bool wasNavigating = false;         // Remember if we were navigating
-unsigned long lastTimeSave = 0;
+bool navDataShown = false;          // The last model had navigation data (no hold running)
+unsigned long lastHeapReport = 0;
+HeapMonitor heapMonitor;
+
+// Displays found on the last full boot and the bus clock each settled on.
+// The panels stay powered through deep sleep, so a button wake can skip
+// probing, the clock self-tests and panel init.
+#define BOOT_CACHE_MAGIC 0x424F4F54 // "BOOT"
+struct BootCache
+{
+  uint32_t magic;
+  uint8_t panels; // DisplayRegistry::mask()
+  uint32_t oledClock;
+  uint32_t lcdClock;
+};
+RTC_DATA_ATTR BootCache bootCache;
+bool fastBoot = false;         // This boot reused bootCache
+uint32_t bootFirstFrameUs = 0; // micros() when the first frame was on screen
 
-// NVS storage for persistent time
-Preferences preferences;
+#define NAV_HOLD_TIME 10000 // Keep showing navigation this long after data disappears
 
 //////////////////////
 // Boot Button Configuration
 //////////////////////
-#define BOOT_BUTTON_PIN 0    // GPIO0 is the BOOT button on ESP32
-#define LONG_PRESS_TIME 3000 // 3 seconds to power off
+#define BOOT_BUTTON_PIN 0 // GPIO0 is the BOOT button on ESP32
+
+uint8_t displayPage = PAGE_MAIN;
+uint8_t brightness = BRIGHTNESS_LEVELS - 1;
+
+// SSD1306 contrast per brightness level (the top one is the init default);
+// the LCD backlight can only switch, so it is off at level 0
+const uint8_t oledContrast[BRIGHTNESS_LEVELS] = {0x08, 0x30, 0x80, 0xCF};
 
 //////////////////////
 // Icons for OLED (16x16 pixels)
@@ -180,53 +219,42 @@ const unsigned char arrow_right_large[] PROGMEM = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-void saveCurrentTime()
+// Print at most maxChars characters of text
+void printClipped(Print &out, const char *text, size_t maxChars)
 {
-  time_t now;
-  time(&now);
-  if (now > 0)
-  {
-    preferences.begin("esp32time", false);
-    preferences.putULong64("savedTime", (uint64_t)now);
-    preferences.end();
-  }
+  out.write((const uint8_t *)text, strnlen(text, maxChars));
 }
 
-void restoreSavedTime()
+void updateDisplayLCD(const NavSnapshot &nav)
 {
-  preferences.begin("esp32time", true);
-  uint64_t savedTime = preferences.getULong64("savedTime", 0);
-  preferences.end();
+  PROF_SCOPE(PROF_RENDER_LCD);
+  char line0[17] = "                ";
+  char line1[17] = "                ";
 
-  if (savedTime > 0)
+  if (nav.page == PAGE_TRIP)
   {
-    struct timeval tv;
-    tv.tv_sec = savedTime;
-    tv.tv_usec = 0;
-    settimeofday(&tv, NULL);
+    snprintf(line0, sizeof(line0), "%s ETA %.5s", nav.clock, nav.eta);
+    snprintf(line1, sizeof(line1), "%.7s %.8s", nav.duration, nav.distance);
+    lcdFlush.commit(line0, line1);
+    return;
   }
-}
-
-void updateDisplayLCD()
-{
-  char line0[17] = "                ";
-  char line1[17] = "                ";
 
   // Line 0: Time and connection status
-  String timeStr = Chronos.getHourZ() + ":" + (Chronos.getHourC() < 10 ? "0" : "") + String(Chronos.getHourC());
-  snprintf(line1, sizeof(line1), "%s BLE:%s",
-           timeStr.c_str(),
+  snprintf(line0, sizeof(line0), "%s BLE:%s",
+           nav.clock,
            // WiFi.status() == WL_CONNECTED ? "OK" : "X",  // WiFi disabled
-           Chronos.isConnected() ? "OK" : "X");
+           nav.connected ? "OK" : "X");
 
   // Line 1: Navigation or status
-  Navigation nav = Chronos.getNavigation();
-  if (Chronos.isConnected() && nav.active && nav.directions != "")
+  if (nav.showNavigation)
   {
-    // nav.distance is already a String like "250m" or "1.5km"
-    snprintf(line1, sizeof(line1), "%s %.8s", nav.distance.c_str(), nav.directions.c_str());
+    // nav.distance is already a string like "250m" or "1.5km"
+    for (const LayoutWidget &w : lcdNavLayout)
+    {
+      layoutLcdText(line1, w, layoutText(nav, w.field));
+    }
   }
-  else if (Chronos.isConnected())
+  else if (nav.connected)
   {
     snprintf(line1, sizeof(line1), "Connected!");
   }
@@ -235,97 +263,53 @@ void updateDisplayLCD()
     snprintf(line1, sizeof(line1), "Wait Chronos...");
   }
 
-  lcd.setCursor(0, 0);
-  lcd.print(line0);
-  lcd.setCursor(0, 1);
-  lcd.print(line1);
+  lcdFlush.commit(line0, line1);
 }
 
-void updateDisplayOLED()
+void updateDisplayOLED(const NavSnapshot &nav)
 {
-  oled.clearDisplay();
+  PROF_SCOPE(PROF_RENDER_OLED);
   oled.setTextColor(SSD1306_WHITE);
 
-  // Get navigation data from Chronos
-  Navigation nav = Chronos.getNavigation();
-
-  // Check if we have valid navigation data
-  bool hasNavData = (nav.active || nav.distance != "" || nav.directions != "" || nav.title != "");
-
-  // Update navigation state tracking
-  if (hasNavData)
+  if (nav.page == PAGE_TRIP)
   {
-    lastValidNavTime = millis();
-    wasNavigating = true;
+    oled.clearDisplay();
+    oledLayout.invalidate();
+    oled.setTextSize(3);
+    oled.setCursor(0, 0);
+    oled.print(nav.clock);
+    oled.setTextSize(1);
+    oled.setCursor(0, 32);
+    oled.print("ETA  ");
+    printClipped(oled, nav.eta, 16);
+    oled.setCursor(0, 44);
+    oled.print("Left ");
+    printClipped(oled, nav.duration, 16);
+    oled.setCursor(0, 56);
+    oled.print("Dist ");
+    printClipped(oled, nav.distance, 16);
+    oledFlush.commit();
+    return;
   }
 
-  // Show navigation if we have data OR if we were navigating recently (within 10 seconds)
-  // This prevents flickering to "Start navigation" during rerouting/road closure alerts
-  bool showNavigation = Chronos.isConnected() && (hasNavData || (wasNavigating && (millis() - lastValidNavTime < 10000)));
-
-  if (showNavigation)
+  if (nav.showNavigation)
   {
-    oled.setTextSize(1);
-
-    // ETA (top left, small)
-    if (nav.eta != "")
-    {
-      oled.setCursor(0, 0);
-      oled.print(nav.eta.substring(0, min(8, (int)nav.eta.length())));
-    }
-
-    // TITLE (top right, large) - Distance to next turn
-    oled.setTextSize(2);
-    oled.setCursor(70, 0);
-    if (nav.title != "")
-    {
-      oled.print(nav.title.substring(0, min(7, (int)nav.title.length())));
-    }
-
-    // DURATION (right side, y=30, small)
-    oled.setTextSize(1);
-    if (nav.duration != "")
-    {
-      oled.setCursor(70, 30);
-      oled.print(nav.duration.substring(0, min(8, (int)nav.duration.length())));
-    }
-
-    // DISTANCE (right side, y=40, small)
-    if (nav.distance != "")
-    {
-      oled.setCursor(70, 40);
-      oled.print(nav.distance.substring(0, min(8, (int)nav.distance.length())));
-    }
+    // Widgets from the layout table; unchanged ones are left as they are
+    oledLayout.draw(oled, iconCache, nav);
+    oledFlush.commit();
+    return;
+  }
 
-    // ICON (left side, 48x48) - Google Maps navigation arrow
-    int iconX = 0;
-    int iconY = 8;
-    oled.drawBitmap(iconX, iconY, nav.icon, 48, 48, SSD1306_WHITE);
+  // Status screens are redrawn whole
+  oled.clearDisplay();
+  oledLayout.invalidate();
 
-    // DIRECTIONS (bottom line)
-    oled.setCursor(0, 56);
-    if (nav.directions != "")
-    {
-      String dirText = nav.directions;
-      if (dirText.length() > 21)
-      {
-        oled.print(dirText.substring(0, 18));
-        oled.print("...");
-      }
-      else
-      {
-        oled.print(dirText);
-      }
-    }
-  }
-  // Show connection status when no navigation
-  else if (Chronos.isConnected())
+  if (nav.connected)
   {
     // Normal display with larger time
     oled.setTextSize(2);
     oled.setCursor(0, 0);
-    String timeStr = Chronos.getHourZ() + ":" + (Chronos.getHourC() < 10 ? "0" : "") + String(Chronos.getHourC());
-    oled.print(timeStr);
+    oled.print(nav.clock);
 
     // WiFi icon - DISABLED (not needed for Chronos BLE)
     // if (WiFi.status() == WL_CONNECTED)
@@ -337,13 +321,13 @@ void updateDisplayOLED()
     //   oled.drawBitmap(80, 0, wifi_off_icon, 16, 16, SSD1306_WHITE);
     // }
 
-    if (Chronos.isConnected())
+    if (nav.connected)
     {
-      oled.drawBitmap(104, 0, bt_icon, 16, 16, SSD1306_WHITE);
+      blitBitmap(oled, 104, 0, bt_icon, 16, 16, SSD1306_WHITE);
     }
     else
     {
-      oled.drawBitmap(104, 0, bt_off_icon, 16, 16, SSD1306_WHITE);
+      blitBitmap(oled, 104, 0, bt_off_icon, 16, 16, SSD1306_WHITE);
     }
 
     oled.setTextSize(1);
@@ -351,15 +335,9 @@ void updateDisplayOLED()
     oled.println("Chronos Connected!");
     oled.setCursor(0, 40);
     oled.print("App: v");
-    oled.println(Chronos.getAppVersion());
+    oled.println(nav.appVersion);
     oled.setCursor(0, 52);
     oled.println("Start navigation...");
-
-    // Reset navigation state when on idle screen for more than 10 seconds
-    if (millis() - lastValidNavTime > 10000)
-    {
-      wasNavigating = false;
-    }
   }
   else
   {
@@ -371,44 +349,211 @@ void updateDisplayOLED()
     oled.println("Pair ESP32-Nav");
   }
 
-  oled.display();
+  oledFlush.commit();
 }
 
-void updateDisplay()
+//////////////////////
+// Redraw triggers
+//////////////////////
+void onChronosConfiguration(Config config, uint32_t, uint32_t)
 {
-  if (displayType == DISPLAY_LCD)
+  if (config == CF_NAV_DATA || config == CF_NAV_ICON)
   {
-    updateDisplayLCD();
+    redrawTrigger.notifyEvent();
+    powerWake();
   }
-  else if (displayType == DISPLAY_OLED)
+}
+
+void onChronosConnection(bool connected)
+{
+  TEL_INFO(TEL_CONNECTION, connected, 0, 0);
+  redrawTrigger.notifyEvent();
+  powerWake();
+}
+
+// Whether the panels show the navigation screen. Decided once per model so
+// every panel agrees: with data, or within NAV_HOLD_TIME of the last data,
+// which keeps "Start navigation" from flickering up during reroutes and
+// road closure alerts.
+bool navigationVisible(const NavSnapshot &nav)
+{
+  bool hasNavData = (nav.active || nav.distance[0] != '\0' || nav.directions[0] != '\0' || nav.title[0] != '\0');
+  navDataShown = hasNavData;
+  if (hasNavData)
   {
-    updateDisplayOLED();
+    lastValidNavTime = millis();
+    wasNavigating = true;
+  }
+  else if (millis() - lastValidNavTime > NAV_HOLD_TIME)
+  {
+    wasNavigating = false;
+  }
+  return nav.connected && (hasNavData || wasNavigating);
+}
+
+// Everything besides the navigation data that changes what is on screen
+uint32_t screenState()
+{
+  bool holdExpired = wasNavigating && !navDataShown && (millis() - lastValidNavTime > NAV_HOLD_TIME);
+  uint32_t minute = (uint32_t)(time(nullptr) / 60);
+  return (minute << 6) | (brightness << 4) | (displayPage << 2) | (holdExpired ? 2 : 0) |
+         (Chronos.isConnected() ? 1 : 0);
+}
+
+// Brightness goes out with the frame so only the renderer touches the bus
+void applyBrightness(uint8_t level)
+{
+  static uint8_t applied = BRIGHTNESS_LEVELS - 1;
+  if (level == applied || level >= BRIGHTNESS_LEVELS)
+  {
+    return;
+  }
+  applied = level;
+  if (displays.has(DISPLAY_LCD))
+  {
+    lcdFlush.setBacklight(level > 0);
+  }
+  if (displays.has(DISPLAY_OLED))
+  {
+    const uint8_t contrast[] = {SSD1306_SETCONTRAST, oledContrast[level]};
+    i2cBus.write(OLED_ADDRESS, 0x00, contrast, sizeof(contrast));
+  }
+}
+
+// Runs on the render task (or inline from loop() without one)
+void renderFrame(const NavSnapshot &nav)
+{
+  // Navigation data as telemetry; the text fields only at debug level
+  if (nav.connected)
+  {
+    uint8_t flags = (nav.active ? 1 : 0) | (nav.isNavigation ? 2 : 0) | (nav.hasIcon ? 4 : 0);
+    TEL_INFO(TEL_NAV, flags, navSnapshotFingerprint(nav), 0);
+    TEL_DEBUG_TEXT(TEL_TEXT_TITLE, nav.title);
+    TEL_DEBUG_TEXT(TEL_TEXT_ETA, nav.eta);
+    TEL_DEBUG_TEXT(TEL_TEXT_DURATION, nav.duration);
+    TEL_DEBUG_TEXT(TEL_TEXT_DISTANCE, nav.distance);
+    TEL_DEBUG_TEXT(TEL_TEXT_DIRECTIONS, nav.directions);
+    TEL_DEBUG_TEXT(TEL_TEXT_SPEED, nav.speed);
   }
+
+  // Numbers out of the phone's text, counted down from here on
+  memcpy(&renderModel, &nav, sizeof(renderModel));
+  navCountdown.pace(nav.refreshMs);
+  navCountdown.observe(renderModel, millis());
+  navCountdown.apply(renderModel, millis());
+
+  displayFrameCount++;
+  applyBrightness(nav.brightness);
+  displays.submit(renderModel);
+
+  // Persist newly seen icons now and then (renderer owns the cache)
+  iconCache.save(false);
 }
 
+// Sends the next slice of every panel's frame; true once all are idle
+bool displayService()
+{
+  PROF_SCOPE(PROF_DISPLAY_SEND);
+  return displays.service();
+}
+
+// The redraw trigger paces itself on the primary (first found) panel; the
+// others only report their latency
+void displayFrameDone(DisplayType type, bool primary, const RedrawRequest &request)
+{
+  if (!primary)
+  {
+    TEL_INFO(TEL_PANEL_FRAME, type, request.fromEvent ? displays.stats(type)->lastLatencyUs : 0,
+              displays.stats(type)->framesDone);
+    return;
+  }
+
+  redrawTrigger.frameDone(request);
+  if (bootFirstFrameUs == 0)
+  {
+    bootFirstFrameUs = micros();
+    TEL_INFO(TEL_BOOT_FRAME, fastBoot, bootFirstFrameUs, 0);
+  }
+
+  const RedrawStats &redraw = redrawTrigger.stats();
+  TEL_INFO(TEL_FRAME, request.fromEvent, request.fromEvent ? redraw.lastLatencyUs : 0, redraw.framesDone);
+}
+
+// After every slice: the distance countdown, held-back LCD models and the
+// directions marquee (DisplayRegistry::animate() skips a busy panel)
+uint32_t displayAnimate()
+{
+  if (navCountdown.step(renderModel, millis()))
+  {
+    renderModel.request = {}; // not event-driven: no latency sample
+    displayFrameCount++;
+    displays.submit(renderModel);
+    return 0;
+  }
+  // DISPLAY_IDLE == NAV_COUNTDOWN_IDLE == RENDER_NOTHING_DUE
+  return min(displays.animate(), navCountdown.msUntilStep(millis()));
+}
+
+// OLED marquee, one page per step
+uint32_t animateOLED()
+{
+  if (oledLayout.animate(oled))
+  {
+    oledFlush.commit();
+    return 0;
+  }
+  return oledLayout.msUntilAnimate(); // MARQUEE_IDLE == DISPLAY_IDLE
+}
+
+bool serviceOLED()
+{
+  return oledFlush.step();
+}
+
+bool serviceLCD()
+{
+  return lcdFlush.step();
+}
+
+static const DisplayOps oledOps = {updateDisplayOLED, serviceOLED, animateOLED};
+static const DisplayOps lcdOps = {updateDisplayLCD, serviceLCD, nullptr};
+
 //////////////////////
 // Power Management Functions
 //////////////////////
+// Clock a panel was attached at, 0 when it is not on the bus
+uint32_t busClock(uint8_t address)
+{
+  const I2cDeviceStats *device = i2cBus.device(address);
+  return device != nullptr ? device->clock : 0;
+}
+
 void enterDeepSleep()
 {
   Serial.println("\n=== Entering Deep Sleep ===");
   Serial.println("Press BOOT button to wake up");
 
-  // Save current time before sleep
-  saveCurrentTime();
+  // Keep the clock in RTC memory; NVS only if its copy is old
+  timeKeeperBeforeSleep();
+  bootCache.magic = !displays.empty() ? BOOT_CACHE_MAGIC : 0;
+  bootCache.panels = displays.mask();
+  bootCache.oledClock = busClock(OLED_ADDRESS);
+  bootCache.lcdClock = busClock(LCD_ADDRESS);
 
-  // Show sleep message on display
-  if (displayType == DISPLAY_LCD)
+  // Wait for any frame in flight; the renderer must not touch the panel now
+  renderLock();
+  while (!displayService())
   {
-    lcd.clear();
-    lcd.setCursor(0, 0);
-    lcd.print("Sleeping...");
-    lcd.setCursor(0, 1);
-    lcd.print("Press BOOT wake");
-    delay(1000);
-    lcd.noBacklight();
   }
-  else if (displayType == DISPLAY_OLED)
+  iconCache.save(true);
+  routeLogFlush();
+
+  // Show sleep message on the displays
+  if (displays.has(DISPLAY_LCD))
+  {
+    lcdFlush.flush("Sleeping...", "Press BOOT wake");
+  }
+  if (displays.has(DISPLAY_OLED))
   {
     oled.clearDisplay();
     oled.setCursor(0, 20);
@@ -416,10 +561,19 @@ void enterDeepSleep()
     oled.println("  Going to sleep");
     oled.setCursor(0, 35);
     oled.println("Press BOOT to wake");
-    oled.display();
-    delay(1000);
+    oledFlush.flush();
+  }
+  delay(1000);
+  if (displays.has(DISPLAY_LCD))
+  {
+    lcdFlush.setBacklight(false);
+    I2cLock bus(i2cBus);
+    lcd.noBacklight();
+  }
+  if (displays.has(DISPLAY_OLED))
+  {
     oled.clearDisplay();
-    oled.display();
+    oledFlush.flush();
   }
 
   delay(500);
@@ -428,61 +582,287 @@ void enterDeepSleep()
   // LOW level will wake up the ESP32
   esp_sleep_enable_ext0_wakeup(GPIO_NUM_0, 0);
 
+  // Whatever telemetry is still queued goes out before power down
+  TEL_INFO(TEL_SLEEP, 0, 0, 0);
+  telemetryFlush(Serial);
+  Serial.flush();
+
   // Enter deep sleep
   esp_deep_sleep_start();
 }
 
-bool checkForPowerOff()
+// Act on BOOT button gestures; true when the device should sleep
+bool handleButton()
 {
-  static unsigned long buttonPressStart = 0;
-  static bool buttonWasPressed = false;
-
-  bool buttonPressed = (digitalRead(BOOT_BUTTON_PIN) == LOW);
+  PROF_SCOPE(PROF_BUTTON);
+  bool sleep = false;
+  ButtonGesture gesture;
+  while ((gesture = buttonPoll()) != GESTURE_NONE)
+  {
+    switch (gesture)
+    {
+    case GESTURE_SHORT:
+      Serial.println("Short press detected - entering sleep mode");
+      sleep = true;
+      break;
+    case GESTURE_LONG:
+      Serial.println("Long press detected - entering sleep mode");
+      sleep = true;
+      break;
+    case GESTURE_DOUBLE:
+      displayPage = (displayPage + 1) % PAGE_COUNT;
+      break;
+    case GESTURE_REPEAT:
+      // Dimmer each step, wrapping round to full brightness
+      brightness = brightness == 0 ? BRIGHTNESS_LEVELS - 1 : brightness - 1;
+      break;
+    default:
+      break;
+    }
+  }
+  powerRunWithin(buttonMsUntilDue());
+  return sleep;
+}
 
-  if (buttonPressed && !buttonWasPressed)
+//////////////////////
+// Serial console
+//////////////////////
+// One command per line:
+//   prof        latency histograms of the profiled hot paths
+//   prof reset  clear them
+//   heap        heap and icon cache health
+//   i2c         bus clocks, error counters and recoveries
+//   route       the route log on flash, oldest change first
+//   trace on    write every navigation change as a trace line (nav_trace.h)
+//   trace off   stop
+//   refresh     the refresh rate now, and how often it changed
+//   refresh fixed / refresh adaptive   swap the refresh policy
+void runSerialCommand(const char *command)
+{
+  if (strcmp(command, "prof") == 0)
+  {
+    profilerDump(Serial);
+  }
+  else if (strcmp(command, "prof reset") == 0)
+  {
+    profilerReset();
+    Serial.println("Profile cleared");
+  }
+  else if (strcmp(command, "heap") == 0)
+  {
+    heapMonitor.sample();
+    heapMonitor.print(Serial);
+    iconCache.printStats(Serial);
+  }
+  else if (strcmp(command, "i2c") == 0)
   {
-    // Button just pressed
-    buttonPressStart = millis();
-    buttonWasPressed = true;
+    i2cBus.print(Serial);
   }
-  else if (!buttonPressed && buttonWasPressed)
+  else if (strcmp(command, "route") == 0)
   {
-    // Button just released - check if it was a short press
-    unsigned long pressDuration = millis() - buttonPressStart;
-    buttonWasPressed = false;
+    routeLogDump(Serial);
+  }
+  else if (strcmp(command, "trace on") == 0)
+  {
+    navTrace.start(&Serial);
+  }
+  else if (strcmp(command, "trace off") == 0)
+  {
+    navTrace.start(nullptr);
+    Serial.printf("Trace: %lu lines, %lu bytes\n", (unsigned long)navTrace.stats().lines,
+                  (unsigned long)navTrace.stats().bytes);
+  }
+  else if (strcmp(command, "refresh fixed") == 0 || strcmp(command, "refresh adaptive") == 0)
+  {
+    redrawTrigger.setPolicy(command[8] == 'f' ? refreshFixed : refreshAdaptive);
+  }
+  else if (strcmp(command, "refresh") == 0)
+  {
+    const RefreshRate &rate = redrawTrigger.rate();
+    Serial.printf("Refresh: %s, frame every %lu ms, heartbeat %lu ms, %lu changes\n", refreshModeName(rate.mode),
+                  (unsigned long)rate.frameMs, (unsigned long)rate.heartbeatMs,
+                  (unsigned long)redrawTrigger.stats().rateChanges);
+  }
+  else
+  {
+    Serial.println("Commands: prof, prof reset, heap, i2c, route, trace on, trace off, refresh, refresh fixed, "
+                   "refresh adaptive");
+  }
+}
 
-    // Short press (less than 1 second) - go to sleep
-    if (pressDuration < 1000)
+void handleSerialCommands()
+{
+  static char line[32];
+  static uint8_t length = 0;
+  while (Serial.available() > 0)
+  {
+    char c = Serial.read();
+    if (c == '\r' || c == '\n')
     {
-      Serial.println("Short press detected - entering sleep mode");
-      return true;
+      line[length] = '\0';
+      if (length > 0)
+      {
+        runSerialCommand(line);
+      }
+      length = 0;
+    }
+    else if (length < sizeof(line) - 1)
+    {
+      line[length++] = c;
     }
   }
-  else if (buttonPressed && buttonWasPressed)
+}
+
+//////////////////////
+// Display Discovery
+//////////////////////
+// Bus self-tests: SSD1306 no-op commands must be ACKed; the LCD backpack's
+// port must read back what was written (EN stays low, so the HD44780
+// ignores the patterns)
+static const uint8_t oledProbeBytes[] = {0x00, 0xE3, 0xE3}; // command stream, NOP, NOP
+static const uint8_t lcdProbeBytes[] = {0x59, 0xA9};
+static const I2cProbe oledProbe = {oledProbeBytes, sizeof(oledProbeBytes), false};
+static const I2cProbe lcdProbe = {lcdProbeBytes, sizeof(lcdProbeBytes), true};
+
+// Settle the panel's clock; false when it does not answer
+bool attachPanel(uint8_t address, uint32_t maxClock, const I2cProbe &probe)
+{
+  uint32_t clock = i2cBus.attach(address, maxClock, probe);
+  TEL_INFO(TEL_I2C_CLOCK, address, clock, 0);
+  return clock != 0;
+}
+
+// Put a panel back on the bus at the clock it had before deep sleep, and
+// check it with a probe (retried, for a panel slow to come up) and one
+// real write (wake is a command it takes at any time)
+bool resumePanel(uint8_t address, uint32_t clock, bool hasControl, uint8_t wake)
+{
+  bool answered = i2cBus.attachAt(address, clock) && i2cBus.probe(address) &&
+                  (hasControl ? i2cBus.write(address, 0x00, &wake, 1) : i2cBus.write(address, &wake, 1));
+  TEL_INFO(TEL_I2C_CLOCK, address, answered ? clock : 0, 0);
+  return answered;
+}
+
+// Set up the OLED and register it; false when its init fails
+bool beginOLED(bool resume)
+{
+  bool ready;
+  {
+    I2cLock bus(i2cBus);
+    ready = oled.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS);
+  }
+  if (!ready)
   {
-    // Button is being held
-    unsigned long pressDuration = millis() - buttonPressStart;
+    return false;
+  }
+  oledFlush.begin(&oled, &i2cBus, OLED_ADDRESS);
+  oledLayout.invalidate();
+  displays.add(DISPLAY_OLED, 0, oledOps);
+  if (resume)
+  {
+    return true;
+  }
+#ifdef BLIT_BENCH
+  blitBenchmark(oled, Serial);
+#endif
+  oled.clearDisplay();
+  oled.setTextSize(1);
+  oled.setTextColor(SSD1306_WHITE);
+  oled.setCursor(0, 0);
+  oled.println("Chronos Starting...");
+  oledFlush.flush();
+  return true;
+}
 
-    if (pressDuration >= LONG_PRESS_TIME)
+// Set up the LCD and register it. After deep sleep there is no lcd.init():
+// the HD44780 is still in 4-bit mode, which saves its ~60 ms power-on
+// sequence, and the first write turns the backlight back on.
+void beginLCD(bool resume)
+{
+  if (resume)
+  {
+    lcdFlush.begin(&i2cBus, LCD_ADDRESS);
+    lcdFlush.setBacklight(true);
+  }
+  else
+  {
     {
-      // Long press detected - power off
-      Serial.println("Long press detected - entering sleep mode");
-      return true;
+      I2cLock bus(i2cBus);
+      lcd.init();
+      lcd.backlight();
     }
+    lcdFlush.begin(&i2cBus, LCD_ADDRESS);
+    lcdFlush.flush("Chronos Start..", "");
+  }
+  displays.add(DISPLAY_LCD, LCD_MIN_FRAME_MS, lcdOps);
+}
+
+// Probe the bus and initialise every panel that answers. The OLED is
+// registered first, so when both are fitted it paces the redraw trigger.
+void detectDisplay()
+{
+  Serial.println("\n=== Detecting Displays ===");
+  displays.clear();
+
+  // Check for OLED at 0x3C
+  if (attachPanel(OLED_ADDRESS, OLED_I2C_MAX_CLOCK, oledProbe))
+  {
+    Serial.printf("OLED detected at 0x3C (%lu kHz)!\n", (unsigned long)(i2cBus.device(OLED_ADDRESS)->clock / 1000));
+    Serial.println(beginOLED(false) ? "OLED initialized!" : "OLED init failed!");
+  }
+  // Check for LCD at 0x27
+  if (attachPanel(LCD_ADDRESS, LCD_I2C_MAX_CLOCK, lcdProbe))
+  {
+    Serial.printf("LCD detected at 0x27 (%lu kHz)!\n", (unsigned long)(i2cBus.device(LCD_ADDRESS)->clock / 1000));
+    beginLCD(false);
+    Serial.println("LCD initialized!");
+  }
+  if (displays.empty())
+  {
+    Serial.println("No display found on I2C bus!");
   }
+}
 
-  return false;
+// Wake from deep sleep: the panels kept power and their controller state,
+// so only the host side is set up again, at the cached bus clocks. The
+// first frame redraws everything.
+void resumeDisplay(const BootCache &cache)
+{
+  displays.clear();
+  bool found = true;
+  if (cache.panels & (1 << DISPLAY_OLED))
+  {
+    found = resumePanel(OLED_ADDRESS, cache.oledClock, true, SSD1306_DISPLAYON) && beginOLED(true);
+  }
+  if (found && (cache.panels & (1 << DISPLAY_LCD)))
+  {
+    // EN low: the HD44780 ignores it, the backlight comes on
+    found = resumePanel(LCD_ADDRESS, cache.lcdClock, false, LCD_PCF_BACKLIGHT);
+    if (found)
+    {
+      beginLCD(true);
+    }
+  }
+  if (!found || displays.empty())
+  {
+    detectDisplay(); // A cached panel is gone
+    return;
+  }
+  Serial.printf("Fast boot: %s%s%s display reused\n", displays.has(DISPLAY_OLED) ? "OLED" : "",
+                displays.mask() == ((1 << DISPLAY_OLED) | (1 << DISPLAY_LCD)) ? " + " : "",
+                displays.has(DISPLAY_LCD) ? "LCD" : "");
 }
 
 void setup()
 {
   Serial.begin(115200);
-  delay(1000);
+  telemetryBegin();
 
   Serial.println("\n=== ESP32 Chronos Navigation ===");
 
   // Check wake up reason
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  TEL_INFO(TEL_BOOT, wakeup_reason, 0, 0);
 
   if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT0)
   {
@@ -513,61 +893,34 @@ void setup()
     }
   }
 
-  // Configure boot button for long-press shutdown detection
-  pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP);
+  // BOOT button gestures (sleep, page, brightness); its edges wake the
+  // idle loop
+  powerBegin(BOOT_BUTTON_PIN);
+  buttonBegin(BOOT_BUTTON_PIN);
 
-  // Restore saved time from NVS
-  restoreSavedTime();
+  // Restore the clock: RTC memory after deep sleep, NVS after power loss
+  timeKeeperBegin(wakeup_reason != ESP_SLEEP_WAKEUP_UNDEFINED);
+  const TimeKeeperStats &clock = timeKeeperStats();
+  TEL_INFO(TEL_TIME, clock.source, clock.sleptMs, 0);
 
-  // Initialize I2C
-  Serial.println("\n=== Detecting Display ===");
-  Wire.begin(21, 22); // SDA=GPIO21, SCL=GPIO22
+  // BLE first: the stack comes up in its own task while the panels are set up
+  Serial.println("\n=== Starting Chronos BLE ===");
+  Chronos.setConfigurationCallback(onChronosConfiguration);
+  Chronos.setConnectionCallback(onChronosConnection);
+  Chronos.begin();
 
-  // Check for OLED at 0x3C
-  Wire.beginTransmission(OLED_ADDRESS);
-  if (Wire.endTransmission() == 0)
+  if (!i2cBus.begin(&Wire, I2C_SDA_PIN, I2C_SCL_PIN))
   {
-    Serial.println("OLED detected at 0x3C!");
-    displayType = DISPLAY_OLED;
-
-    if (oled.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS))
-    {
-      Serial.println("OLED initialized!");
-      oled.clearDisplay();
-      oled.setTextSize(1);
-      oled.setTextColor(SSD1306_WHITE);
-      oled.setCursor(0, 0);
-      oled.println("Chronos Starting...");
-      oled.display();
-    }
-    else
-    {
-      Serial.println("OLED init failed!");
-      displayType = DISPLAY_NONE;
-    }
+    Serial.println("I2C bus stuck low!");
+  }
+  fastBoot = wakeup_reason == ESP_SLEEP_WAKEUP_EXT0 && bootCache.magic == BOOT_CACHE_MAGIC;
+  if (fastBoot)
+  {
+    resumeDisplay(bootCache);
   }
-  // Check for LCD at 0x27
   else
   {
-    Wire.beginTransmission(LCD_ADDRESS);
-    if (Wire.endTransmission() == 0)
-    {
-      Serial.println("LCD detected at 0x27!");
-      displayType = DISPLAY_LCD;
-
-      lcd.init();
-      lcd.backlight();
-      lcd.clear();
-      lcd.setCursor(0, 0);
-      lcd.print("Chronos Start..");
-      Serial.println("LCD initialized!");
-      delay(2000);
-    }
-    else
-    {
-      Serial.println("No display found on I2C bus!");
-      displayType = DISPLAY_NONE;
-    }
+    detectDisplay();
   }
 
   // Wi-Fi (for NTP time sync) - DISABLED (Chronos provides time via BLE)
@@ -612,20 +965,37 @@ void setup()
   //   Serial.println("\nWiFi FAILED (optional - Chronos will sync time)");
   // }
 
-  // Start Chronos BLE
-  Serial.println("\n=== Starting Chronos BLE ===");
-  Chronos.begin();
+  // Icon cache and route log on the spiffs partition (formatted on first boot)
+  if (SPIFFS.begin(true))
+  {
+    iconCache.begin(&SPIFFS);
+    Serial.printf("Icon cache: %lu icons restored\n", (unsigned long)iconCache.stats().restored);
+    routeLogBegin(&SPIFFS);
+    Serial.printf("Route log: %lu pages, %lu damaged\n", (unsigned long)routeLogStats().stored,
+                  (unsigned long)routeLogStats().damaged);
+  }
+  else
+  {
+    Serial.println("SPIFFS unavailable - icon cache RAM only, no route log");
+    iconCache.begin(nullptr);
+    routeLogBegin(nullptr);
+  }
+
+  redrawTrigger.begin(&Chronos);
+  renderTaskBegin();
   Serial.println("Chronos BLE started!");
   Serial.println("Open Chronos app and pair with 'ESP32-Nav'");
 
-  if (displayType == DISPLAY_LCD)
+  // After a wake the first frame comes straight from the render path
+  if (fastBoot)
+  {
+    return;
+  }
+  if (displays.has(DISPLAY_LCD))
   {
-    lcd.clear();
-    lcd.print("Chronos Ready!");
-    lcd.setCursor(0, 1);
-    lcd.print("Pair ESP32-Nav");
+    lcdFlush.flush("Chronos Ready!", "Pair ESP32-Nav");
   }
-  else if (displayType == DISPLAY_OLED)
+  if (displays.has(DISPLAY_OLED))
   {
     oled.clearDisplay();
     oled.setCursor(0, 0);
@@ -636,49 +1006,96 @@ void setup()
     oled.println("Open Chronos app");
     oled.setCursor(0, 44);
     oled.println("and pair device");
-    oled.display();
+    oledFlush.flush();
   }
-  delay(2000);
-
-  updateDisplay();
 }
 
 void loop()
 {
-  // Check for long press on BOOT button to power off
-  if (checkForPowerOff())
+  PROF_SCOPE(PROF_LOOP);
+
+  // BOOT button: short or long press powers off
+  if (handleButton())
   {
     enterDeepSleep();
   }
 
   // Handle Chronos BLE (CRITICAL - must be called frequently)
-  Chronos.loop();
+  unsigned long chronosLoopUs = micros();
+  if (lastChronosLoopUs != 0)
+  {
+    chronosMaxGapUs = max(chronosMaxGapUs, (uint32_t)(chronosLoopUs - lastChronosLoopUs));
+  }
+  lastChronosLoopUs = chronosLoopUs;
+  {
+    PROF_SCOPE(PROF_CHRONOS_LOOP);
+    Chronos.loop();
+  }
 
-  // Update display every second
-  if (millis() - lastDisplayUpdate > 1000)
+  // Redraw right away when navigation, connection or the clock changes.
+  // With the render task this only publishes a snapshot and returns.
+  static NavSnapshot frame;
+  if (redrawTrigger.poll(screenState(), &frame))
   {
-    // Debug: Print raw navigation data
-    Navigation nav = Chronos.getNavigation();
-    if (Chronos.isConnected())
-    {
-      Serial.println("=== Nav Data ===");
-      Serial.printf("Active: %d | IsNav: %d\n", nav.active, nav.isNavigation);
-      Serial.printf("Title: %s\n", nav.title.c_str());
-      Serial.printf("ETA: %s\n", nav.eta.c_str());
-      Serial.printf("Duration: %s\n", nav.duration.c_str());
-      Serial.printf("Distance: %s\n", nav.distance.c_str());
-      Serial.printf("Directions: %s\n", nav.directions.c_str());
-      Serial.printf("Speed: %s\n", nav.speed.c_str());
-    }
+    frame.connected = Chronos.isConnected();
+    snprintf(frame.clock, sizeof(frame.clock), "%02d:%02d", Chronos.getHourC(), Chronos.getMinute());
+    frame.page = displayPage;
+    frame.brightness = brightness;
+    frame.refreshMs = redrawTrigger.rate().frameMs;
+    frame.showNavigation = navigationVisible(frame);
+    renderSubmit(frame);
+    routeLogRecord(frame, millis());
+    navTrace.capture(frame, millis());
+  }
 
-    updateDisplay();
-    lastDisplayUpdate = millis();
+  // The rate follows the screen: log each change of mode
+  static RefreshMode refreshMode = REFRESH_MODES;
+  if (redrawTrigger.rate().mode != refreshMode)
+  {
+    const RefreshRate &rate = redrawTrigger.rate();
+    refreshMode = rate.mode;
+    TEL_INFO(TEL_REFRESH, rate.mode, rate.frameMs, rate.heartbeatMs);
+  }
+
+  // Push the next slice of the frame being sent (no-op with the render task)
+  if (!renderService())
+  {
+    powerRunWithin(0);
   }
+  powerRunWithin(redrawTrigger.msUntilDue());
+  powerRunWithin(renderMsUntilDue());
+  telemetryService();
+  routeLogService();
+  handleSerialCommands();
 
-  // Save time to NVS every 60 seconds
-  if (millis() - lastTimeSave > 60000)
+  // Hourly NVS copy of the time (flash wear: not every minute)
+  timeKeeperService();
+
+  // Heap health every minute, to catch leaks and fragmentation on long drives
+  if (millis() - lastHeapReport >= HEAP_REPORT_INTERVAL)
   {
-    saveCurrentTime();
-    lastTimeSave = millis();
+    lastHeapReport = millis();
+    heapMonitor.sample();
+    const HeapHealth &heap = heapMonitor.health();
+    const IconCacheStats &icons = iconCache.stats();
+    TEL_INFO(TEL_HEAP, heap.fragmentation, heap.freeBytes, heap.largestBlock);
+    TEL_INFO(TEL_ICONS, icons.restored, icons.hits, icons.misses);
+    TEL_INFO(TEL_LOOP_GAP, 0, chronosMaxGapUs, 0);
+    const PowerStats &power = powerStats();
+    TEL_INFO(TEL_POWER, powerDutyCycle(), (uint32_t)(power.idleUs / 1000), power.sleeps);
+    for (uint8_t i = 0; i < i2cBus.deviceCount(); i++)
+    {
+      const I2cDeviceStats &device = i2cBus.deviceAt(i);
+      TEL_INFO(TEL_I2C, device.address, device.errors, device.retries);
+    }
+    TEL_INFO(TEL_I2C_BUS, 0, i2cBus.stats().recoveries, i2cBus.stats().failedRecoveries);
+    const NavCountdownStats &countdown = navCountdown.stats();
+    TEL_INFO(TEL_COUNTDOWN, countdown.unparsed, countdown.packets, countdown.steps);
+    const RouteLogStats &route = routeLogStats();
+    TEL_INFO(TEL_ROUTE_LOG, route.dropped, route.written, route.records);
+    TEL_INFO(TEL_ROUTE_LOG_WRITE, 0, route.maxWriteUs, route.errors);
   }
+
+  // Nothing due: let the idle task (and light sleep) have the core
+  powerIdle();
 }
@@ -0,0 +1,167 @@
+#include "nav_countdown.h"
+
+static uint32_t hashText(uint32_t hash, const char *text, size_t size)
+{
+  return fnv1a(hash, text, strnlen(text, size - 1) + 1);
+}
+
+// A distance field of the new packet; the anchor time moves only when the
+// value did, so a field the phone left as it was keeps counting
+static void updateDistance(bool &has, NavDistance &distance, unsigned long &at, const char *text,
+                           bool active, unsigned long now, uint32_t &unparsed)
+{
+  NavDistance parsed;
+  if (!active || !navParseDistance(text, parsed))
+  {
+    unparsed += active && text[0] != '\0' ? 1 : 0;
+    has = false;
+    return;
+  }
+  if (!has || parsed.mm != distance.mm || parsed.unitUm != distance.unitUm)
+  {
+    at = now;
+  }
+  distance = parsed;
+  has = true;
+}
+
+bool NavCountdown::observe(const NavSnapshot &nav, unsigned long now)
+{
+  uint32_t hash = fnv1a(FNV1A_SEED, &nav.active, sizeof(nav.active));
+  hash = hashText(hash, nav.title, sizeof(nav.title));
+  hash = hashText(hash, nav.distance, sizeof(nav.distance));
+  hash = hashText(hash, nav.speed, sizeof(nav.speed));
+  hash = hashText(hash, nav.eta, sizeof(nav.eta));
+  hash = hashText(hash, nav.duration, sizeof(nav.duration));
+  if (hash == print)
+  {
+    return false;
+  }
+  print = hash;
+  counters.packets++;
+
+  // The turn distance's fall since the last packet is the fallback speed.
+  // Only the title counts: it changes in steps of metres where the
+  // remaining distance moves in tenths of a kilometre.
+  NavDistance lastTurn = state.turn;
+  unsigned long lastTurnAt = state.turnAt;
+  bool hadTurn = state.hasTurn;
+  // Street names in the title are not an error
+  uint32_t ignored = 0;
+  updateDistance(state.hasTurn, state.turn, state.turnAt, nav.title, nav.active, now, ignored);
+  updateDistance(state.hasRemaining, state.remaining, state.remainingAt, nav.distance, nav.active, now,
+                 counters.unparsed);
+  if (!state.hasTurn || now - lastTurnAt >= NAV_SPEED_STALE_MS)
+  {
+    speedEstimate = 0; // a new route, or too long since the last step to tell
+  }
+  else if (hadTurn && state.turn.mm < lastTurn.mm && now != lastTurnAt)
+  {
+    uint32_t measured = (uint32_t)((uint64_t)(lastTurn.mm - state.turn.mm) * 1000 / (now - lastTurnAt));
+    if (measured <= NAV_SPEED_MAX_MM_S)
+    {
+      speedEstimate = speedEstimate == 0 ? measured : (3 * speedEstimate + measured) / 4;
+    }
+  }
+
+  state.speedEstimated = !(nav.active && navParseSpeed(nav.speed, state.speedMmS));
+  if (state.speedEstimated)
+  {
+    counters.unparsed += nav.active && nav.speed[0] != '\0' ? 1 : 0;
+    state.speedMmS = speedEstimate;
+  }
+  state.hasSpeed = state.speedMmS > 0;
+
+  state.hasEta = nav.active && navParseClock(nav.eta, state.etaMinute);
+  counters.unparsed += nav.active && !state.hasEta && nav.eta[0] != '\0' ? 1 : 0;
+  state.hasDuration = nav.active && navParseDuration(nav.duration, state.durationS);
+  counters.unparsed += nav.active && !state.hasDuration && nav.duration[0] != '\0' ? 1 : 0;
+  return true;
+}
+
+uint32_t NavCountdown::liveMm(const NavDistance &distance, unsigned long at, unsigned long now) const
+{
+  uint32_t elapsed = min((uint32_t)(now - at), (uint32_t)NAV_COUNTDOWN_MAX_MS);
+  uint64_t travelled = (uint64_t)state.speedMmS * elapsed / 1000;
+  return travelled < distance.mm ? distance.mm - (uint32_t)travelled : 0;
+}
+
+// Time until the printed value drops to its next step
+uint32_t NavCountdown::msUntilChange(const NavDistance &distance, unsigned long at, unsigned long now) const
+{
+  uint32_t elapsed = now - at;
+  if (state.speedMmS == 0 || elapsed >= NAV_COUNTDOWN_MAX_MS)
+  {
+    return NAV_COUNTDOWN_IDLE;
+  }
+
+  // Printed values are rounded to the nearest step, so the next one shows
+  // once the distance falls below the midpoint
+  uint32_t live = liveMm(distance, at, now);
+  uint32_t step = navDistanceStep(distance, live);
+  uint64_t index = ((uint64_t)live + step / 2) / step;
+  if (index == 0)
+  {
+    return NAV_COUNTDOWN_IDLE;
+  }
+  uint64_t travel = live - (index * step - step / 2) + 1;
+  if (distance.unitUm == 1000000000u && live >= 1000000)
+  {
+    travel = min(travel, (uint64_t)(live - 999999)); // kilometres turn into metres
+  }
+
+  uint64_t ms = (travel * 1000 + state.speedMmS - 1) / state.speedMmS;
+  return elapsed + ms > NAV_COUNTDOWN_MAX_MS ? NAV_COUNTDOWN_IDLE : (uint32_t)ms;
+}
+
+bool NavCountdown::show(char *field, char *shown, const NavDistance &distance, unsigned long at,
+                        unsigned long now)
+{
+  navFormatDistance(field, NAV_TEXT_SHORT, distance, liveMm(distance, at, now));
+  if (strcmp(field, shown) == 0)
+  {
+    return false;
+  }
+  memcpy(shown, field, NAV_TEXT_SHORT);
+  return true;
+}
+
+bool NavCountdown::apply(NavSnapshot &nav, unsigned long now)
+{
+  bool changed = false;
+  uint32_t next = NAV_COUNTDOWN_IDLE;
+  if (state.hasTurn)
+  {
+    changed |= show(nav.title, shownTurn, state.turn, state.turnAt, now);
+    next = min(next, msUntilChange(state.turn, state.turnAt, now));
+  }
+  if (state.hasRemaining)
+  {
+    changed |= show(nav.distance, shownRemaining, state.remaining, state.remainingAt, now);
+    next = min(next, msUntilChange(state.remaining, state.remainingAt, now));
+  }
+
+  counting = next != NAV_COUNTDOWN_IDLE;
+  stepAt = now + max(next, minStepMs);
+  return changed;
+}
+
+bool NavCountdown::step(NavSnapshot &nav, unsigned long now)
+{
+  if (msUntilStep(now) != 0 || !apply(nav, now))
+  {
+    return false;
+  }
+  counters.steps++;
+  return true;
+}
+
+uint32_t NavCountdown::msUntilStep(unsigned long now) const
+{
+  if (!counting)
+  {
+    return NAV_COUNTDOWN_IDLE;
+  }
+  long wait = (long)(stepAt - now);
+  return wait > 0 ? (uint32_t)wait : 0;
+}
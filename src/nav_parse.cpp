@@ -0,0 +1,316 @@
+#include "nav_parse.h"
+
+#define UM_PER_M 1000000u
+#define UM_PER_KM 1000000000u
+
+struct UnitName
+{
+  const char *name;
+  uint32_t um; // micrometres (per second for speeds, seconds for durations)
+};
+
+static const UnitName distanceUnits[] = {
+    {"m", UM_PER_M}, {"km", UM_PER_KM}, {"mi", 1609344000u}, {"ft", 304800u}, {"yd", 914400u},
+};
+
+static const UnitName speedUnits[] = {
+    {"km/h", 277778u}, {"kmh", 277778u}, {"kph", 277778u}, {"mph", 447040u}, {"m/s", UM_PER_M},
+};
+
+static const UnitName durationUnits[] = {
+    {"d", 86400}, {"day", 86400}, {"days", 86400},
+    {"h", 3600},  {"hr", 3600},   {"hrs", 3600},     {"hour", 3600},    {"hours", 3600},
+    {"m", 60},    {"min", 60},    {"mins", 60},      {"minute", 60},    {"minutes", 60},
+    {"s", 1},     {"sec", 1},     {"secs", 1},       {"second", 1},     {"seconds", 1},
+};
+
+static const uint32_t powersOf10[] = {1, 10, 100, 1000};
+
+static bool digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static bool letter(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Length of the blank at p: space, tab or a UTF-8 no-break space
+static size_t blank(const char *p)
+{
+  if (*p == ' ' || *p == '\t')
+  {
+    return 1;
+  }
+  return (uint8_t)p[0] == 0xC2 && (uint8_t)p[1] == 0xA0 ? 2 : 0;
+}
+
+static const char *skipBlanks(const char *p)
+{
+  for (size_t n; (n = blank(p)) != 0;)
+  {
+    p += n;
+  }
+  return p;
+}
+
+// Up to six digits with an optional '.' or ',' and up to three decimals
+// (more are dropped); the value in thousandths, which then stays clear of
+// uint64_t overflow in every unit conversion. nullptr when there is no
+// number.
+static const char *parseNumber(const char *p, uint64_t &thousandths, uint8_t &decimals, char &separator)
+{
+  uint64_t whole = 0;
+  uint8_t digits = 0;
+  while (digit(*p))
+  {
+    if (++digits > 6)
+    {
+      return nullptr;
+    }
+    whole = whole * 10 + (*p++ - '0');
+  }
+  if (digits == 0)
+  {
+    return nullptr;
+  }
+
+  uint32_t fraction = 0;
+  decimals = 0;
+  separator = '.';
+  if ((*p == '.' || *p == ',') && digit(p[1]))
+  {
+    separator = *p++;
+    for (; digit(*p); p++)
+    {
+      if (decimals < 3)
+      {
+        fraction = fraction * 10 + (*p - '0');
+        decimals++;
+      }
+    }
+  }
+  thousandths = whole * 1000 + fraction * powersOf10[3 - decimals];
+  return p;
+}
+
+// Case-insensitive match of the len characters at p against name
+static bool sameWord(const char *p, size_t len, const char *name)
+{
+  size_t i = 0;
+  for (; i < len && name[i] != '\0'; i++)
+  {
+    char c = p[i] >= 'A' && p[i] <= 'Z' ? p[i] + ('a' - 'A') : p[i];
+    if (c != name[i])
+    {
+      return false;
+    }
+  }
+  return i == len && name[i] == '\0';
+}
+
+static const UnitName *findUnit(const UnitName *units, size_t count, const char *p, size_t len)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (sameWord(p, len, units[i].name))
+    {
+      return &units[i];
+    }
+  }
+  return nullptr;
+}
+
+// Length of the word at p: everything up to a blank or the end
+static size_t wordLength(const char *p)
+{
+  size_t len = 0;
+  while (p[len] != '\0' && blank(p + len) == 0)
+  {
+    len++;
+  }
+  return len;
+}
+
+bool navParseDistance(const char *text, NavDistance &out)
+{
+  NavDistance parsed = {};
+  uint64_t thousandths;
+  const char *p = parseNumber(skipBlanks(text), thousandths, parsed.decimals, parsed.separator);
+  if (p == nullptr)
+  {
+    return false;
+  }
+
+  const char *unit = skipBlanks(p);
+  size_t gap = unit - p;
+  size_t len = wordLength(unit);
+  const UnitName *found = findUnit(distanceUnits, sizeof(distanceUnits) / sizeof(distanceUnits[0]), unit, len);
+  if (found == nullptr || gap >= sizeof(parsed.gap) || *skipBlanks(unit + len) != '\0')
+  {
+    return false;
+  }
+
+  uint64_t mm = thousandths * found->um / UM_PER_M;
+  if (mm > NAV_DISTANCE_MAX_MM)
+  {
+    return false;
+  }
+  parsed.mm = (uint32_t)mm;
+  parsed.unitUm = found->um;
+  memcpy(parsed.gap, p, gap);
+  memcpy(parsed.unit, unit, len); // units are at most 2 characters
+  out = parsed;
+  return true;
+}
+
+bool navParseSpeed(const char *text, uint32_t &mmPerS)
+{
+  uint64_t thousandths;
+  uint8_t decimals;
+  char separator;
+  const char *p = parseNumber(skipBlanks(text), thousandths, decimals, separator);
+  if (p == nullptr)
+  {
+    return false;
+  }
+
+  p = skipBlanks(p);
+  size_t len = wordLength(p);
+  const UnitName *found = findUnit(speedUnits, sizeof(speedUnits) / sizeof(speedUnits[0]), p, len);
+  if (found == nullptr || *skipBlanks(p + len) != '\0')
+  {
+    return false;
+  }
+  uint64_t speed = thousandths * found->um / UM_PER_M;
+  if (speed > 0xFFFFFFFFu)
+  {
+    return false;
+  }
+  mmPerS = (uint32_t)speed;
+  return true;
+}
+
+bool navParseClock(const char *text, uint16_t &minuteOfDay)
+{
+  const char *p = skipBlanks(text);
+  uint8_t hour = 0;
+  uint8_t digits = 0;
+  for (; digit(*p) && digits < 2; p++, digits++)
+  {
+    hour = hour * 10 + (*p - '0');
+  }
+  if (digits == 0 || *p != ':' || !digit(p[1]) || !digit(p[2]))
+  {
+    return false;
+  }
+  uint8_t minute = (p[1] - '0') * 10 + (p[2] - '0');
+  p = skipBlanks(p + 3);
+
+  // Optional am/pm
+  size_t len = wordLength(p);
+  if (len > 0)
+  {
+    bool am = sameWord(p, len, "am");
+    if (!(am || sameWord(p, len, "pm")) || hour == 0 || hour > 12)
+    {
+      return false;
+    }
+    hour = (hour % 12) + (am ? 0 : 12);
+    p = skipBlanks(p + len);
+  }
+  if (*p != '\0' || hour > 23 || minute > 59)
+  {
+    return false;
+  }
+  minuteOfDay = hour * 60 + minute;
+  return true;
+}
+
+bool navParseDuration(const char *text, uint32_t &seconds)
+{
+  uint64_t total = 0; // thousandths of a second
+  bool any = false;
+  const char *p = skipBlanks(text);
+  while (*p != '\0')
+  {
+    uint64_t thousandths;
+    uint8_t decimals;
+    char separator;
+    p = parseNumber(p, thousandths, decimals, separator);
+    if (p == nullptr)
+    {
+      return false;
+    }
+
+    // Units are letters only, so "1h05m" splits into its parts
+    p = skipBlanks(p);
+    size_t len = 0;
+    while (letter(p[len]))
+    {
+      len++;
+    }
+    const UnitName *found = findUnit(durationUnits, sizeof(durationUnits) / sizeof(durationUnits[0]), p, len);
+    if (found == nullptr)
+    {
+      return false;
+    }
+    total += thousandths * found->um;
+    if (total / 1000 > 0xFFFFFFFFu)
+    {
+      return false;
+    }
+    any = true;
+    p = skipBlanks(p + len);
+  }
+  if (!any)
+  {
+    return false;
+  }
+  seconds = (uint32_t)(total / 1000);
+  return true;
+}
+
+// The unit, decimals and unit text a value is printed with
+static void printStyle(const NavDistance &written, uint32_t mm, uint32_t &unitUm, uint8_t &decimals,
+                       const char *&unit)
+{
+  unitUm = written.unitUm;
+  decimals = written.decimals;
+  unit = written.unit;
+  if (unitUm == UM_PER_KM && mm < 1000000)
+  {
+    unitUm = UM_PER_M;
+    decimals = 0;
+    unit = written.unit + 1; // "km" -> "m", keeping the case
+  }
+}
+
+int navFormatDistance(char *out, size_t size, const NavDistance &written, uint32_t mm)
+{
+  uint32_t unitUm;
+  uint8_t decimals;
+  const char *unit;
+  printStyle(written, mm, unitUm, decimals, unit);
+
+  // The value in steps of the last digit, rounded to the nearest
+  uint32_t scale = powersOf10[decimals];
+  uint64_t steps = ((uint64_t)mm * 1000 * scale + unitUm / 2) / unitUm;
+  unsigned long whole = (unsigned long)(steps / scale);
+  if (decimals == 0)
+  {
+    return snprintf(out, size, "%lu%s%s", whole, written.gap, unit);
+  }
+  return snprintf(out, size, "%lu%c%0*lu%s%s", whole, written.separator, (int)decimals,
+                  (unsigned long)(steps % scale), written.gap, unit);
+}
+
+uint32_t navDistanceStep(const NavDistance &written, uint32_t mm)
+{
+  uint32_t unitUm;
+  uint8_t decimals;
+  const char *unit;
+  printStyle(written, mm, unitUm, decimals, unit);
+  return max(unitUm / powersOf10[decimals] / 1000, (uint32_t)1);
+}
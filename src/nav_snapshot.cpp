@@ -0,0 +1,86 @@
+#include "nav_snapshot.h"
+
+static void copyText(char *dst, size_t size, const String &src)
+{
+  size_t len = min((size_t)src.length(), size - 1);
+  memcpy(dst, src.c_str(), len);
+  dst[len] = '\0';
+}
+
+void navSnapshotFill(NavSnapshot &out, const Navigation &nav, bool connected, const String &appVersion)
+{
+  out.connected = connected;
+  out.active = nav.active;
+  out.isNavigation = nav.isNavigation;
+  out.hasIcon = nav.hasIcon;
+  copyText(out.title, sizeof(out.title), nav.title);
+  copyText(out.eta, sizeof(out.eta), nav.eta);
+  copyText(out.duration, sizeof(out.duration), nav.duration);
+  copyText(out.distance, sizeof(out.distance), nav.distance);
+  copyText(out.speed, sizeof(out.speed), nav.speed);
+  copyText(out.directions, sizeof(out.directions), nav.directions);
+  copyText(out.appVersion, sizeof(out.appVersion), appVersion);
+  memcpy(out.icon, nav.icon, sizeof(out.icon));
+}
+
+uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (len--)
+  {
+    hash ^= *bytes++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t fnv1aText(uint32_t hash, const char *text, size_t size)
+{
+  // Include the terminator so field boundaries are part of the hash
+  return fnv1a(hash, text, strnlen(text, size - 1) + 1);
+}
+
+uint32_t navSnapshotFingerprint(const NavSnapshot &nav)
+{
+  uint32_t hash = FNV1A_SEED;
+  uint8_t flags = (nav.active ? 1 : 0) | (nav.isNavigation ? 2 : 0) | (nav.hasIcon ? 4 : 0);
+  hash = fnv1a(hash, &flags, 1);
+  hash = fnv1aText(hash, nav.title, sizeof(nav.title));
+  hash = fnv1aText(hash, nav.eta, sizeof(nav.eta));
+  hash = fnv1aText(hash, nav.duration, sizeof(nav.duration));
+  hash = fnv1aText(hash, nav.distance, sizeof(nav.distance));
+  hash = fnv1aText(hash, nav.speed, sizeof(nav.speed));
+  hash = fnv1aText(hash, nav.directions, sizeof(nav.directions));
+  hash = fnv1aText(hash, nav.appVersion, sizeof(nav.appVersion));
+  hash = fnv1a(hash, nav.icon, sizeof(nav.icon));
+  return hash;
+}
+
+void NavSeqlock::publish(const NavSnapshot &snapshot)
+{
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed); // odd: write in progress
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&data, &snapshot, sizeof(data));
+  std::atomic_thread_fence(std::memory_order_release);
+  seq.store(s + 2, std::memory_order_release);
+}
+
+void NavSeqlock::read(NavSnapshot &out) const
+{
+  for (;;)
+  {
+    uint32_t before = seq.load(std::memory_order_acquire);
+    if (before & 1)
+    {
+      yield();
+      continue;
+    }
+    memcpy(&out, &data, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) == before)
+    {
+      return;
+    }
+  }
+}
@@ -0,0 +1,272 @@
+#include "nav_trace.h"
+#include <stddef.h>
+
+struct TraceField
+{
+  char key;
+  size_t offset; // in NavSnapshot
+  size_t size;
+};
+
+static const TraceField traceFields[NAV_TRACE_FIELDS] = {
+    {'t', offsetof(NavSnapshot, title), NAV_TEXT_SHORT},
+    {'e', offsetof(NavSnapshot, eta), NAV_TEXT_SHORT},
+    {'u', offsetof(NavSnapshot, duration), NAV_TEXT_SHORT},
+    {'d', offsetof(NavSnapshot, distance), NAV_TEXT_SHORT},
+    {'s', offsetof(NavSnapshot, speed), NAV_TEXT_SHORT},
+    {'r', offsetof(NavSnapshot, directions), NAV_TEXT_LONG},
+};
+
+// Every text field escaped to twice its length, plus the line around it
+static_assert(3 + 10 + 3 + 1 + 5 * (3 + 2 * (NAV_TEXT_SHORT - 1)) + 3 + 2 * (NAV_TEXT_LONG - 1) + 1 <=
+                  NAV_TRACE_LINE_MAX,
+              "a navigation line fits");
+static_assert(3 + 10 + 3 + 2 * NAV_ICON_BYTES + 1 <= NAV_TRACE_LINE_MAX, "an icon line fits");
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static const char *fieldText(const NavSnapshot &nav, const TraceField &field)
+{
+  return (const char *)&nav + field.offset;
+}
+
+static uint8_t navFlags(const NavSnapshot &nav)
+{
+  return (nav.active ? 1 : 0) | (nav.isNavigation ? 2 : 0) | (nav.hasIcon ? 4 : 0);
+}
+
+//////////////////////
+// Writer
+//////////////////////
+void NavTraceWriter::start(Print *out)
+{
+  this->out = out;
+  primed = false;
+}
+
+void NavTraceWriter::emit(size_t length)
+{
+  line[length++] = '\n';
+  out->write((const uint8_t *)line, length);
+  counters.lines++;
+  counters.bytes += length;
+}
+
+void NavTraceWriter::capture(const NavSnapshot &nav, unsigned long now)
+{
+  if (out == nullptr)
+  {
+    return;
+  }
+
+  if (!primed || nav.connected != connected)
+  {
+    connected = nav.connected;
+    emit(snprintf(line, sizeof(line), "@T\t%lu\tc\t%u", now, connected ? 1u : 0u));
+  }
+
+  // Only the text fields that changed, but always the flags
+  size_t length = snprintf(line, sizeof(line), "@T\t%lu\tn\t%u", now, (unsigned)navFlags(nav));
+  bool changed = !primed || navFlags(nav) != flags;
+  flags = navFlags(nav);
+  for (uint8_t i = 0; i < NAV_TRACE_FIELDS; i++)
+  {
+    const char *text = fieldText(nav, traceFields[i]);
+    size_t len = strnlen(text, traceFields[i].size - 1);
+    uint32_t print = fnv1a(FNV1A_SEED, text, len);
+    if (primed && print == fieldPrints[i])
+    {
+      continue;
+    }
+    fieldPrints[i] = print;
+    changed = true;
+    line[length++] = '\t';
+    line[length++] = traceFields[i].key;
+    line[length++] = '=';
+    for (size_t c = 0; c < len; c++)
+    {
+      char escaped = text[c] == '\t' ? 't' : text[c] == '\r' ? 'r' : text[c] == '\n' ? 'n' : text[c];
+      if (escaped != text[c] || text[c] == '\\')
+      {
+        line[length++] = '\\';
+      }
+      line[length++] = escaped;
+    }
+  }
+  if (changed)
+  {
+    emit(length);
+  }
+
+  uint32_t icon = nav.hasIcon ? fnv1a(FNV1A_SEED, nav.icon, NAV_ICON_BYTES) : 0;
+  if (nav.hasIcon && (!primed || icon != iconPrint))
+  {
+    length = snprintf(line, sizeof(line), "@T\t%lu\ti\t", now);
+    for (size_t i = 0; i < NAV_ICON_BYTES; i++)
+    {
+      line[length++] = hexDigits[nav.icon[i] >> 4];
+      line[length++] = hexDigits[nav.icon[i] & 0x0F];
+    }
+    emit(length);
+  }
+  iconPrint = icon;
+  primed = true;
+}
+
+//////////////////////
+// Reader
+//////////////////////
+bool NavTraceReader::feed(char c)
+{
+  static const char marker[] = "@T\t";
+  if (matched < 3)
+  {
+    matched = c == marker[matched] ? matched + 1 : c == marker[0] ? 1 : 0;
+    length = 0;
+    overflow = false;
+    return false;
+  }
+  if (c == '\r')
+  {
+    return false;
+  }
+  if (c != '\n')
+  {
+    if (length < sizeof(line) - 1)
+    {
+      line[length++] = c;
+    }
+    else
+    {
+      overflow = true;
+    }
+    return false;
+  }
+
+  matched = 0;
+  line[length] = '\0';
+  if (overflow || !parse())
+  {
+    malformed++;
+    return false;
+  }
+  counters.lines++;
+  counters.bytes += length + 4;
+  return true;
+}
+
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+// "<ms>\t<kind>\t<fields...>" into current (left as it was on failure)
+bool NavTraceReader::parse()
+{
+  char *p = line;
+  char *end;
+  unsigned long ms = strtoul(p, &end, 10);
+  if (end == p || end[0] != '\t' || end[1] == '\0' || end[2] != '\t')
+  {
+    return false;
+  }
+  char kind = end[1];
+  p = end + 3;
+
+  NavSnapshot &state = current.state;
+  if (kind == 'c')
+  {
+    if ((p[0] != '0' && p[0] != '1') || p[1] != '\0')
+    {
+      return false;
+    }
+    state.connected = p[0] == '1';
+    current.kind = NAV_TRACE_CONNECTION;
+  }
+  else if (kind == 'i')
+  {
+    if (strlen(p) != 2 * NAV_ICON_BYTES)
+    {
+      return false;
+    }
+    uint8_t icon[NAV_ICON_BYTES];
+    for (size_t i = 0; i < NAV_ICON_BYTES; i++)
+    {
+      int high = hexValue(p[2 * i]);
+      int low = hexValue(p[2 * i + 1]);
+      if (high < 0 || low < 0)
+      {
+        return false;
+      }
+      icon[i] = (uint8_t)(high << 4 | low);
+    }
+    memcpy(state.icon, icon, sizeof(icon));
+    current.kind = NAV_TRACE_ICON;
+  }
+  else if (kind == 'n')
+  {
+    if (p[0] < '0' || p[0] > '7' || (p[1] != '\0' && p[1] != '\t'))
+    {
+      return false;
+    }
+    NavSnapshot parsed;
+    memcpy(&parsed, &state, sizeof(parsed));
+    parsed.active = (p[0] - '0') & 1;
+    parsed.isNavigation = (p[0] - '0') & 2;
+    parsed.hasIcon = (p[0] - '0') & 4;
+    p++;
+
+    while (*p == '\t')
+    {
+      const TraceField *field = nullptr;
+      for (const TraceField &f : traceFields)
+      {
+        field = f.key == p[1] ? &f : field;
+      }
+      if (field == nullptr || p[2] != '=')
+      {
+        return false;
+      }
+      char *text = (char *)&parsed + field->offset;
+      size_t len = 0;
+      for (p += 3; *p != '\0' && *p != '\t'; p++)
+      {
+        char c = *p;
+        if (c == '\\')
+        {
+          c = *++p;
+          c = c == 't' ? '\t' : c == 'r' ? '\r' : c == 'n' ? '\n' : c;
+          if (c == '\0')
+          {
+            return false;
+          }
+        }
+        if (len < field->size - 1)
+        {
+          text[len++] = c;
+        }
+      }
+      text[len] = '\0';
+    }
+    if (*p != '\0')
+    {
+      return false;
+    }
+    memcpy(&state, &parsed, sizeof(state));
+    current.kind = NAV_TRACE_NAV;
+  }
+  else
+  {
+    return false;
+  }
+  current.ms = (uint32_t)ms;
+  return true;
+}
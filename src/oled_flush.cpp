@@ -0,0 +1,223 @@
+#include "oled_flush.h"
+
+void OledDeltaFlush::begin(Adafruit_SSD1306 *display, I2cBus *bus, uint8_t address)
+{
+  this->display = display;
+  this->bus = bus;
+  this->address = address;
+  width = min((int)display->width(), OLED_FLUSH_MAX_WIDTH);
+  pages = min((int)display->height() / 8, OLED_FLUSH_MAX_PAGES);
+  shadowValid = false;
+  commitPending = false;
+  windowCount = 0;
+}
+
+void OledDeltaFlush::commit()
+{
+  if (display == nullptr || display->getBuffer() == nullptr)
+  {
+    return;
+  }
+  if (windowCount > 0)
+  {
+    commitPending = true;
+    return;
+  }
+
+  commitPending = false;
+  current = {};
+  queueChanges();
+  if (windowCount == 0)
+  {
+    finishFrame();
+  }
+}
+
+void OledDeltaFlush::queueChanges()
+{
+  const uint8_t *buffer = display->getBuffer();
+  windowCount = 0;
+  windowIndex = 0;
+  sentInWindow = 0;
+  windowOpen = false;
+
+  // Panel contents unknown (first frame, after sleep, ...) - send every page
+  if (!shadowValid)
+  {
+    memcpy(shadow, buffer, width * pages);
+    shadowValid = true;
+    current.fullFrames = 1;
+    for (uint8_t page = 0; page < pages; page++)
+    {
+      windows[windowCount++] = {page, 0, (uint8_t)(width - 1)};
+    }
+    return;
+  }
+
+  // First/last changed column per page, for the fragmented fallback
+  uint8_t first[OLED_FLUSH_MAX_PAGES];
+  uint8_t last[OLED_FLUSH_MAX_PAGES];
+  bool overflow = false;
+  for (uint8_t page = 0; page < pages; page++)
+  {
+    first[page] = 0xFF;
+    last[page] = 0;
+    const uint8_t *src = buffer + page * width;
+    uint8_t *dst = shadow + page * width;
+    uint8_t col = 0;
+
+    while (col < width)
+    {
+      // Skip to the next changed column
+      while (col < width && src[col] == dst[col])
+      {
+        col++;
+      }
+      if (col >= width)
+      {
+        break;
+      }
+
+      // Extend the run, bridging short unchanged gaps
+      uint8_t start = col;
+      uint8_t end = col;
+      while (col < width)
+      {
+        if (src[col] != dst[col])
+        {
+          end = col;
+        }
+        else if (col - end > OLED_FLUSH_MERGE_GAP)
+        {
+          break;
+        }
+        col++;
+      }
+
+      memcpy(dst + start, src + start, end - start + 1);
+      first[page] = min(first[page], start);
+      last[page] = end;
+      if (windowCount < OLED_FLUSH_MAX_WINDOWS)
+      {
+        windows[windowCount++] = {page, start, end};
+      }
+      else
+      {
+        overflow = true;
+      }
+    }
+  }
+
+  if (overflow)
+  {
+    // Too fragmented: one run per dirty page, from first to last change.
+    // The shadow already holds the new frame, so resending extra is safe.
+    windowCount = 0;
+    for (uint8_t page = 0; page < pages; page++)
+    {
+      if (first[page] != 0xFF)
+      {
+        windows[windowCount++] = {page, first[page], last[page]};
+      }
+    }
+  }
+}
+
+bool OledDeltaFlush::step(uint16_t budget)
+{
+  if (windowCount == 0)
+  {
+    if (commitPending)
+    {
+      commit();
+    }
+    if (windowCount == 0)
+    {
+      return true;
+    }
+  }
+
+  uint16_t spent = 0;
+  bool ok = true;
+  current.steps++;
+
+  while (windowIndex < windowCount && spent < budget)
+  {
+    const Window &w = windows[windowIndex];
+
+    if (!windowOpen)
+    {
+      // Restrict the GDDRAM write window to this run; horizontal addressing
+      // (set by Adafruit_SSD1306::begin) then streams the data straight in
+      const uint8_t command[] = {SSD1306_COLUMNADDR, w.col0, w.col1, SSD1306_PAGEADDR, w.page, w.page};
+      ok = bus->write(address, 0x00, command, sizeof(command)) && ok; // Co=0, D/C#=0: command stream
+      current.transactions++;
+      current.bytes += 7;
+      spent += 7;
+      windowOpen = true;
+      sentInWindow = 0;
+      continue;
+    }
+
+    uint16_t length = w.col1 - w.col0 + 1;
+    uint16_t count = min((uint16_t)(length - sentInWindow), (uint16_t)OLED_FLUSH_CHUNK);
+    const uint8_t *data = shadow + w.page * width + w.col0 + sentInWindow;
+
+    ok = bus->write(address, 0x40, data, count) && ok; // Co=0, D/C#=1: data stream
+    current.transactions++;
+    current.bytes += 1 + count;
+    spent += 1 + count;
+    sentInWindow += count;
+
+    if (sentInWindow >= length)
+    {
+      current.windows++;
+      windowIndex++;
+      windowOpen = false;
+    }
+  }
+
+  frameFailed = frameFailed || !ok;
+
+  if (windowIndex >= windowCount)
+  {
+    windowCount = 0;
+    finishFrame();
+    if (frameFailed)
+    {
+      // Part of the frame may be missing or misplaced on the panel: send
+      // the whole buffer once (if that fails too, wait for the next frame)
+      shadowValid = false;
+      commitPending = commitPending || !repairing;
+    }
+    repairing = frameFailed;
+    frameFailed = false;
+    if (commitPending)
+    {
+      commit();
+    }
+  }
+  return !busy();
+}
+
+void OledDeltaFlush::flush()
+{
+  // A frame already in flight goes out first, then this buffer
+  commit();
+  while (!step(0xFFFF))
+  {
+  }
+}
+
+void OledDeltaFlush::finishFrame()
+{
+  current.frames = 1;
+  frame = current;
+  totals.frames += current.frames;
+  totals.fullFrames += current.fullFrames;
+  totals.windows += current.windows;
+  totals.bytes += current.bytes;
+  totals.transactions += current.transactions;
+  totals.steps += current.steps;
+  current = {};
+}
@@ -0,0 +1,137 @@
+#include "power_scheduler.h"
+
+static PowerStats counters = {};
+static uint32_t idleBudgetMs = POWER_BLE_SERVICE_MS;
+static uint32_t busySinceUs = 0;
+
+void powerRunWithin(uint32_t ms)
+{
+  idleBudgetMs = min(idleBudgetMs, ms);
+}
+
+const PowerStats &powerStats() { return counters; }
+
+uint8_t powerDutyCycle()
+{
+  uint64_t total = counters.busyUs + counters.idleUs;
+  return total == 0 ? 100 : (uint8_t)(counters.busyUs * 100 / total);
+}
+
+#if POWER_SCHEDULER
+
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+
+static TaskHandle_t loopTaskHandle = nullptr;
+static gpio_num_t wakeGpio = GPIO_NUM_NC;
+static volatile bool wakeArmed = false;
+
+// Level wake at the opposite of the pin's level: satisfied by its next change
+static void armWakePin()
+{
+  if (wakeGpio == GPIO_NUM_NC)
+  {
+    return;
+  }
+  gpio_int_type_t level = gpio_get_level(wakeGpio) == 0 ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL;
+  wakeArmed = true;
+  gpio_wakeup_enable(wakeGpio, level);
+}
+
+// Back to the button's any-edge interrupt; register writes only, safe in an ISR
+static void IRAM_ATTR disarmWakePin()
+{
+  if (wakeArmed)
+  {
+    wakeArmed = false;
+    gpio_ll_wakeup_disable(&GPIO, wakeGpio);
+    gpio_ll_set_intr_type(&GPIO, wakeGpio, GPIO_INTR_ANYEDGE);
+  }
+}
+
+void powerBegin(uint8_t wakePin)
+{
+  loopTaskHandle = xTaskGetCurrentTaskHandle(); // setup() runs on the loop task
+
+#if CONFIG_PM_ENABLE
+  esp_pm_config_esp32_t pm = {};
+  pm.max_freq_mhz = getCpuFrequencyMhz();
+  pm.min_freq_mhz = POWER_MIN_CPU_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  // The pin's level wake is armed per powerIdle() (see the header)
+  esp_sleep_enable_gpio_wakeup();
+  pm.light_sleep_enable = true;
+#endif
+  counters.lightSleep = esp_pm_configure(&pm) == ESP_OK && pm.light_sleep_enable;
+#endif
+  wakeGpio = counters.lightSleep ? (gpio_num_t)wakePin : GPIO_NUM_NC;
+  busySinceUs = micros();
+}
+
+void powerIdle()
+{
+  uint32_t idleStart = micros();
+  counters.busyUs += idleStart - busySinceUs;
+
+  if (idleBudgetMs > 0)
+  {
+    counters.sleeps++;
+    armWakePin();
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleBudgetMs)) > 0)
+    {
+      counters.earlyWakes++;
+    }
+    portDISABLE_INTERRUPTS();
+    disarmWakePin();
+    portENABLE_INTERRUPTS();
+  }
+
+  busySinceUs = micros();
+  counters.idleUs += busySinceUs - idleStart;
+  idleBudgetMs = POWER_BLE_SERVICE_MS;
+}
+
+void powerWake()
+{
+  if (loopTaskHandle != nullptr)
+  {
+    xTaskNotifyGive(loopTaskHandle);
+  }
+}
+
+void IRAM_ATTR powerWakeFromISR()
+{
+  disarmWakePin(); // a level interrupt would fire again as soon as we return
+  if (loopTaskHandle != nullptr)
+  {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(loopTaskHandle, &woken);
+    if (woken)
+    {
+      portYIELD_FROM_ISR();
+    }
+  }
+}
+
+#else
+
+void powerBegin(uint8_t wakePin)
+{
+  (void)wakePin;
+  busySinceUs = micros();
+}
+
+void powerIdle()
+{
+  uint32_t now = micros();
+  counters.busyUs += now - busySinceUs;
+  busySinceUs = now;
+  idleBudgetMs = POWER_BLE_SERVICE_MS;
+}
+
+void powerWake() {}
+void powerWakeFromISR() {}
+
+#endif
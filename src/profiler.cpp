@@ -0,0 +1,68 @@
+#include "profiler.h"
+
+#if PROFILER
+
+static ProfileHistogram histograms[PROF_POINT_COUNT];
+
+#define PROFILE_LABEL(name, label) label,
+static const char *const labels[] = {PROFILE_POINTS(PROFILE_LABEL)};
+#undef PROFILE_LABEL
+
+void profilerRecord(ProfilePoint point, uint32_t cycles)
+{
+  ProfileHistogram &h = histograms[point];
+  // Bucket = index of the highest set bit (0 and 1 cycle share bucket 0)
+  uint8_t bucket = cycles > 1 ? 31 - __builtin_clz(cycles) : 0;
+  h.buckets[bucket]++;
+  if (h.count == 0 || cycles < h.minCycles)
+  {
+    h.minCycles = cycles;
+  }
+  h.maxCycles = max(h.maxCycles, cycles);
+  h.totalCycles += cycles;
+  h.count++;
+}
+
+const ProfileHistogram &profilerHistogram(ProfilePoint point) { return histograms[point]; }
+
+uint32_t profilerPercentile(const ProfileHistogram &histogram, uint8_t percent)
+{
+  if (histogram.count == 0)
+  {
+    return 0;
+  }
+  uint64_t rank = ((uint64_t)histogram.count * percent + 99) / 100; // 1-based
+  uint64_t seen = 0;
+  for (uint8_t i = 0; i < PROF_BUCKETS; i++)
+  {
+    seen += histogram.buckets[i];
+    if (seen >= rank && seen > 0)
+    {
+      uint32_t upper = i >= 31 ? 0xFFFFFFFF : (2u << i) - 1;
+      return min(upper, histogram.maxCycles);
+    }
+  }
+  return histogram.maxCycles;
+}
+
+void profilerReset() { memset(histograms, 0, sizeof(histograms)); }
+
+void profilerDump(Print &out)
+{
+  float mhz = PROF_CLOCK_MHZ;
+  out.println("=== Profile (us; p50/p99 are log2 bucket upper bounds) ===");
+  out.printf("%-18s %8s %9s %9s %9s %9s %9s\n", "point", "count", "min", "avg", "p50", "p99", "max");
+  for (uint8_t i = 0; i < PROF_POINT_COUNT; i++)
+  {
+    const ProfileHistogram &h = histograms[i];
+    if (h.count == 0)
+    {
+      continue;
+    }
+    out.printf("%-18s %8lu %9.1f %9.1f %9.1f %9.1f %9.1f\n", labels[i], (unsigned long)h.count,
+               h.minCycles / mhz, (float)h.totalCycles / h.count / mhz,
+               profilerPercentile(h, 50) / mhz, profilerPercentile(h, 99) / mhz, h.maxCycles / mhz);
+  }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "redraw_trigger.h"
+
+void RedrawTrigger::begin(ChronosESP32 *chronos)
+{
+  this->chronos = chronos;
+  eventPending = false;
+  firstFrame = true; // Draw and fingerprint on the first poll
+}
+
+void RedrawTrigger::setPolicy(RefreshPolicy policy)
+{
+  this->policy = policy;
+  adopt(policy(sampled));
+}
+
+void RedrawTrigger::adopt(const RefreshRate &rate)
+{
+  counters.rateChanges += rate.mode != current.mode ? 1 : 0;
+  current = rate;
+}
+
+void RedrawTrigger::notifyEvent()
+{
+  // Keep the oldest unserviced event so latency covers the whole wait
+  if (!eventPending)
+  {
+    eventUs = micros();
+    eventPending = true;
+  }
+  counters.events++;
+}
+
+bool RedrawTrigger::poll(uint32_t screenState, NavSnapshot *frame)
+{
+  unsigned long now = millis();
+  bool changed = firstFrame || screenState != lastScreenState;
+  bool fromEvent = false;
+  uint32_t pendingSince = 0;
+
+  if (firstFrame || eventPending || now - lastNavPoll >= current.frameMs)
+  {
+    // Clear first: an event arriving during getNavigation() stays pending
+    bool hadEvent = eventPending;
+    eventPending = false;
+    pendingSince = eventUs;
+    lastNavPoll = now;
+
+    navSnapshotFill(*frame, chronos->getNavigation(), chronos->isConnected(), chronos->getAppVersion());
+    sampled = refreshState(*frame);
+    adopt(policy(sampled));
+
+    uint32_t print = navSnapshotFingerprint(*frame);
+    if (print != navPrint)
+    {
+      navPrint = print;
+      changed = true;
+      fromEvent = hadEvent && !firstFrame;
+    }
+  }
+
+  bool heartbeat = now - lastRequest >= current.heartbeatMs;
+  if (!changed && !heartbeat)
+  {
+    return false;
+  }
+
+  firstFrame = false;
+  lastScreenState = screenState;
+  lastRequest = now;
+  frame->request.fromEvent = fromEvent;
+  frame->request.eventUs = pendingSince;
+
+  counters.frames++;
+  if (changed)
+  {
+    counters.changeFrames++;
+  }
+  else
+  {
+    counters.heartbeatFrames++;
+  }
+  return true;
+}
+
+uint32_t RedrawTrigger::msUntilDue() const
+{
+  if (firstFrame || eventPending)
+  {
+    return 0;
+  }
+  unsigned long now = millis();
+  uint32_t poll = min((uint32_t)(now - lastNavPoll), current.frameMs);
+  uint32_t heartbeat = min((uint32_t)(now - lastRequest), current.heartbeatMs);
+  return min(current.frameMs - poll, current.heartbeatMs - heartbeat);
+}
+
+void RedrawTrigger::frameDone(const RedrawRequest &request)
+{
+  uint32_t nowUs = micros();
+  counters.framesDone++;
+  counters.lastFrameUs = nowUs;
+
+  if (request.fromEvent)
+  {
+    uint32_t latency = nowUs - request.eventUs;
+    counters.lastEventUs = request.eventUs;
+    counters.lastLatencyUs = latency;
+    counters.maxLatencyUs = max(counters.maxLatencyUs, latency);
+    counters.totalLatencyUs += latency;
+    counters.latencySamples++;
+  }
+}
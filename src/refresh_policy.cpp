@@ -0,0 +1,60 @@
+#include "refresh_policy.h"
+#include "nav_parse.h"
+
+// Per mode: frame interval, heartbeat
+static const RefreshRate adaptiveRates[REFRESH_MODES] = {
+    {REFRESH_DISCONNECTED, 5000, 60000}, // connection events redraw at once
+    {REFRESH_IDLE, 5000, 60000},         // the clock changes on the minute
+    {REFRESH_CRUISE, 2000, 10000},
+    {REFRESH_GUIDANCE, 1000, 10000},
+    {REFRESH_APPROACH, 200, 2000},
+};
+
+static const char *const modeNames[REFRESH_MODES] = {"disconnected", "idle", "cruise", "guidance", "approach"};
+
+RefreshState refreshState(const NavSnapshot &nav)
+{
+  RefreshState state = {};
+  state.connected = nav.connected;
+  state.active = nav.connected && nav.active;
+  NavDistance turn;
+  if (state.active && navParseDistance(nav.title, turn))
+  {
+    state.hasTurn = true;
+    state.turnMm = turn.mm;
+  }
+  return state;
+}
+
+RefreshRate refreshAdaptive(const RefreshState &state)
+{
+  RefreshMode mode = REFRESH_GUIDANCE;
+  if (!state.connected)
+  {
+    mode = REFRESH_DISCONNECTED;
+  }
+  else if (!state.active)
+  {
+    mode = REFRESH_IDLE;
+  }
+  else if (state.hasTurn && state.turnMm <= REFRESH_APPROACH_MM)
+  {
+    mode = REFRESH_APPROACH;
+  }
+  else if (state.hasTurn && state.turnMm > REFRESH_CRUISE_MM)
+  {
+    mode = REFRESH_CRUISE;
+  }
+  return adaptiveRates[mode];
+}
+
+RefreshRate refreshFixed(const RefreshState &state)
+{
+  RefreshMode mode = !state.connected ? REFRESH_DISCONNECTED : state.active ? REFRESH_GUIDANCE : REFRESH_IDLE;
+  return {mode, NAV_POLL_INTERVAL, DISPLAY_HEARTBEAT};
+}
+
+const char *refreshModeName(RefreshMode mode)
+{
+  return mode < REFRESH_MODES ? modeNames[mode] : "?";
+}
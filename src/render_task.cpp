@@ -0,0 +1,86 @@
+#include "render_task.h"
+
+#if RENDER_TASK
+
+static NavSeqlock navShared;
+static TaskHandle_t renderTaskHandle = nullptr;
+static SemaphoreHandle_t displayMutex = nullptr;
+
+static void renderTaskMain(void *)
+{
+  static NavSnapshot nav;
+  bool idle = true;
+  uint32_t dueMs = RENDER_NOTHING_DUE;
+  for (;;)
+  {
+    // Sleep while idle (until the next animation step, if any); while a
+    // frame is in flight only check for a newer snapshot between slices.
+    // The mutex is dropped after every slice.
+    TickType_t wait = !idle ? 0 : dueMs == RENDER_NOTHING_DUE ? portMAX_DELAY : pdMS_TO_TICKS(dueMs);
+    if (ulTaskNotifyTake(pdTRUE, wait) > 0)
+    {
+      navShared.read(nav);
+      xSemaphoreTake(displayMutex, portMAX_DELAY);
+      renderFrame(nav);
+      xSemaphoreGive(displayMutex);
+    }
+
+    xSemaphoreTake(displayMutex, portMAX_DELAY);
+    idle = displayService();
+    dueMs = displayAnimate(); // panels that are done step even while another sends
+    idle = idle && dueMs != 0;
+    xSemaphoreGive(displayMutex);
+  }
+}
+
+void renderTaskBegin()
+{
+  displayMutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(renderTaskMain, "render", RENDER_TASK_STACK, nullptr,
+                          RENDER_TASK_PRIORITY, &renderTaskHandle, RENDER_TASK_CORE);
+}
+
+void renderSubmit(const NavSnapshot &nav)
+{
+  navShared.publish(nav);
+  xTaskNotifyGive(renderTaskHandle);
+}
+
+bool renderService() { return true; }
+uint32_t renderMsUntilDue() { return RENDER_NOTHING_DUE; }
+
+void renderLock()
+{
+  if (displayMutex != nullptr)
+  {
+    xSemaphoreTake(displayMutex, portMAX_DELAY);
+  }
+}
+
+void renderUnlock()
+{
+  if (displayMutex != nullptr)
+  {
+    xSemaphoreGive(displayMutex);
+  }
+}
+
+#else
+
+static uint32_t animateDueMs = RENDER_NOTHING_DUE;
+
+void renderTaskBegin() {}
+void renderSubmit(const NavSnapshot &nav) { renderFrame(nav); }
+
+bool renderService()
+{
+  bool idle = displayService();
+  animateDueMs = displayAnimate();
+  return idle && animateDueMs != 0;
+}
+
+uint32_t renderMsUntilDue() { return animateDueMs; }
+void renderLock() {}
+void renderUnlock() {}
+
+#endif
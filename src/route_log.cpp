@@ -0,0 +1,549 @@
+#include "route_log.h"
+#include "time_keeper.h"
+#include <atomic>
+
+#define ROUTE_LOG_PAYLOAD sizeof(RouteLogPage::records)
+
+// Largest record: ms varint, mask, flags, five short texts, the directions
+// and the icon print
+#define ROUTE_LOG_RECORD_MAX (5 + 1 + 1 + 5 * NAV_TEXT_SHORT + 1 + ROUTE_LOG_DIRECTIONS_MAX + 4)
+
+static_assert(sizeof(RouteLogPage) == ROUTE_LOG_PAGE_BYTES, "a page is one SPIFFS page of data");
+static_assert(ROUTE_LOG_RECORD_MAX <= ROUTE_LOG_PAYLOAD, "any record fits an empty page");
+static_assert((ROUTE_LOG_QUEUE & (ROUTE_LOG_QUEUE - 1)) == 0, "queue size must be a power of two");
+
+// What the last record left the reader knowing
+struct RouteLogState
+{
+  uint8_t flags;
+  char title[NAV_TEXT_SHORT];
+  char distance[NAV_TEXT_SHORT];
+  char eta[NAV_TEXT_SHORT];
+  char duration[NAV_TEXT_SHORT];
+  char speed[NAV_TEXT_SHORT];
+  char directions[ROUTE_LOG_DIRECTIONS_MAX + 1];
+  uint32_t icon;
+};
+
+static fs::FS *logFs = nullptr;
+static RouteLogStats counters = {};
+
+// Producer side (loop)
+static RouteLogState last = {};
+static bool lastValid = false; // false: the next record carries every field
+static RouteLogPage batch = {};
+static unsigned long lastRecordMs = 0;
+static uint16_t segmentLeft = 0; // pages the newest segment still takes; 0: the next one opens a segment
+
+// Sealed pages: the loop fills slots, the writer empties them. The loop
+// also decides where segments start, so that the first record of every
+// segment carries every field: removing the oldest segment never leaves
+// the reader with deltas against pages that are gone.
+static RouteLogPage queue[ROUTE_LOG_QUEUE];
+static bool queueOpens[ROUTE_LOG_QUEUE]; // the page in this slot starts a segment
+static std::atomic<uint32_t> queued{0};
+static std::atomic<uint32_t> taken{0};
+static std::atomic<bool> writing{false};
+static std::atomic<Print *> dumpTo{nullptr};
+static std::atomic<bool> reopen{false}; // a write failed: the loop starts a new segment
+
+// Writer side
+static uint8_t segment = 0;
+static bool appending = false; // false after a failed write, until the next segment
+static uint32_t nextSequence = 0;
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static uint32_t pageCrc(const RouteLogPage &page)
+{
+  RouteLogPage copy;
+  memcpy(&copy, &page, sizeof(copy));
+  copy.crc = 0;
+  return crc32((const uint8_t *)&copy, sizeof(copy));
+}
+
+static bool pageValid(const RouteLogPage &page)
+{
+  return page.magic == ROUTE_LOG_MAGIC && page.length <= ROUTE_LOG_PAYLOAD && page.crc == pageCrc(page);
+}
+
+static void segmentPath(char *path, size_t size, uint8_t index)
+{
+  snprintf(path, size, "/route%u.log", (unsigned)index);
+}
+
+static bool readPage(File &file, uint32_t index, RouteLogPage &page)
+{
+  return file.seek(index * ROUTE_LOG_PAGE_BYTES) &&
+         file.read((uint8_t *)&page, sizeof(page)) == sizeof(page);
+}
+
+static void startWriter();
+
+void routeLogBegin(fs::FS *fs)
+{
+  logFs = fs;
+  counters = {};
+  lastValid = false;
+  memset(&batch, 0, sizeof(batch));
+  queued.store(0, std::memory_order_relaxed);
+  taken.store(0, std::memory_order_relaxed);
+  reopen.store(false, std::memory_order_relaxed);
+  segment = ROUTE_LOG_SEGMENTS - 1; // with no log the first page opens segment 0
+  segmentLeft = 0;
+  appending = false;
+  nextSequence = 0;
+  if (logFs == nullptr)
+  {
+    return;
+  }
+
+  // The newest valid page of all segments is where the log goes on. Only
+  // the last page of a segment can be torn, so the rest are not read.
+  bool found = false;
+  uint32_t newest = 0;
+  for (uint8_t i = 0; i < ROUTE_LOG_SEGMENTS; i++)
+  {
+    char path[16];
+    segmentPath(path, sizeof(path), i);
+    File file = logFs->open(path, FILE_READ);
+    if (!file)
+    {
+      continue;
+    }
+    uint32_t pages = file.size() / ROUTE_LOG_PAGE_BYTES;
+    bool clean = file.size() % ROUTE_LOG_PAGE_BYTES == 0;
+    RouteLogPage page;
+    uint32_t p = pages;
+    for (; p > 0 && !(readPage(file, p - 1, page) && pageValid(page)); p--)
+    {
+      counters.damaged++;
+      clean = false;
+    }
+    file.close();
+    counters.stored += p;
+    if (p > 0 && (!found || (int32_t)(page.sequence - newest) > 0))
+    {
+      found = true;
+      newest = page.sequence;
+      segment = i;
+      // Appending after a tear would leave the segment misaligned
+      segmentLeft = clean && pages < ROUTE_LOG_SEGMENT_PAGES ? ROUTE_LOG_SEGMENT_PAGES - pages : 0;
+    }
+  }
+  if (found)
+  {
+    nextSequence = newest + 1;
+    appending = segmentLeft > 0;
+  }
+  startWriter();
+}
+
+//////////////////////
+// Encoding (loop)
+//////////////////////
+static size_t putVarint(uint8_t *out, uint32_t value)
+{
+  size_t n = 0;
+  while (value >= 0x80)
+  {
+    out[n++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+// Length-prefixed copy of a text that changed; updates the known state
+static size_t putText(uint8_t *out, uint8_t &mask, uint8_t bit, char *known, const char *text, size_t max)
+{
+  size_t len = strnlen(text, max);
+  if (lastValid && strlen(known) == len && memcmp(known, text, len) == 0)
+  {
+    return 0;
+  }
+  memcpy(known, text, len);
+  known[len] = '\0';
+  mask |= bit;
+  out[0] = (uint8_t)len;
+  memcpy(out + 1, text, len);
+  return len + 1;
+}
+
+// Hand the batch to the writer and start an empty one
+static void sealPage()
+{
+  if (batch.length == 0)
+  {
+    return;
+  }
+  uint32_t pos = queued.load(std::memory_order_relaxed);
+  if (pos - taken.load(std::memory_order_acquire) >= ROUTE_LOG_QUEUE)
+  {
+    // Writer behind (or no flash): the page is lost, so the next record
+    // repeats every field rather than leave the reader a stale state
+    counters.dropped++;
+    lastValid = false;
+  }
+  else
+  {
+    bool opens = segmentLeft == 0;
+    segmentLeft = (opens ? ROUTE_LOG_SEGMENT_PAGES : segmentLeft) - 1;
+    memcpy(&queue[pos % ROUTE_LOG_QUEUE], &batch, sizeof(batch));
+    queueOpens[pos % ROUTE_LOG_QUEUE] = opens;
+    queued.store(pos + 1, std::memory_order_release);
+    counters.sealed++;
+  }
+  if (reopen.exchange(false, std::memory_order_acquire))
+  {
+    segmentLeft = 0;
+  }
+  if (segmentLeft == 0)
+  {
+    lastValid = false; // the next page opens a segment: it starts with every field
+  }
+  memset(&batch, 0, sizeof(batch));
+}
+
+void routeLogRecord(const NavSnapshot &nav, unsigned long now)
+{
+  if (logFs == nullptr)
+  {
+    return;
+  }
+
+  // A part-filled page goes out once it is old; a page lost on the way
+  // makes this record a full one
+  if (batch.length > 0 && now - batch.ms >= ROUTE_LOG_FLUSH_MS)
+  {
+    sealPage();
+  }
+
+  uint8_t fields[ROUTE_LOG_RECORD_MAX];
+  uint8_t mask = 0;
+  size_t size = 0;
+  uint8_t flags = (nav.connected ? 1 : 0) | (nav.active ? 2 : 0) | (nav.isNavigation ? 4 : 0) |
+                  (nav.hasIcon ? 8 : 0);
+  if (!lastValid || flags != last.flags)
+  {
+    last.flags = flags;
+    mask |= ROUTE_FIELD_FLAGS;
+    fields[size++] = flags;
+  }
+  size += putText(fields + size, mask, ROUTE_FIELD_TITLE, last.title, nav.title, NAV_TEXT_SHORT - 1);
+  size += putText(fields + size, mask, ROUTE_FIELD_DISTANCE, last.distance, nav.distance, NAV_TEXT_SHORT - 1);
+  size += putText(fields + size, mask, ROUTE_FIELD_ETA, last.eta, nav.eta, NAV_TEXT_SHORT - 1);
+  size += putText(fields + size, mask, ROUTE_FIELD_DURATION, last.duration, nav.duration, NAV_TEXT_SHORT - 1);
+  size += putText(fields + size, mask, ROUTE_FIELD_SPEED, last.speed, nav.speed, NAV_TEXT_SHORT - 1);
+  size += putText(fields + size, mask, ROUTE_FIELD_DIRECTIONS, last.directions, nav.directions,
+                  ROUTE_LOG_DIRECTIONS_MAX);
+  uint32_t icon = nav.hasIcon ? fnv1a(FNV1A_SEED, nav.icon, NAV_ICON_BYTES) : 0;
+  if (!lastValid || icon != last.icon)
+  {
+    last.icon = icon;
+    mask |= ROUTE_FIELD_ICON;
+    memcpy(fields + size, &icon, sizeof(icon));
+    size += sizeof(icon);
+  }
+  lastValid = true;
+  if (mask == 0)
+  {
+    return; // the clock or the page changed, nothing the log keeps
+  }
+
+  uint8_t head[6];
+  size_t headSize = putVarint(head, batch.length == 0 ? 0 : (uint32_t)(now - lastRecordMs));
+  if (batch.length + headSize + 1 + size > ROUTE_LOG_PAYLOAD)
+  {
+    sealPage();
+    if (!lastValid)
+    {
+      routeLogRecord(nav, now); // dropped or a new segment: start the page with every field
+      return;
+    }
+    headSize = putVarint(head, 0);
+  }
+  if (batch.length == 0)
+  {
+    batch.ms = now;
+    time_t clock = time(nullptr);
+    batch.epoch = clock > TIME_VALID_EPOCH ? (uint32_t)clock : 0;
+  }
+  head[headSize++] = mask;
+  memcpy(batch.records + batch.length, head, headSize);
+  memcpy(batch.records + batch.length + headSize, fields, size);
+  batch.length += headSize + size;
+  lastRecordMs = now;
+  counters.records++;
+}
+
+//////////////////////
+// Writer (task)
+//////////////////////
+static void appendPage(RouteLogPage &page, bool opens)
+{
+  char path[16];
+  if (opens)
+  {
+    // Next file in the ring; it holds the oldest pages
+    segment = (segment + 1) % ROUTE_LOG_SEGMENTS;
+    appending = true;
+    segmentPath(path, sizeof(path), segment);
+    logFs->remove(path);
+  }
+  else if (!appending)
+  {
+    counters.errors++; // its segment is broken and the next one opens with a full record
+    return;
+  }
+  segmentPath(path, sizeof(path), segment);
+
+  page.magic = ROUTE_LOG_MAGIC;
+  page.sequence = nextSequence++;
+  page.crc = pageCrc(page);
+  uint32_t start = micros();
+  File file = logFs->open(path, FILE_APPEND);
+  size_t done = file ? file.write((const uint8_t *)&page, sizeof(page)) : 0;
+  file.close();
+  counters.maxWriteUs = max(counters.maxWriteUs, (uint32_t)(micros() - start));
+  if (done != sizeof(page))
+  {
+    counters.errors++;
+    appending = false; // never append after a short write
+    reopen.store(true, std::memory_order_release);
+    return;
+  }
+  counters.written++;
+}
+
+static void printRecords(Print &out, const RouteLogPage &page)
+{
+  static const char *const names[] = {"title", "distance", "eta", "duration", "speed", "directions"};
+  uint32_t ms = page.ms;
+  size_t pos = 0;
+  while (pos < page.length)
+  {
+    uint32_t delta = 0;
+    for (uint8_t shift = 0; pos < page.length && shift < 35; shift += 7)
+    {
+      uint8_t b = page.records[pos++];
+      delta |= (uint32_t)(b & 0x7F) << shift;
+      if ((b & 0x80) == 0)
+      {
+        break;
+      }
+    }
+    ms += delta;
+    if (pos >= page.length)
+    {
+      return;
+    }
+    uint8_t mask = page.records[pos++];
+
+    if (page.epoch != 0)
+    {
+      time_t when = page.epoch + (ms - page.ms) / 1000;
+      struct tm local;
+      localtime_r(&when, &local);
+      out.printf("%02d:%02d:%02d", local.tm_hour, local.tm_min, local.tm_sec);
+    }
+    else
+    {
+      out.printf("+%lums", (unsigned long)ms);
+    }
+
+    if ((mask & ROUTE_FIELD_FLAGS) && pos < page.length)
+    {
+      out.printf(" flags=%u", page.records[pos++]);
+    }
+    for (uint8_t i = 0; i < 6; i++)
+    {
+      if ((mask & (ROUTE_FIELD_TITLE << i)) == 0 || pos >= page.length)
+      {
+        continue;
+      }
+      uint8_t len = min((size_t)page.records[pos], page.length - pos - 1);
+      out.printf(" %s=\"%.*s\"", names[i], (int)len, (const char *)page.records + pos + 1);
+      pos += len + 1;
+    }
+    if ((mask & ROUTE_FIELD_ICON) && pos + 4 <= page.length)
+    {
+      uint32_t icon;
+      memcpy(&icon, page.records + pos, sizeof(icon));
+      out.printf(" icon=%08lx", (unsigned long)icon);
+      pos += sizeof(icon);
+    }
+    out.println();
+  }
+}
+
+// Every segment in the order written, each page decoded to text
+static void dumpLog(Print &out)
+{
+  uint8_t order[ROUTE_LOG_SEGMENTS];
+  uint32_t first[ROUTE_LOG_SEGMENTS];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < ROUTE_LOG_SEGMENTS; i++)
+  {
+    char path[16];
+    segmentPath(path, sizeof(path), i);
+    File file = logFs->open(path, FILE_READ);
+    RouteLogPage page;
+    for (uint32_t p = 0; file && readPage(file, p, page); p++)
+    {
+      if (pageValid(page))
+      {
+        // Insertion sort on the first sequence number
+        uint8_t at = count++;
+        for (; at > 0 && (int32_t)(first[at - 1] - page.sequence) > 0; at--)
+        {
+          order[at] = order[at - 1];
+          first[at] = first[at - 1];
+        }
+        order[at] = i;
+        first[at] = page.sequence;
+        break;
+      }
+    }
+    file.close();
+  }
+
+  uint32_t pages = 0;
+  uint32_t damaged = 0;
+  out.println("=== Route log ===");
+  for (uint8_t s = 0; s < count; s++)
+  {
+    char path[16];
+    segmentPath(path, sizeof(path), order[s]);
+    File file = logFs->open(path, FILE_READ);
+    RouteLogPage page;
+    for (uint32_t p = 0; readPage(file, p, page); p++)
+    {
+      if (!pageValid(page))
+      {
+        damaged++;
+        continue;
+      }
+      pages++;
+      printRecords(out, page);
+    }
+    file.close();
+  }
+  out.printf("=== %lu pages, %lu damaged ===\n", (unsigned long)pages, (unsigned long)damaged);
+}
+
+// Write the oldest sealed page or, once all are written, any dump asked
+// for; false if another caller is already at it
+static bool routeLogWrite()
+{
+  if (writing.exchange(true, std::memory_order_acquire))
+  {
+    return false;
+  }
+  uint32_t pos = taken.load(std::memory_order_relaxed);
+  if (pos != queued.load(std::memory_order_acquire))
+  {
+    appendPage(queue[pos % ROUTE_LOG_QUEUE], queueOpens[pos % ROUTE_LOG_QUEUE]);
+    taken.store(pos + 1, std::memory_order_release);
+  }
+  else
+  {
+    Print *out = dumpTo.exchange(nullptr, std::memory_order_acquire);
+    if (out != nullptr)
+    {
+      dumpLog(*out);
+    }
+  }
+  writing.store(false, std::memory_order_release);
+  return true;
+}
+
+void routeLogFlush()
+{
+  if (logFs == nullptr)
+  {
+    return;
+  }
+  sealPage();
+  while (taken.load(std::memory_order_acquire) != queued.load(std::memory_order_relaxed))
+  {
+    if (!routeLogWrite())
+    {
+      delay(1); // The task is writing
+    }
+  }
+}
+
+void routeLogDump(Print &out)
+{
+  if (logFs == nullptr)
+  {
+    out.println("Route log: no flash");
+    return;
+  }
+  sealPage(); // so the dump ends at the latest change
+  dumpTo.store(&out, std::memory_order_release);
+#if !ROUTE_LOG_TASK
+  while (dumpTo.load(std::memory_order_acquire) != nullptr)
+  {
+    routeLogWrite();
+  }
+#endif
+}
+
+const RouteLogStats &routeLogStats()
+{
+  return counters;
+}
+
+#if ROUTE_LOG_TASK
+
+static void routeLogTaskMain(void *)
+{
+  for (;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(ROUTE_LOG_WRITE_PERIOD));
+    routeLogWrite();
+  }
+}
+
+static void startWriter()
+{
+  xTaskCreate(routeLogTaskMain, "routelog", ROUTE_LOG_TASK_STACK, nullptr, ROUTE_LOG_TASK_PRIORITY, nullptr);
+}
+
+#else
+
+static void startWriter() {}
+
+#endif
+
+void routeLogService()
+{
+  if (logFs == nullptr)
+  {
+    return;
+  }
+  if (batch.length > 0 && millis() - batch.ms >= ROUTE_LOG_FLUSH_MS)
+  {
+    sealPage();
+  }
+#if !ROUTE_LOG_TASK
+  if (taken.load(std::memory_order_relaxed) != queued.load(std::memory_order_acquire))
+  {
+    routeLogWrite();
+  }
+#endif
+}
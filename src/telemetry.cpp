@@ -0,0 +1,172 @@
+#include "telemetry.h"
+
+// Bounded MPSC ring (Vyukov): each slot carries a sequence number telling
+// producers when it is free and the consumer when it is filled. Producers
+// claim a slot with one CAS on head and never wait; a full ring drops the
+// record and counts it.
+struct TelemetrySlot
+{
+  std::atomic<uint32_t> seq;
+  TelemetryRecord record;
+};
+
+static TelemetrySlot slots[TELEMETRY_RING_SIZE];
+static std::atomic<uint32_t> head{0};
+static std::atomic<uint32_t> tail{0}; // advanced by whoever holds draining
+static std::atomic<bool> draining{false};
+static std::atomic<uint32_t> loggedCount{0};
+static std::atomic<uint32_t> droppedCount{0};
+static uint32_t drainedCount = 0;
+static uint32_t droppedReported = 0;
+
+static_assert((TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1)) == 0, "ring size must be a power of two");
+
+static void ringInit()
+{
+  for (uint32_t i = 0; i < TELEMETRY_RING_SIZE; i++)
+  {
+    slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+  head.store(0, std::memory_order_relaxed);
+  tail.store(0, std::memory_order_relaxed);
+}
+
+void telemetryLog(uint8_t level, TelemetryEvent event, uint16_t a, uint32_t b, uint32_t c)
+{
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    TelemetrySlot &slot = slots[pos & (TELEMETRY_RING_SIZE - 1)];
+    int32_t diff = (int32_t)(slot.seq.load(std::memory_order_acquire) - pos);
+    if (diff == 0)
+    {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        slot.record = {(uint32_t)micros(), event, level, a, b, c};
+        slot.seq.store(pos + 1, std::memory_order_release);
+        loggedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    else if (diff < 0)
+    {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    else
+    {
+      pos = head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void telemetryText(uint8_t level, TelemetryTextField field, const char *text)
+{
+  size_t length = strlen(text);
+  for (size_t offset = 0; offset <= length; offset += 8)
+  {
+    uint32_t words[2] = {0, 0};
+    memcpy(words, text + offset, min(length - offset, (size_t)8));
+    telemetryLog(level, TEL_NAV_TEXT, (uint16_t)(field << 8 | min(offset, (size_t)0xFF)), words[0], words[1]);
+  }
+}
+
+uint32_t telemetryDrain(Print &out, uint32_t max)
+{
+  // Single consumer: the drain task, loop(), or the flush before sleep
+  if (draining.exchange(true, std::memory_order_acquire))
+  {
+    return 0;
+  }
+
+  uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+  if (dropped != droppedReported)
+  {
+    TEL_ERROR(TEL_DROPPED, 0, dropped - droppedReported, 0);
+    droppedReported = dropped;
+  }
+
+  uint32_t count = 0;
+  uint32_t pos = tail.load(std::memory_order_relaxed);
+  while (count < max)
+  {
+    TelemetrySlot &slot = slots[pos & (TELEMETRY_RING_SIZE - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+    {
+      break;
+    }
+
+    uint8_t frame[2 + sizeof(TelemetryRecord) + 1];
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    memcpy(frame + 2, &slot.record, sizeof(TelemetryRecord));
+    slot.seq.store(pos + TELEMETRY_RING_SIZE, std::memory_order_release);
+    pos++;
+
+    uint8_t sum = 0;
+    for (size_t i = 2; i < 2 + sizeof(TelemetryRecord); i++)
+    {
+      sum += frame[i];
+    }
+    frame[sizeof(frame) - 1] = sum;
+    out.write(frame, sizeof(frame));
+    count++;
+  }
+  tail.store(pos, std::memory_order_relaxed);
+  drainedCount += count;
+  draining.store(false, std::memory_order_release);
+  return count;
+}
+
+void telemetryFlush(Print &out)
+{
+  while (tail.load(std::memory_order_relaxed) != head.load(std::memory_order_acquire))
+  {
+    if (telemetryDrain(out, TELEMETRY_RING_SIZE) == 0)
+    {
+      delay(1); // The drain task has the ring, or a producer is mid-write
+    }
+  }
+}
+
+TelemetryStats telemetryStats()
+{
+  return {loggedCount.load(std::memory_order_relaxed), droppedCount.load(std::memory_order_relaxed), drainedCount};
+}
+
+#if TELEMETRY_TASK
+
+static void telemetryTaskMain(void *)
+{
+  for (;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(TELEMETRY_DRAIN_PERIOD));
+    while (telemetryDrain(Serial, TELEMETRY_DRAIN_BATCH) == TELEMETRY_DRAIN_BATCH)
+    {
+    }
+  }
+}
+
+void telemetryBegin()
+{
+  ringInit();
+  xTaskCreate(telemetryTaskMain, "telemetry", TELEMETRY_TASK_STACK, nullptr, TELEMETRY_TASK_PRIORITY, nullptr);
+}
+
+void telemetryService() {}
+
+#else
+
+void telemetryBegin() { ringInit(); }
+
+void telemetryService()
+{
+  static unsigned long lastDrain = 0;
+  if (millis() - lastDrain >= TELEMETRY_DRAIN_PERIOD)
+  {
+    lastDrain = millis();
+    telemetryDrain(Serial, TELEMETRY_DRAIN_BATCH);
+  }
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "text_fit.h"
+
+uint16_t textWidth(const char *text, size_t length, uint8_t size)
+{
+  uint16_t width = 0;
+  for (size_t i = 0; i < length; i++)
+  {
+    width += textAdvance(text[i]);
+  }
+  return length == 0 ? 0 : (width - TEXT_GLYPH_GAP) * size;
+}
+
+TextLine textWrap(const char *text, int16_t maxWidth, uint8_t size, bool lastLine)
+{
+  const int16_t ellipsisWidth = textAdvanceOf(TEXT_ELLIPSIS) * size;
+  int16_t x = 0;          // advance so far
+  size_t fit = 0;         // characters whose ink fits
+  size_t fitEllipsis = 0; // ... with room left for the ellipsis
+  size_t wordEnd = 0;     // end of the last whole word that fits
+  size_t i = 0;
+
+  for (; text[i] != '\0'; i++)
+  {
+    char c = text[i];
+    int16_t ink = (textGlyph(c) & 0x0F) * size;
+    if (x + ink > maxWidth)
+    {
+      break;
+    }
+    if (c == ' ' && (i == 0 || text[i - 1] != ' '))
+    {
+      wordEnd = i;
+    }
+    x += textAdvance(c) * size;
+    fit = i + 1;
+    if (x + ellipsisWidth - TEXT_GLYPH_GAP * size <= maxWidth)
+    {
+      fitEllipsis = fit;
+    }
+  }
+
+  TextLine line = {fit, fit, false};
+  if (text[i] == '\0')
+  {
+    return line; // All of it fits
+  }
+
+  if (lastLine)
+  {
+    line.length = fitEllipsis;
+    while (line.length > 0 && text[line.length - 1] == ' ')
+    {
+      line.length--;
+    }
+    line.next = i;
+    line.ellipsis = true;
+    return line;
+  }
+
+  // Break at a word boundary: the space that stopped us, or the last one
+  if (text[i] == ' ')
+  {
+    wordEnd = i;
+  }
+  if (wordEnd > 0)
+  {
+    line.length = wordEnd;
+    line.next = wordEnd;
+  }
+  while (text[line.next] == ' ')
+  {
+    line.next++;
+  }
+  return line;
+}
+
+int16_t textDraw(Adafruit_GFX &gfx, int16_t x, int16_t y, const char *text, size_t length, uint8_t size,
+                 uint16_t color)
+{
+  for (size_t i = 0; i < length; i++)
+  {
+    uint8_t glyph = textGlyph(text[i]);
+    if (text[i] != ' ')
+    {
+      gfx.drawChar(x - (glyph >> 4) * size, y, text[i], color, color, size);
+    }
+    x += ((glyph & 0x0F) + TEXT_GLYPH_GAP) * size;
+  }
+  return x;
+}
+
+size_t textBox(Adafruit_GFX &gfx, int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint8_t size,
+               uint16_t color, bool ellipsis)
+{
+  const int16_t lineHeight = TEXT_LINE_HEIGHT * size;
+  size_t offset = 0;
+  for (int16_t top = y; top + lineHeight <= y + h && text[offset] != '\0'; top += lineHeight)
+  {
+    bool lastLine = ellipsis && top + 2 * lineHeight > y + h;
+    TextLine line = textWrap(text + offset, w, size, lastLine);
+    int16_t end = textDraw(gfx, x, top, text + offset, line.length, size, color);
+    if (line.ellipsis)
+    {
+      textDraw(gfx, end, top, TEXT_ELLIPSIS, 3, size, color);
+    }
+    offset += line.next;
+  }
+  return offset;
+}
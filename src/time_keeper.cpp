@@ -0,0 +1,107 @@
+#include "time_keeper.h"
+#include <time.h>
+#include <sys/time.h>
+#include <Preferences.h>
+#include <esp_private/esp_clk.h>
+#include "profiler.h"
+
+#define RTC_TIME_MAGIC 0x54494D45 // "TIME"
+
+struct RtcTimeState
+{
+  uint32_t magic;
+  uint32_t lastNvsWrite; // epoch seconds of the last NVS copy
+  int64_t epochUs;       // wall clock when going to sleep
+  uint64_t rtcUs;        // RTC timer at the same moment
+};
+
+RTC_DATA_ATTR static RtcTimeState rtcState;
+
+static TimeKeeperStats counters = {};
+static Preferences preferences;
+
+static int64_t wallClockUs()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void setWallClockUs(int64_t us)
+{
+  struct timeval tv;
+  tv.tv_sec = us / 1000000;
+  tv.tv_usec = us % 1000000;
+  settimeofday(&tv, NULL);
+}
+
+void saveCurrentTime()
+{
+  PROF_SCOPE(PROF_SAVE_TIME);
+  time_t now;
+  time(&now);
+  if (now > TIME_VALID_EPOCH)
+  {
+    preferences.begin("esp32time", false);
+    preferences.putULong64("savedTime", (uint64_t)now);
+    preferences.end();
+    rtcState.lastNvsWrite = (uint32_t)now;
+    counters.nvsWrites++;
+  }
+}
+
+void timeKeeperBegin(bool wokeFromDeepSleep)
+{
+  counters = {};
+  if (rtcState.magic != RTC_TIME_MAGIC)
+  {
+    rtcState = {RTC_TIME_MAGIC, 0, 0, 0};
+  }
+
+  if (wokeFromDeepSleep && rtcState.epochUs > 0)
+  {
+    uint64_t slept = esp_clk_rtc_time() - rtcState.rtcUs;
+    setWallClockUs(rtcState.epochUs + (int64_t)slept);
+    rtcState.epochUs = 0; // Consumed; a later reset must not reuse it
+    counters.source = TIME_FROM_RTC;
+    counters.sleptMs = slept / 1000;
+    return;
+  }
+
+  if (time(nullptr) > TIME_VALID_EPOCH)
+  {
+    return; // Already running (soft reset keeps the system clock)
+  }
+
+  preferences.begin("esp32time", true);
+  uint64_t savedTime = preferences.getULong64("savedTime", 0);
+  preferences.end();
+
+  if (savedTime > 0)
+  {
+    setWallClockUs((int64_t)savedTime * 1000000);
+    rtcState.lastNvsWrite = (uint32_t)savedTime;
+    counters.source = TIME_FROM_NVS;
+  }
+}
+
+void timeKeeperService()
+{
+  time_t now = time(nullptr);
+  if (now > TIME_VALID_EPOCH && (uint32_t)now - rtcState.lastNvsWrite >= TIME_NVS_INTERVAL)
+  {
+    saveCurrentTime();
+  }
+}
+
+void timeKeeperBeforeSleep()
+{
+  rtcState.magic = RTC_TIME_MAGIC;
+  rtcState.epochUs = wallClockUs();
+  rtcState.rtcUs = esp_clk_rtc_time();
+  // Flash only when the last copy is old; a battery pull during sleep then
+  // loses at most TIME_NVS_INTERVAL
+  timeKeeperService();
+}
+
+const TimeKeeperStats &timeKeeperStats() { return counters; }
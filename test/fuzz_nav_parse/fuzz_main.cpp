@@ -0,0 +1,126 @@
+// libFuzzer target for the navigation text parsers (nav_parse.h). The
+// phone controls these strings, so every input must come back as a clean
+// false or a value that survives a print/parse round trip.
+//
+//   clang++ -g -O1 -fsanitize=fuzzer,address,undefined -Iinclude
+//       -Itest/native/fakes test/fuzz_nav_parse/fuzz_main.cpp src/nav_parse.cpp
+//       -o fuzz_nav_parse
+//   ./fuzz_nav_parse -max_len=32
+//
+// Without clang, -DNAV_FUZZ_STANDALONE builds a plain driver (g++ with
+// -fsanitize=address,undefined works) that replays built-in seeds and any
+// files given on the command line, then a few million random mutations of
+// them. Not a PlatformIO test: the test_* filter leaves this folder out.
+#include <stdio.h>
+#include <stdlib.h>
+#include "nav_parse.h"
+
+#define FUZZ_MAX_INPUT 64
+
+static void check(bool condition, const char *what, const char *input)
+{
+  if (!condition)
+  {
+    fprintf(stderr, "%s: \"%s\"\n", what, input);
+    abort();
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  // The firmware hands the parsers NUL-terminated NavSnapshot fields
+  char text[FUZZ_MAX_INPUT + 1];
+  size = size < FUZZ_MAX_INPUT ? size : FUZZ_MAX_INPUT;
+  memcpy(text, data, size);
+  text[size] = '\0';
+
+  NavDistance distance;
+  if (navParseDistance(text, distance))
+  {
+    char printed[FUZZ_MAX_INPUT];
+    int length = navFormatDistance(printed, sizeof(printed), distance, distance.mm);
+    check(length > 0 && length < (int)sizeof(printed), "distance print length", text);
+    NavDistance again;
+    check(navParseDistance(printed, again), "printed distance does not parse", text);
+    uint32_t step = navDistanceStep(distance, distance.mm);
+    uint32_t error = again.mm > distance.mm ? again.mm - distance.mm : distance.mm - again.mm;
+    check(error <= step, "distance round trip", text);
+  }
+
+  uint32_t speed;
+  navParseSpeed(text, speed);
+
+  uint16_t minute;
+  if (navParseClock(text, minute))
+  {
+    check(minute < 24 * 60, "clock out of range", text);
+  }
+
+  uint32_t seconds;
+  navParseDuration(text, seconds);
+  return 0;
+}
+
+#ifdef NAV_FUZZ_STANDALONE
+static const char *seeds[] = {"250m", "1.5 km", "2,4 km", "0.3 mi", "800 ft", "42 km/h", "26 mph",
+                              "10:45", "9:05 pm", "1 hr 5 min", "1h05m", "250\xC2\xA0m"};
+
+int main(int argc, char **argv)
+{
+  static uint8_t corpus[256][FUZZ_MAX_INPUT];
+  static size_t lengths[256];
+  size_t count = 0;
+  for (const char *seed : seeds)
+  {
+    lengths[count] = strlen(seed);
+    memcpy(corpus[count++], seed, strlen(seed));
+  }
+  for (int i = 1; i < argc && count < 256; i++)
+  {
+    FILE *file = fopen(argv[i], "rb");
+    if (file != nullptr)
+    {
+      lengths[count] = fread(corpus[count], 1, FUZZ_MAX_INPUT, file);
+      fclose(file);
+      LLVMFuzzerTestOneInput(corpus[count], lengths[count]);
+      count++;
+    }
+  }
+
+  // Byte flips, inserts and truncations of the corpus
+  static const char alphabet[] = "0123456789.,: kmKMifthyd/sdaprn\xC2\xA0\t-";
+  srand(1);
+  for (long run = 0; run < 4000000; run++)
+  {
+    uint8_t input[FUZZ_MAX_INPUT];
+    size_t pick = rand() % count;
+    size_t length = lengths[pick];
+    memcpy(input, corpus[pick], length);
+    for (int edits = 1 + rand() % 3; edits > 0 && length > 0; edits--)
+    {
+      size_t at = rand() % length;
+      char c = rand() % 4 == 0 ? (char)rand() : alphabet[rand() % (sizeof(alphabet) - 1)];
+      switch (rand() % 3)
+      {
+      case 0:
+        input[at] = c;
+        break;
+      case 1:
+        if (length < FUZZ_MAX_INPUT)
+        {
+          memmove(input + at + 1, input + at, length - at);
+          input[at] = c;
+          length++;
+        }
+        break;
+      default:
+        length = at;
+        break;
+      }
+    }
+    LLVMFuzzerTestOneInput(input, length);
+  }
+  printf("nav_parse fuzz: %zu seeds, 4000000 mutations, no failures\n", count);
+  return 0;
+}
+#endif
@@ -0,0 +1,144 @@
+// Host stand-in for the ESP32 Arduino core
+// Time, GPIO and deep sleep are simulated so the firmware logic can run on
+// Linux; see host.h for the knobs the test and benchmark code can turn.
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+#include <time.h>
+
+#include "WString.h"
+#include "Print.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define F(str) (str)
+#define IRAM_ATTR
+#define RTC_DATA_ATTR // Host globals already survive a simulated reboot
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x12
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define digitalPinToInterrupt(pin) (pin)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// Fired from hostSetPin() on a matching edge
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// System time follows the simulated clock instead of the host's
+int fakeGettimeofday(struct timeval *tv, void *tz);
+int fakeSettimeofday(const struct timeval *tv, const struct timezone *tz);
+time_t fakeTime(time_t *out);
+#define gettimeofday fakeGettimeofday
+#define settimeofday fakeSettimeofday
+#define time(out) fakeTime(out)
+
+//////////////////////
+// Sleep (esp_sleep.h)
+//////////////////////
+typedef enum
+{
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO,
+} esp_sleep_wakeup_cause_t;
+
+typedef enum
+{
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_21 = 21,
+  GPIO_NUM_22 = 22,
+} gpio_num_t;
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level);
+
+// Thrown instead of powering down; the host driver catches it
+struct HostDeepSleep
+{
+};
+[[noreturn]] void esp_deep_sleep_start();
+
+//////////////////////
+// Heap status (ESP.getFreeHeap() etc.)
+//////////////////////
+// Modelled as a fixed-size heap minus the bytes the program holds through
+// operator new; the host allocator is not fragmented the way the ESP32's is,
+// so the largest free block is reported as the whole free space.
+#define HOST_HEAP_SIZE 300000
+
+class EspClass
+{
+public:
+  uint32_t getHeapSize() { return HOST_HEAP_SIZE; }
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+
+  // CPU cycles at a nominal 240 MHz (or hostSetCpuFreqMHz()), from the
+  // host's real monotonic clock so code timed with it is measured for real
+  // (unlike micros())
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz();
+};
+
+extern EspClass ESP;
+
+//////////////////////
+// Serial
+//////////////////////
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available();
+  int read();
+  void flush() {}
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,82 @@
+// Host stand-in for ChronosESP32
+// Navigation and connection state are injected by the host code instead of
+// arriving over BLE; callbacks fire the same way the library fires them.
+#ifndef FAKE_CHRONOSESP32_H
+#define FAKE_CHRONOSESP32_H
+
+#include <Arduino.h>
+
+struct Navigation
+{
+  bool active;       // whether running or not
+  bool isNavigation; // whether navigation or just data
+  bool hasIcon;      // whether the icon is present
+  String distance;   // distance to destination
+  String duration;   // time to destination
+  String eta;        // estimated time of arrival
+  String title;      // distance to next point or title
+  String directions; // place info ie current street name/ instructions
+  String speed;      // speed/ duration
+  uint32_t iconCRC;  // to identify whether the icon has changed
+  uint8_t icon[288]; // navigation icon 48x48 (only black and white)
+};
+
+enum Config
+{
+  CF_TIME = 0,
+  CF_RTW,
+  CF_HR24,
+  CF_LANG,
+  CF_RST,
+  CF_CIRCLE,
+  CF_PBAT,
+  CF_APP,
+  CF_QR,
+  CF_FONT,
+  CF_CAMERA,
+  CF_NAV_DATA,
+  CF_NAV_ICON,
+  CF_CONTACT,
+  CF_SOS,
+};
+
+class ChronosESP32
+{
+public:
+  explicit ChronosESP32(String name) : name(name) {}
+
+  void begin() { started = true; }
+  void loop() { loopCount++; }
+  bool isConnected() const { return connected; }
+  Navigation getNavigation() { return navigation; }
+  String getAppVersion() const { return appVersion; }
+
+  // ESP32Time-style clock accessors, backed by the system time
+  int getHour(bool mode = false);
+  int getHourC() { return getHour(true); }
+  String getHourZ();
+  int getMinute();
+  int getSecond();
+  unsigned long getEpoch();
+
+  void setConnectionCallback(void (*callback)(bool)) { connectionCallback = callback; }
+  void setConfigurationCallback(void (*callback)(Config, uint32_t, uint32_t)) { configurationCallback = callback; }
+
+  // Host controls
+  void hostSetConnected(bool state);
+  void hostSetNavigation(const Navigation &nav);
+  void hostSetIcon(const uint8_t *icon, uint32_t crc);
+  uint32_t hostLoopCount() const { return loopCount; }
+
+private:
+  String name;
+  String appVersion = "3.8.2";
+  bool started = false;
+  bool connected = false;
+  uint32_t loopCount = 0;
+  Navigation navigation = {};
+  void (*connectionCallback)(bool) = nullptr;
+  void (*configurationCallback)(Config, uint32_t, uint32_t) = nullptr;
+};
+
+#endif
@@ -0,0 +1,52 @@
+// Host stand-in for the Arduino-ESP32 FS / File API, backed by memory
+#ifndef FAKE_FS_H
+#define FAKE_FS_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+class File
+{
+public:
+  File() {}
+  File(std::vector<uint8_t> *data, bool writable) : data(data), writable(writable) {}
+
+  size_t read(uint8_t *buf, size_t size);
+  size_t write(const uint8_t *buf, size_t size);
+  size_t size() const { return data ? data->size() : 0; }
+  bool seek(uint32_t pos);
+  size_t position() const { return pos; }
+  void close() { data = nullptr; }
+  explicit operator bool() const { return data != nullptr; }
+
+private:
+  std::vector<uint8_t> *data = nullptr;
+  bool writable = false;
+  size_t pos = 0;
+};
+
+class FS
+{
+public:
+  File open(const char *path, const char *mode = FILE_READ);
+  bool exists(const char *path);
+  bool remove(const char *path);
+
+  // Host controls
+  static uint32_t hostWriteBytes();
+  static void hostReset();
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,52 @@
+// Host stand-in for LiquidCrystal_I2C (PCF8574 backpack, 4-bit mode)
+// Emits the same one-byte-per-transaction expander writes as the library.
+#ifndef FAKE_LIQUIDCRYSTAL_I2C_H
+#define FAKE_LIQUIDCRYSTAL_I2C_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define LCD_CLEARDISPLAY 0x01
+#define LCD_RETURNHOME 0x02
+#define LCD_ENTRYMODESET 0x04
+#define LCD_DISPLAYCONTROL 0x08
+#define LCD_FUNCTIONSET 0x20
+#define LCD_SETDDRAMADDR 0x80
+
+#define LCD_BACKLIGHT 0x08
+#define LCD_NOBACKLIGHT 0x00
+
+#define En 0x04 // Enable bit
+#define Rw 0x02 // Read/Write bit
+#define Rs 0x01 // Register select bit
+
+#define POSITIVE 1
+#define NEGATIVE 0
+
+class LiquidCrystal_I2C : public Print
+{
+public:
+  LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows);
+
+  void init();
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  void backlight();
+  void noBacklight();
+  void command(uint8_t value) { send(value, 0); }
+  size_t write(uint8_t value) override;
+  using Print::write;
+
+private:
+  void send(uint8_t value, uint8_t mode);
+  void write4bits(uint8_t value);
+  void expanderWrite(uint8_t data);
+
+  uint8_t addr;
+  uint8_t cols;
+  uint8_t rows;
+  uint8_t backlightval = LCD_NOBACKLIGHT;
+};
+
+#endif
@@ -0,0 +1,27 @@
+// Host stand-in for the ESP32 Preferences (NVS) library, kept in memory
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end();
+  size_t putULong64(const char *key, uint64_t value);
+  uint64_t getULong64(const char *key, uint64_t defaultValue = 0);
+  bool remove(const char *key);
+  bool clear();
+
+  // Host controls
+  static uint32_t hostWriteCount();
+  static void hostReset();
+
+private:
+  char ns[16] = "";
+  bool readOnly = true;
+  bool opened = false;
+};
+
+#endif
@@ -0,0 +1,16 @@
+// Host stand-in for the SPIFFS filesystem on the spiffs partition
+#ifndef FAKE_SPIFFS_H
+#define FAKE_SPIFFS_H
+
+#include <FS.h>
+
+class SPIFFSFS : public fs::FS
+{
+public:
+  bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+  void end() {}
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif
@@ -0,0 +1,63 @@
+// Host stand-in for the Arduino String class
+// Heap-backed like the real one so allocation counts stay meaningful.
+#ifndef FAKE_WSTRING_H
+#define FAKE_WSTRING_H
+
+#include <cstddef>
+#include <cstdint>
+
+class String
+{
+public:
+  String(const char *cstr = "");
+  String(const String &other);
+  String(String &&other) noexcept;
+  explicit String(char c);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimals = 2);
+  explicit String(double value, unsigned char decimals = 2);
+  ~String();
+
+  String &operator=(const String &other);
+  String &operator=(String &&other) noexcept;
+  String &operator=(const char *cstr);
+
+  String &operator+=(const String &other) { return concat(other.buf, other.len); }
+  String &operator+=(const char *cstr);
+  String &operator+=(char c) { return concat(&c, 1); }
+
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  const char *c_str() const { return buf; }
+  char charAt(unsigned int index) const { return index < len ? buf[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  String substring(unsigned int from) const { return substring(from, len); }
+  String substring(unsigned int from, unsigned int to) const;
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const char *s, unsigned int from = 0) const;
+  long toInt() const;
+  float toFloat() const;
+
+  bool equals(const char *cstr) const;
+  bool operator==(const String &other) const { return equals(other.buf); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &other) const { return !equals(other.buf); }
+  bool operator!=(const char *cstr) const { return !equals(cstr); }
+
+  friend String operator+(const String &lhs, const String &rhs);
+  friend String operator+(const String &lhs, const char *rhs);
+  friend String operator+(const char *lhs, const String &rhs);
+
+private:
+  String &concat(const char *s, size_t n);
+  void assign(const char *s, size_t n);
+
+  char *buf;
+  unsigned int len;
+};
+
+#endif
@@ -0,0 +1,74 @@
+// Host stand-in for the ESP32 TwoWire driver
+// Transactions are delivered to simulated devices attached by address and
+// counted, so bus traffic per frame can be measured without hardware.
+#ifndef FAKE_WIRE_H
+#define FAKE_WIRE_H
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+class FakeI2cDevice
+{
+public:
+  virtual ~FakeI2cDevice() {}
+  // One complete write transaction (without the address byte)
+  virtual void onWrite(const uint8_t *data, size_t len) = 0;
+  virtual uint8_t onRead() { return 0xFF; }
+
+  // Above this bus clock transfers fail (NACK, corrupted reads)
+  uint32_t maxClock = 400000;
+};
+
+struct WireStats
+{
+  uint32_t transactions; // START..STOP sequences, reads included
+  uint32_t bytes;        // bytes clocked on the bus, address bytes included
+  uint64_t busTimeUs;    // time those bytes take at the configured clock
+};
+
+class TwoWire
+{
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end() { return true; }
+  void setClock(uint32_t frequency) { clock = frequency; }
+  uint32_t getClock() const { return clock; }
+
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t *data, size_t len);
+  uint8_t endTransmission(bool sendStop = true);
+
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+  int available() { return pendingRead; }
+  int read();
+
+  // Host controls
+  void attach(uint8_t address, FakeI2cDevice *device);
+  void detachAll();
+  // The next transactions with payload NACK halfway through it, after the
+  // device took the first half (endTransmission() returns 2, as for a
+  // NACK on the address)
+  void nackData(uint8_t transactions) { dataNacks = transactions; }
+  const WireStats &stats() const { return counters; }
+  void resetStats() { counters = {}; }
+
+private:
+  void account(size_t bytes);
+
+  FakeI2cDevice *devices[128] = {};
+  uint8_t txAddress = 0;
+  uint8_t txBuffer[I2C_BUFFER_LENGTH];
+  size_t txLength = 0;
+  int sdaPin = -1; // transfers fail while this pin reads low
+  uint8_t dataNacks = 0;
+  uint8_t rxAddress = 0;
+  int pendingRead = 0;
+  uint32_t clock = 100000;
+  WireStats counters = {};
+};
+
+extern TwoWire Wire;
+
+#endif
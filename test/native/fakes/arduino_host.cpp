@@ -0,0 +1,559 @@
+// Simulated board: clock, GPIO, sleep, Serial, String, Print and heap hooks
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+#include <malloc.h>
+#include <string>
+#include "host.h"
+#include "esp_private/esp_clk.h"
+
+//////////////////////
+// Clock
+//////////////////////
+static uint64_t nowUs = 0;
+static const time_t EPOCH_BASE = 1760000000; // Oct 2025, so "time is set" checks pass
+static int64_t epochOffsetUs = (int64_t)EPOCH_BASE * 1000000;
+
+unsigned long millis() { return (unsigned long)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(unsigned long ms) { nowUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned int us) { nowUs += us; }
+void yield() {}
+
+static uint64_t rtcBaseUs = 0; // RTC time accumulated before the last reboot
+
+uint64_t esp_clk_rtc_time() { return rtcBaseUs + nowUs; }
+
+void hostReboot(uint32_t sleptMs)
+{
+  // The CPU timer restarts and the system clock is lost; only the RTC
+  // timer (and RTC memory) carry over
+  rtcBaseUs += nowUs + (uint64_t)sleptMs * 1000;
+  nowUs = 0;
+  epochOffsetUs = 0;
+}
+
+void hostSetMicros(uint64_t us) { nowUs = us; }
+void hostAdvanceMillis(unsigned long ms) { nowUs += (uint64_t)ms * 1000; }
+void hostAdvanceMicros(uint64_t us) { nowUs += us; }
+
+int fakeGettimeofday(struct timeval *tv, void *tz)
+{
+  (void)tz;
+  int64_t us = epochOffsetUs + (int64_t)nowUs;
+  tv->tv_sec = us / 1000000;
+  tv->tv_usec = us % 1000000;
+  return 0;
+}
+
+int fakeSettimeofday(const struct timeval *tv, const struct timezone *tz)
+{
+  (void)tz;
+  epochOffsetUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - (int64_t)nowUs;
+  return 0;
+}
+
+time_t fakeTime(time_t *out)
+{
+  struct timeval tv;
+  fakeGettimeofday(&tv, nullptr);
+  if (out != nullptr)
+  {
+    *out = tv.tv_sec;
+  }
+  return tv.tv_sec;
+}
+
+//////////////////////
+// GPIO and sleep
+//////////////////////
+static int pinLevel[40];
+static bool pinLevelInit = false;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_EXT0;
+static bool deepSleepRequested = false;
+
+static void initPins()
+{
+  if (!pinLevelInit)
+  {
+    for (int &level : pinLevel)
+    {
+      level = HIGH; // Pulled up, buttons released
+    }
+    pinLevelInit = true;
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+  initPins();
+}
+
+static uint8_t stuckSda = 0xFF;
+static uint8_t stuckScl = 0xFF;
+static uint8_t stuckPulses = 0;
+
+void hostI2cStuck(uint8_t sdaPin, uint8_t sclPin, uint8_t pulses)
+{
+  stuckSda = sdaPin;
+  stuckScl = sclPin;
+  stuckPulses = pulses;
+}
+
+int digitalRead(uint8_t pin)
+{
+  initPins();
+  if (pin == stuckSda && stuckPulses > 0)
+  {
+    return LOW;
+  }
+  return pin < 40 ? pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  initPins();
+  if (pin == stuckScl && stuckPulses > 0 && value == HIGH && pinLevel[pin] == LOW)
+  {
+    stuckPulses--; // One clock; the slave shifts out another bit
+  }
+  if (pin < 40)
+  {
+    pinLevel[pin] = value;
+  }
+}
+
+static void (*pinHandler[40])();
+static int pinHandlerMode[40];
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode)
+{
+  if (pin < 40)
+  {
+    pinHandler[pin] = handler;
+    pinHandlerMode[pin] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  if (pin < 40)
+  {
+    pinHandler[pin] = nullptr;
+  }
+}
+
+void hostSetPin(uint8_t pin, int level)
+{
+  initPins();
+  if (pin >= 40)
+  {
+    return;
+  }
+  int previous = pinLevel[pin];
+  pinLevel[pin] = level;
+
+  int edge = level == previous ? 0 : (level == HIGH ? RISING : FALLING);
+  if (pinHandler[pin] != nullptr && (edge & pinHandlerMode[pin]) != 0)
+  {
+    pinHandler[pin]();
+  }
+}
+
+void hostSetWakeupCause(esp_sleep_wakeup_cause_t cause) { wakeupCause = cause; }
+bool hostDeepSleepRequested() { return deepSleepRequested; }
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeupCause; }
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level)
+{
+  (void)pin;
+  (void)level;
+  return ESP_OK;
+}
+
+void esp_deep_sleep_start()
+{
+  deepSleepRequested = true;
+  throw HostDeepSleep();
+}
+
+//////////////////////
+// Serial
+//////////////////////
+HardwareSerial Serial;
+static bool serialMuted = false;
+static uint32_t serialBytesOut = 0;
+static std::string serialIn;
+static FILE *serialCapture = nullptr;
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  serialBytesOut += size;
+  if (serialCapture != nullptr)
+  {
+    fwrite(buffer, 1, size, serialCapture);
+  }
+  if (!serialMuted)
+  {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+int HardwareSerial::available() { return (int)serialIn.size(); }
+
+int HardwareSerial::read()
+{
+  if (serialIn.empty())
+  {
+    return -1;
+  }
+  int c = (uint8_t)serialIn[0];
+  serialIn.erase(0, 1);
+  return c;
+}
+
+void hostSerialMute(bool mute) { serialMuted = mute; }
+void hostSerialCapture(FILE *file) { serialCapture = file; }
+void hostSerialInput(const char *text) { serialIn += text; }
+uint32_t hostSerialBytesOut() { return serialBytesOut; }
+
+//////////////////////
+// Print
+//////////////////////
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char *str)
+{
+  return str == nullptr ? 0 : write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(long value, int base)
+{
+  char buf[34];
+  if (base == HEX)
+  {
+    snprintf(buf, sizeof(buf), "%lX", value);
+  }
+  else
+  {
+    snprintf(buf, sizeof(buf), "%ld", value);
+  }
+  return write(buf);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  char buf[34];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", value);
+  return write(buf);
+}
+
+size_t Print::print(double value, int decimals)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  return write(buf);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0)
+  {
+    return 0;
+  }
+  return write((const uint8_t *)buf, min((size_t)len, sizeof(buf) - 1));
+}
+
+//////////////////////
+// String
+//////////////////////
+void String::assign(const char *s, size_t n)
+{
+  char *fresh = new char[n + 1];
+  memcpy(fresh, s, n);
+  fresh[n] = '\0';
+  delete[] buf;
+  buf = fresh;
+  len = n;
+}
+
+String &String::concat(const char *s, size_t n)
+{
+  char *fresh = new char[len + n + 1];
+  memcpy(fresh, buf, len);
+  memcpy(fresh + len, s, n);
+  fresh[len + n] = '\0';
+  delete[] buf;
+  buf = fresh;
+  len += n;
+  return *this;
+}
+
+String::String(const char *cstr) : buf(nullptr), len(0)
+{
+  if (cstr == nullptr)
+  {
+    cstr = "";
+  }
+  assign(cstr, strlen(cstr));
+}
+
+String::String(const String &other) : buf(nullptr), len(0) { assign(other.buf, other.len); }
+
+String::String(String &&other) noexcept : buf(other.buf), len(other.len)
+{
+  other.buf = nullptr;
+  other.len = 0;
+}
+
+String::String(char c) : buf(nullptr), len(0) { assign(&c, 1); }
+
+static void formatInteger(char *out, size_t size, long long value, bool isUnsigned, unsigned char base)
+{
+  if (base == 16)
+  {
+    snprintf(out, size, "%llx", (unsigned long long)value);
+  }
+  else if (isUnsigned)
+  {
+    snprintf(out, size, "%llu", (unsigned long long)value);
+  }
+  else
+  {
+    snprintf(out, size, "%lld", value);
+  }
+}
+
+String::String(int value, unsigned char base) : buf(nullptr), len(0)
+{
+  char tmp[34];
+  formatInteger(tmp, sizeof(tmp), value, false, base);
+  assign(tmp, strlen(tmp));
+}
+
+String::String(unsigned int value, unsigned char base) : buf(nullptr), len(0)
+{
+  char tmp[34];
+  formatInteger(tmp, sizeof(tmp), value, true, base);
+  assign(tmp, strlen(tmp));
+}
+
+String::String(long value, unsigned char base) : buf(nullptr), len(0)
+{
+  char tmp[34];
+  formatInteger(tmp, sizeof(tmp), value, false, base);
+  assign(tmp, strlen(tmp));
+}
+
+String::String(unsigned long value, unsigned char base) : buf(nullptr), len(0)
+{
+  char tmp[34];
+  formatInteger(tmp, sizeof(tmp), (long long)value, true, base);
+  assign(tmp, strlen(tmp));
+}
+
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned char decimals) : buf(nullptr), len(0)
+{
+  char tmp[48];
+  snprintf(tmp, sizeof(tmp), "%.*f", decimals, value);
+  assign(tmp, strlen(tmp));
+}
+
+String::~String() { delete[] buf; }
+
+String &String::operator=(const String &other)
+{
+  if (this != &other)
+  {
+    assign(other.buf, other.len);
+  }
+  return *this;
+}
+
+String &String::operator=(String &&other) noexcept
+{
+  if (this != &other)
+  {
+    delete[] buf;
+    buf = other.buf;
+    len = other.len;
+    other.buf = nullptr;
+    other.len = 0;
+  }
+  return *this;
+}
+
+String &String::operator=(const char *cstr)
+{
+  if (cstr == nullptr)
+  {
+    cstr = "";
+  }
+  assign(cstr, strlen(cstr));
+  return *this;
+}
+
+String &String::operator+=(const char *cstr)
+{
+  return cstr == nullptr ? *this : concat(cstr, strlen(cstr));
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+  if (from > to)
+  {
+    std::swap(from, to);
+  }
+  if (from >= len)
+  {
+    return String("");
+  }
+  to = min(to, len);
+  String out;
+  out.assign(buf + from, to - from);
+  return out;
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+  for (unsigned int i = from; i < len; i++)
+  {
+    if (buf[i] == c)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int String::indexOf(const char *s, unsigned int from) const
+{
+  if (from >= len)
+  {
+    return -1;
+  }
+  const char *found = strstr(buf + from, s);
+  return found == nullptr ? -1 : (int)(found - buf);
+}
+
+long String::toInt() const { return buf ? atol(buf) : 0; }
+float String::toFloat() const { return buf ? (float)atof(buf) : 0.0f; }
+
+bool String::equals(const char *cstr) const
+{
+  const char *mine = buf ? buf : "";
+  return strcmp(mine, cstr ? cstr : "") == 0;
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+//////////////////////
+// Heap accounting
+//////////////////////
+static HostHeapStats heapStats = {};
+
+HostHeapStats hostHeapStats() { return heapStats; }
+
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() { return HOST_HEAP_SIZE - heapStats.liveBytes; }
+uint32_t EspClass::getMinFreeHeap() { return HOST_HEAP_SIZE - heapStats.peakBytes; }
+
+static uint32_t cpuMhz = 240;
+static uint64_t cyclesAtChange = 0; // cycle count when cpuMhz last changed
+static uint64_t nsAtChange = 0;
+
+static uint64_t hostNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  if (nsAtChange == 0)
+  {
+    nsAtChange = hostNs();
+    cyclesAtChange = nsAtChange * cpuMhz / 1000;
+  }
+  return (uint32_t)(cyclesAtChange + (hostNs() - nsAtChange) * cpuMhz / 1000);
+}
+
+uint32_t EspClass::getCpuFreqMHz() { return cpuMhz; }
+
+void hostSetCpuFreqMHz(uint32_t mhz)
+{
+  cyclesAtChange = ESP.getCycleCount();
+  nsAtChange = hostNs();
+  cpuMhz = mhz;
+}
+
+void *operator new(size_t size)
+{
+  heapStats.allocations++;
+  heapStats.bytes += size;
+  void *p = malloc(size ? size : 1);
+  if (p == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  heapStats.liveBytes += malloc_usable_size(p);
+  heapStats.peakBytes = max(heapStats.peakBytes, heapStats.liveBytes);
+  return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept
+{
+  if (p != nullptr)
+  {
+    heapStats.frees++;
+    heapStats.liveBytes -= malloc_usable_size(p);
+    free(p);
+  }
+}
+
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
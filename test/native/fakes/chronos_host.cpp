@@ -0,0 +1,144 @@
+// ChronosESP32 and Preferences stand-ins
+#include <ChronosESP32.h>
+#include <Preferences.h>
+#include <map>
+#include <string>
+
+//////////////////////
+// ChronosESP32
+//////////////////////
+static struct tm nowTm()
+{
+  time_t t = time(nullptr);
+  struct tm out;
+  gmtime_r(&t, &out);
+  return out;
+}
+
+int ChronosESP32::getHour(bool mode)
+{
+  int hour = nowTm().tm_hour;
+  if (mode)
+  {
+    return hour;
+  }
+  return hour % 12 == 0 ? 12 : hour % 12;
+}
+
+String ChronosESP32::getHourZ()
+{
+  char buf[4];
+  snprintf(buf, sizeof(buf), "%02d", getHourC());
+  return String(buf);
+}
+
+int ChronosESP32::getMinute() { return nowTm().tm_min; }
+int ChronosESP32::getSecond() { return nowTm().tm_sec; }
+unsigned long ChronosESP32::getEpoch() { return (unsigned long)time(nullptr); }
+
+void ChronosESP32::hostSetConnected(bool state)
+{
+  connected = state;
+  if (connectionCallback != nullptr)
+  {
+    connectionCallback(state);
+  }
+}
+
+void ChronosESP32::hostSetNavigation(const Navigation &nav)
+{
+  // The icon arrives in its own packets; keep the current one
+  uint8_t icon[sizeof(navigation.icon)];
+  memcpy(icon, navigation.icon, sizeof(icon));
+  uint32_t crc = navigation.iconCRC;
+  bool hasIcon = navigation.hasIcon;
+
+  navigation = nav;
+  memcpy(navigation.icon, icon, sizeof(icon));
+  navigation.iconCRC = crc;
+  navigation.hasIcon = hasIcon;
+
+  if (configurationCallback != nullptr)
+  {
+    configurationCallback(CF_NAV_DATA, navigation.active ? 1 : 0, 0);
+  }
+}
+
+void ChronosESP32::hostSetIcon(const uint8_t *icon, uint32_t crc)
+{
+  memcpy(navigation.icon, icon, sizeof(navigation.icon));
+  navigation.iconCRC = crc;
+  navigation.hasIcon = true;
+  if (configurationCallback != nullptr)
+  {
+    configurationCallback(CF_NAV_ICON, 2, crc);
+  }
+}
+
+//////////////////////
+// Preferences
+//////////////////////
+static std::map<std::string, uint64_t> &store()
+{
+  static std::map<std::string, uint64_t> values;
+  return values;
+}
+static uint32_t writes = 0;
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+  snprintf(ns, sizeof(ns), "%s", name);
+  this->readOnly = readOnly;
+  opened = true;
+  return true;
+}
+
+void Preferences::end() { opened = false; }
+
+size_t Preferences::putULong64(const char *key, uint64_t value)
+{
+  if (!opened || readOnly)
+  {
+    return 0;
+  }
+  store()[std::string(ns) + "/" + key] = value;
+  writes++;
+  return sizeof(value);
+}
+
+uint64_t Preferences::getULong64(const char *key, uint64_t defaultValue)
+{
+  auto it = store().find(std::string(ns) + "/" + key);
+  return it == store().end() ? defaultValue : it->second;
+}
+
+bool Preferences::remove(const char *key)
+{
+  if (!opened || readOnly)
+  {
+    return false;
+  }
+  return store().erase(std::string(ns) + "/" + key) > 0;
+}
+
+bool Preferences::clear()
+{
+  if (!opened || readOnly)
+  {
+    return false;
+  }
+  std::string prefix = std::string(ns) + "/";
+  for (auto it = store().begin(); it != store().end();)
+  {
+    it = it->first.compare(0, prefix.size(), prefix) == 0 ? store().erase(it) : std::next(it);
+  }
+  return true;
+}
+
+uint32_t Preferences::hostWriteCount() { return writes; }
+
+void Preferences::hostReset()
+{
+  store().clear();
+  writes = 0;
+}
@@ -0,0 +1,8 @@
+// Placeholder credentials for host builds (WiFi is unused)
+#ifndef CREDENTIALS_H
+#define CREDENTIALS_H
+
+#define WIFI_SSID ""
+#define WIFI_PASSWORD ""
+
+#endif
@@ -0,0 +1,10 @@
+// Host stand-in for esp_private/esp_clk.h: the RTC timer keeps counting
+// through simulated deep sleep and reboots (see hostReboot())
+#ifndef FAKE_ESP_CLK_H
+#define FAKE_ESP_CLK_H
+
+#include <Arduino.h>
+
+uint64_t esp_clk_rtc_time();
+
+#endif
@@ -0,0 +1,163 @@
+// PBM and PNG writers for panel frames
+#include "frame_image.h"
+#include <vector>
+
+bool framePixel(const uint8_t *frame, int width, int x, int y)
+{
+  return (frame[x + (y / 8) * width] >> (y & 7)) & 1;
+}
+
+//////////////////////
+// PBM
+//////////////////////
+bool writePbm(const char *path, const uint8_t *frame, int width, int height)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  fprintf(file, "P4\n%d %d\n", width, height);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      uint8_t bits = 0;
+      for (int b = 0; b < 8 && x + b < width; b++)
+      {
+        bits |= framePixel(frame, width, x + b, y) ? 0x80 >> b : 0;
+      }
+      fputc(bits, file);
+    }
+  }
+  return fclose(file) == 0;
+}
+
+bool readPbm(const char *path, uint8_t *frame, int width, int height)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  int w = 0, h = 0;
+  bool ok = fscanf(file, "P4 %d %d", &w, &h) == 2 && w == width && h == height && fgetc(file) != EOF;
+  memset(frame, 0, width * ((height + 7) / 8));
+  for (int y = 0; ok && y < height; y++)
+  {
+    for (int x = 0; ok && x < width; x += 8)
+    {
+      int bits = fgetc(file);
+      ok = bits != EOF;
+      for (int b = 0; ok && b < 8 && x + b < width; b++)
+      {
+        frame[x + b + (y / 8) * width] |= (bits & (0x80 >> b)) ? 1 << (y & 7) : 0;
+      }
+    }
+  }
+  fclose(file);
+  return ok;
+}
+
+//////////////////////
+// PNG
+//////////////////////
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static void putBig32(std::vector<uint8_t> &out, uint32_t value)
+{
+  for (int shift = 24; shift >= 0; shift -= 8)
+  {
+    out.push_back((uint8_t)(value >> shift));
+  }
+}
+
+static void putChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+{
+  putBig32(png, data.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  putBig32(png, crc32(0, png.data() + start, png.size() - start));
+}
+
+bool writePng(const char *path, const uint8_t *frame, int width, int height, int scale)
+{
+  int outWidth = width * scale;
+  int outHeight = height * scale;
+  size_t rowBytes = 1 + (outWidth + 7) / 8; // filter byte, then the pixels
+  std::vector<uint8_t> raw(rowBytes * outHeight, 0);
+  for (int y = 0; y < outHeight; y++)
+  {
+    uint8_t *row = raw.data() + y * rowBytes + 1;
+    for (int x = 0; x < outWidth; x++)
+    {
+      row[x / 8] |= framePixel(frame, width, x / scale, y / scale) ? 0x80 >> (x & 7) : 0;
+    }
+  }
+
+  // zlib stream of stored deflate blocks
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  for (size_t pos = 0; pos < raw.size();)
+  {
+    size_t len = min(raw.size() - pos, (size_t)65535);
+    zlib.push_back(pos + len == raw.size() ? 1 : 0);
+    zlib.push_back(len & 0xFF);
+    zlib.push_back(len >> 8);
+    zlib.push_back(~len & 0xFF);
+    zlib.push_back((~len >> 8) & 0xFF);
+    zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+    pos += len;
+  }
+  uint32_t a = 1, b = 0;
+  for (uint8_t byte : raw)
+  {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  putBig32(zlib, b << 16 | a);
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> header;
+  putBig32(header, outWidth);
+  putBig32(header, outHeight);
+  header.insert(header.end(), {1, 0, 0, 0, 0}); // 1-bit grayscale, no interlace
+  putChunk(png, "IHDR", header);
+  putChunk(png, "IDAT", zlib);
+  putChunk(png, "IEND", {});
+
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  bool ok = fwrite(png.data(), 1, png.size(), file) == png.size();
+  return fclose(file) == 0 && ok;
+}
+
+uint32_t frameDiff(const uint8_t *a, const uint8_t *b, uint8_t *diff, int width, int height)
+{
+  uint32_t count = 0;
+  for (int i = 0; i < width * ((height + 7) / 8); i++)
+  {
+    uint8_t bits = a[i] ^ b[i];
+    count += __builtin_popcount(bits);
+    if (diff != nullptr)
+    {
+      diff[i] = bits;
+    }
+  }
+  return count;
+}
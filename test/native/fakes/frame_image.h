@@ -0,0 +1,25 @@
+// Panel frames as image files, for previews and golden-image tests
+// Frames are 1 bpp in SSD1306 page layout (byte x + (y / 8) * width, bit
+// y & 7), as in FakeSsd1306Panel::ram() and Adafruit_SSD1306::getBuffer().
+// PBM (P4) keeps one bit per pixel, a lit pixel is 1 and shows black in
+// viewers; PNG is drawn like the glass, lit pixels white on black, and can
+// be scaled up.
+#ifndef FAKE_FRAME_IMAGE_H
+#define FAKE_FRAME_IMAGE_H
+
+#include <Arduino.h>
+
+bool framePixel(const uint8_t *frame, int width, int x, int y);
+
+bool writePbm(const char *path, const uint8_t *frame, int width, int height);
+
+// False when the file is missing, not a P4 PBM or of another size
+bool readPbm(const char *path, uint8_t *frame, int width, int height);
+
+// Uncompressed (stored deflate) 1-bit grayscale PNG, scale x scale per pixel
+bool writePng(const char *path, const uint8_t *frame, int width, int height, int scale = 1);
+
+// Pixels that differ between a and b; diff (may be null) gets them lit
+uint32_t frameDiff(const uint8_t *a, const uint8_t *b, uint8_t *diff, int width, int height);
+
+#endif
@@ -0,0 +1,81 @@
+// FS / SPIFFS stand-ins: files live in a map for the whole process, so they
+// survive a simulated reboot (setup() called again) like flash does
+#include <SPIFFS.h>
+#include <map>
+#include <string>
+
+SPIFFSFS SPIFFS;
+
+static std::map<std::string, std::vector<uint8_t>> files;
+static uint32_t writeBytes = 0;
+
+namespace fs
+{
+
+size_t File::read(uint8_t *buf, size_t size)
+{
+  if (data == nullptr || pos >= data->size())
+  {
+    return 0;
+  }
+  size_t count = min(size, data->size() - pos);
+  memcpy(buf, data->data() + pos, count);
+  pos += count;
+  return count;
+}
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+  if (data == nullptr || !writable)
+  {
+    return 0;
+  }
+  if (pos + size > data->size())
+  {
+    data->resize(pos + size);
+  }
+  memcpy(data->data() + pos, buf, size);
+  pos += size;
+  writeBytes += size;
+  return size;
+}
+
+bool File::seek(uint32_t target)
+{
+  if (data == nullptr || target > data->size())
+  {
+    return false;
+  }
+  pos = target;
+  return true;
+}
+
+File FS::open(const char *path, const char *mode)
+{
+  auto it = files.find(path);
+  if (mode[0] == 'r')
+  {
+    return it == files.end() ? File() : File(&it->second, false);
+  }
+  std::vector<uint8_t> &data = files[path];
+  if (mode[0] == 'w')
+  {
+    data.clear();
+  }
+  File file(&data, true);
+  file.seek(data.size());
+  return file;
+}
+
+bool FS::exists(const char *path) { return files.count(path) > 0; }
+bool FS::remove(const char *path) { return files.erase(path) > 0; }
+
+uint32_t FS::hostWriteBytes() { return writeBytes; }
+
+void FS::hostReset()
+{
+  files.clear();
+  writeBytes = 0;
+}
+
+} // namespace fs
@@ -0,0 +1,318 @@
+// Drawing and controller traffic for the Adafruit_GFX / SSD1306 stand-ins,
+// following the library implementations pixel for pixel
+#include <Adafruit_SSD1306.h>
+#include "glcdfont.h"
+
+#define WIRE_MAX min(256, I2C_BUFFER_LENGTH)
+
+//////////////////////
+// Adafruit_GFX
+//////////////////////
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  for (int16_t i = 0; i < w; i++)
+  {
+    drawPixel(x + i, y, color);
+  }
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  for (int16_t j = 0; j < h; j++)
+  {
+    drawPixel(x, y + j, color);
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  for (int16_t i = x; i < x + w; i++)
+  {
+    drawFastVLine(i, y, h, color);
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+{
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t b = 0;
+  for (int16_t j = 0; j < h; j++, y++)
+  {
+    for (int16_t i = 0; i < w; i++)
+    {
+      if (i & 7)
+      {
+        b <<= 1;
+      }
+      else
+      {
+        b = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+      }
+      if (b & 0x80)
+      {
+        drawPixel(x + i, y, color);
+      }
+    }
+  }
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t b = 0;
+  for (int16_t j = 0; j < h; j++, y++)
+  {
+    for (int16_t i = 0; i < w; i++)
+    {
+      if (i & 7)
+      {
+        b <<= 1;
+      }
+      else
+      {
+        b = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+      }
+      drawPixel(x + i, y, (b & 0x80) ? color : bg);
+    }
+  }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+  if ((x >= _width) || (y >= _height) || ((x + 6 * size - 1) < 0) || ((y + 8 * size - 1) < 0))
+  {
+    return;
+  }
+  if (!_cp437 && (c >= 176))
+  {
+    c++; // Mirrors the library's historical off-by-one
+  }
+
+  for (int8_t i = 0; i < 5; i++)
+  {
+    uint8_t line = pgm_read_byte(&font[c * 5 + i]);
+    for (int8_t j = 0; j < 8; j++, line >>= 1)
+    {
+      if (line & 1)
+      {
+        if (size == 1)
+        {
+          drawPixel(x + i, y + j, color);
+        }
+        else
+        {
+          fillRect(x + i * size, y + j * size, size, size, color);
+        }
+      }
+      else if (bg != color)
+      {
+        if (size == 1)
+        {
+          drawPixel(x + i, y + j, bg);
+        }
+        else
+        {
+          fillRect(x + i * size, y + j * size, size, size, bg);
+        }
+      }
+    }
+  }
+  if (bg != color)
+  {
+    if (size == 1)
+    {
+      drawFastVLine(x + 5, y, 8, bg);
+    }
+    else
+    {
+      fillRect(x + 5 * size, y, size, 8 * size, bg);
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+  if (c == '\n')
+  {
+    cursor_x = 0;
+    cursor_y += textsize * 8;
+  }
+  else if (c != '\r')
+  {
+    if (wrap && ((cursor_x + textsize * 6) > _width))
+    {
+      cursor_x = 0;
+      cursor_y += textsize * 8;
+    }
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+    cursor_x += textsize * 6;
+  }
+  return 1;
+}
+
+//////////////////////
+// Adafruit_SSD1306
+//////////////////////
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t rst_pin,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(clkDuring), restoreClk(clkAfter)
+{
+  (void)rst_pin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() { free(buffer); }
+
+void Adafruit_SSD1306::commandList(const uint8_t *c, uint8_t n)
+{
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  uint16_t bytesOut = 1;
+  while (n--)
+  {
+    if (bytesOut >= WIRE_MAX)
+    {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x00);
+      bytesOut = 1;
+    }
+    wire->write(*c++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+  wire->setClock(wireClk);
+  commandList(&c, 1);
+  wire->setClock(restoreClk);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset, bool periphBegin)
+{
+  (void)reset;
+  if (buffer == nullptr)
+  {
+    buffer = (uint8_t *)malloc(_width * ((_height + 7) / 8));
+    if (buffer == nullptr)
+    {
+      return false;
+    }
+  }
+  clearDisplay();
+
+  vccstate = vcs;
+  i2caddr = addr ? addr : ((_height == 32) ? 0x3C : 0x3D);
+  if (periphBegin)
+  {
+    wire->begin();
+  }
+
+  const uint8_t init[] = {
+      SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+      SSD1306_SETMULTIPLEX, (uint8_t)(_height - 1),
+      SSD1306_SETDISPLAYOFFSET, 0x00, SSD1306_SETSTARTLINE | 0x0,
+      SSD1306_CHARGEPUMP, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x10 : 0x14),
+      SSD1306_MEMORYMODE, 0x00, SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC,
+      SSD1306_SETCOMPINS, 0x12,
+      SSD1306_SETCONTRAST, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF),
+      SSD1306_SETPRECHARGE, (uint8_t)((vccstate == SSD1306_EXTERNALVCC) ? 0x22 : 0xF1),
+      SSD1306_SETVCOMDETECT, 0x40, SSD1306_DISPLAYALLON_RESUME, SSD1306_NORMALDISPLAY,
+      SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON};
+  contrast = (vccstate == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF;
+
+  wire->setClock(wireClk);
+  commandList(init, sizeof(init));
+  wire->setClock(restoreClk);
+  return true;
+}
+
+void Adafruit_SSD1306::display()
+{
+  wire->setClock(wireClk);
+  static const uint8_t dlist1[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+  commandList(dlist1, sizeof(dlist1));
+  uint8_t lastColumn = _width - 1;
+  commandList(&lastColumn, 1);
+
+  uint16_t count = _width * ((_height + 7) / 8);
+  uint8_t *ptr = buffer;
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x40);
+  uint16_t bytesOut = 1;
+  while (count--)
+  {
+    if (bytesOut >= WIRE_MAX)
+    {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x40);
+      bytesOut = 1;
+    }
+    wire->write(*ptr++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+  if (buffer != nullptr)
+  {
+    memset(buffer, 0, _width * ((_height + 7) / 8));
+  }
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i)
+{
+  ssd1306_command(i ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
+}
+
+void Adafruit_SSD1306::dim(bool dim)
+{
+  uint8_t level = dim ? 0 : contrast;
+  const uint8_t list[] = {SSD1306_SETCONTRAST, level};
+  wire->setClock(wireClk);
+  commandList(list, sizeof(list));
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height) || buffer == nullptr)
+  {
+    return;
+  }
+  uint8_t &cell = buffer[x + (y / 8) * _width];
+  switch (color)
+  {
+  case SSD1306_WHITE:
+    cell |= (1 << (y & 7));
+    break;
+  case SSD1306_BLACK:
+    cell &= ~(1 << (y & 7));
+    break;
+  case SSD1306_INVERSE:
+    cell ^= (1 << (y & 7));
+    break;
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y)
+{
+  if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height) || buffer == nullptr)
+  {
+    return false;
+  }
+  return (buffer[x + (y / 8) * _width] & (1 << (y & 7))) != 0;
+}
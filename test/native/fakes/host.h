@@ -0,0 +1,45 @@
+// Controls for the simulated board used by host builds
+#ifndef FAKE_HOST_H
+#define FAKE_HOST_H
+
+#include <Arduino.h>
+
+// Simulated clock; it only moves when delay() is called or when advanced here
+void hostSetMicros(uint64_t us);
+void hostAdvanceMillis(unsigned long ms);
+void hostAdvanceMicros(uint64_t us);
+
+// CPU clock, as DFS would set it; the cycle counter runs at this rate
+void hostSetCpuFreqMHz(uint32_t mhz);
+
+// Power cycle through deep sleep: micros() restarts at 0 and the system
+// time is unset, while the RTC timer advances by the time slept
+void hostReboot(uint32_t sleptMs);
+
+// Simulated GPIO input level (runs an attached interrupt handler on a
+// matching edge) and wakeup cause
+void hostSetPin(uint8_t pin, int level);
+void hostSetWakeupCause(esp_sleep_wakeup_cause_t cause);
+
+// A slave holding sdaPin low until sclPin has been pulsed pulses times
+void hostI2cStuck(uint8_t sdaPin, uint8_t sclPin, uint8_t pulses);
+bool hostDeepSleepRequested();
+
+// Serial output goes to stdout unless muted; input is queued here
+void hostSerialMute(bool mute);
+void hostSerialCapture(FILE *file); // raw copy of everything written, muted or not
+void hostSerialInput(const char *text);
+uint32_t hostSerialBytesOut();
+
+// Heap traffic seen through operator new / delete
+struct HostHeapStats
+{
+  uint32_t allocations;
+  uint32_t frees;
+  uint64_t bytes;     // requested over the whole run
+  uint32_t liveBytes; // currently allocated
+  uint32_t peakBytes;
+};
+HostHeapStats hostHeapStats();
+
+#endif
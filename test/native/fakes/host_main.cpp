@@ -0,0 +1,202 @@
+// Entry point for `pio run -e native`: boots the firmware against simulated
+// panels and plays the scripted navigation scenarios.
+//
+//   .pio/build/native/program            OLED, all scenarios
+//   .pio/build/native/program --lcd      16x2 LCD instead
+//   .pio/build/native/program --both     OLED and LCD on the same bus
+//   .pio/build/native/program motorway   only the named scenario(s)
+//   .pio/build/native/program --serial log.bin
+//       raw Serial output (telemetry) to a file for tools/telemetry_decode.py
+//   .pio/build/native/program --replay drive.log [--realtime] [--events]
+//       a drive captured with "trace on" instead of the scenarios, as fast
+//       as possible or at recorded speed; --events reports every event
+//   .pio/build/native/program --png frame.png   (or --pbm frame.pbm)
+//       the OLED as it is at the end, through the real render path
+//   .pio/build/native/program --preview oled_preview.png
+//       only the sample navigation screen, 4x, for the README preview
+#ifndef PIO_UNIT_TESTING
+
+#include <Wire.h>
+#include "app.h"
+#include "host.h"
+#include "panels.h"
+#include "scenarios.h"
+#include "render_task.h"
+#include "frame_image.h"
+
+void setup();
+
+static FakeSsd1306Panel oledPanel;
+static FakeHd44780Panel lcdPanel;
+
+static void dumpPanels()
+{
+  if (displays.has(DISPLAY_OLED))
+  {
+    for (int y = 0; y < 64; y += 2)
+    {
+      for (int x = 0; x < 128; x++)
+      {
+        bool top = oledPanel.pixel(x, y);
+        bool bottom = oledPanel.pixel(x, y + 1);
+        fputs(top && bottom ? "█" : top ? "▀" : bottom ? "▄" : " ", stdout);
+      }
+      fputc('\n', stdout);
+    }
+  }
+  if (displays.has(DISPLAY_LCD))
+  {
+    printf("+----------------+\n|%s|\n", lcdPanel.row(0));
+    printf("|%s|\n+----------------+\n", lcdPanel.row(1));
+  }
+}
+
+// The navigation screen with sample data, as on the glass
+static void renderPreview()
+{
+  NavSnapshot nav = {};
+  nav.connected = true;
+  nav.active = true;
+  nav.isNavigation = true;
+  nav.showNavigation = true;
+  nav.hasIcon = true;
+  makeTurnIcon(nav.icon, -1);
+  snprintf(nav.clock, sizeof(nav.clock), "10:32");
+  snprintf(nav.title, sizeof(nav.title), "250m");
+  snprintf(nav.eta, sizeof(nav.eta), "10:45 AM");
+  snprintf(nav.duration, sizeof(nav.duration), "5 min");
+  snprintf(nav.distance, sizeof(nav.distance), "2.3 km");
+  snprintf(nav.directions, sizeof(nav.directions), "Turn left onto Main Street");
+  renderFrame(nav);
+  while (!displayService())
+  {
+  }
+}
+
+static int writeFrames(const char *png, const char *pbm)
+{
+  if (png != nullptr && !writePng(png, oledPanel.ram(), SCREEN_WIDTH, SCREEN_HEIGHT, 4))
+  {
+    fprintf(stderr, "cannot write %s\n", png);
+    return 1;
+  }
+  if (pbm != nullptr && !writePbm(pbm, oledPanel.ram(), SCREEN_WIDTH, SCREEN_HEIGHT))
+  {
+    fprintf(stderr, "cannot write %s\n", pbm);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  bool useOled = true;
+  bool useLcd = false;
+  int selected = 0;
+  const char *replay = nullptr;
+  const char *png = nullptr;
+  const char *pbm = nullptr;
+  bool preview = false;
+  TraceReplayOptions replayOptions;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--lcd") == 0)
+    {
+      useOled = false;
+      useLcd = true;
+    }
+    else if (strcmp(argv[i], "--both") == 0)
+    {
+      useLcd = true;
+    }
+    else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc)
+    {
+      hostSerialCapture(fopen(argv[++i], "wb"));
+    }
+    else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+    {
+      replay = argv[++i];
+    }
+    else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc)
+    {
+      png = argv[++i];
+    }
+    else if (strcmp(argv[i], "--pbm") == 0 && i + 1 < argc)
+    {
+      pbm = argv[++i];
+    }
+    else if (strcmp(argv[i], "--preview") == 0 && i + 1 < argc)
+    {
+      png = argv[++i];
+      preview = true;
+    }
+    else if (strcmp(argv[i], "--realtime") == 0)
+    {
+      replayOptions.realTime = true;
+    }
+    else if (strcmp(argv[i], "--events") == 0)
+    {
+      replayOptions.perEvent = true;
+    }
+    else
+    {
+      selected++;
+    }
+  }
+
+  if (useOled)
+  {
+    Wire.attach(0x3C, &oledPanel);
+  }
+  if (useLcd)
+  {
+    Wire.attach(0x27, &lcdPanel);
+  }
+
+  hostSerialMute(true);
+  setup();
+
+  if (preview)
+  {
+    renderPreview();
+    return writeFrames(png, pbm);
+  }
+
+  if (replay != nullptr)
+  {
+    FILE *trace = fopen(replay, "rb");
+    if (trace == nullptr)
+    {
+      fprintf(stderr, "cannot open %s\n", replay);
+      return 1;
+    }
+    ScenarioReport report = replayTrace(trace, replayOptions);
+    fclose(trace);
+    NavScenario replayed = {"replay", replay, report.durationMs, true, nullptr};
+    printScenarioReport(replayed, report);
+    printf("%u events replayed, %u trace lines rejected\n", report.events, report.rejectedLines);
+    dumpPanels();
+    return writeFrames(png, pbm);
+  }
+
+  for (size_t s = 0; s < navScenarioCount; s++)
+  {
+    const NavScenario &scenario = navScenarios[s];
+    bool wanted = selected == 0;
+    for (int i = 1; i < argc && !wanted; i++)
+    {
+      wanted = strcmp(argv[i], scenario.name) == 0;
+    }
+    if (!wanted)
+    {
+      continue;
+    }
+
+    ScenarioReport report = runScenario(scenario);
+    printScenarioReport(scenario, report);
+    dumpPanels();
+  }
+  return writeFrames(png, pbm);
+}
+
+#endif
@@ -0,0 +1,100 @@
+// LiquidCrystal_I2C stand-in, byte-for-byte the marcoschwartz 1.1.x driver
+#include <LiquidCrystal_I2C.h>
+
+#define LCD_4BITMODE 0x00
+#define LCD_2LINE 0x08
+#define LCD_1LINE 0x00
+#define LCD_5x8DOTS 0x00
+#define LCD_DISPLAYON 0x04
+#define LCD_ENTRYLEFT 0x02
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows)
+    : addr(addr), cols(cols), rows(rows)
+{
+}
+
+void LiquidCrystal_I2C::init()
+{
+  Wire.begin();
+  uint8_t function = LCD_4BITMODE | LCD_5x8DOTS | (rows > 1 ? LCD_2LINE : LCD_1LINE);
+
+  delay(50);
+  expanderWrite(backlightval);
+  delay(1000);
+
+  write4bits(0x03 << 4);
+  delayMicroseconds(4500);
+  write4bits(0x03 << 4);
+  delayMicroseconds(4500);
+  write4bits(0x03 << 4);
+  delayMicroseconds(150);
+  write4bits(0x02 << 4);
+
+  command(LCD_FUNCTIONSET | function);
+  command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+  clear();
+  command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+  home();
+}
+
+void LiquidCrystal_I2C::clear()
+{
+  command(LCD_CLEARDISPLAY);
+  delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::home()
+{
+  command(LCD_RETURNHOME);
+  delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row)
+{
+  static const uint8_t rowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+  if (row >= rows)
+  {
+    row = rows - 1;
+  }
+  command(LCD_SETDDRAMADDR | (col + rowOffsets[row]));
+}
+
+void LiquidCrystal_I2C::backlight()
+{
+  backlightval = LCD_BACKLIGHT;
+  expanderWrite(0);
+}
+
+void LiquidCrystal_I2C::noBacklight()
+{
+  backlightval = LCD_NOBACKLIGHT;
+  expanderWrite(0);
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t value)
+{
+  send(value, Rs);
+  return 1;
+}
+
+void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode)
+{
+  write4bits((value & 0xF0) | mode);
+  write4bits(((value << 4) & 0xF0) | mode);
+}
+
+void LiquidCrystal_I2C::write4bits(uint8_t value)
+{
+  expanderWrite(value);
+  expanderWrite(value | En);
+  delayMicroseconds(1);
+  expanderWrite(value & ~En);
+  delayMicroseconds(50);
+}
+
+void LiquidCrystal_I2C::expanderWrite(uint8_t data)
+{
+  Wire.beginTransmission(addr);
+  Wire.write((uint8_t)(data | backlightval));
+  Wire.endTransmission();
+}
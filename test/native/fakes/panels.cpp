@@ -0,0 +1,222 @@
+// SSD1306 and HD44780 controller models
+#include "panels.h"
+
+//////////////////////
+// SSD1306
+//////////////////////
+FakeSsd1306Panel::FakeSsd1306Panel(uint8_t width, uint8_t height)
+    : width(width), pages(height / 8)
+{
+  colEnd = width - 1;
+  pageEnd = pages - 1;
+}
+
+bool FakeSsd1306Panel::pixel(int x, int y) const
+{
+  if (x < 0 || x >= width || y < 0 || y >= pages * 8)
+  {
+    return false;
+  }
+  return (gddram[x + (y / 8) * width] >> (y & 7)) & 1;
+}
+
+void FakeSsd1306Panel::onWrite(const uint8_t *bytes, size_t len)
+{
+  // Only stream-mode control bytes (Co=0) are used by the drivers
+  bool isData = (bytes[0] & 0x40) != 0;
+  for (size_t i = 1; i < len; i++)
+  {
+    if (isData)
+    {
+      data(bytes[i]);
+    }
+    else
+    {
+      command(bytes[i]);
+    }
+  }
+}
+
+static uint8_t argumentCount(uint8_t c)
+{
+  switch (c)
+  {
+  case 0x20: // MEMORYMODE
+  case 0x81: // SETCONTRAST
+  case 0x8D: // CHARGEPUMP
+  case 0xA8: // SETMULTIPLEX
+  case 0xD3: // SETDISPLAYOFFSET
+  case 0xD5: // SETDISPLAYCLOCKDIV
+  case 0xD9: // SETPRECHARGE
+  case 0xDA: // SETCOMPINS
+  case 0xDB: // SETVCOMDETECT
+    return 1;
+  case 0x21: // COLUMNADDR
+  case 0x22: // PAGEADDR
+  case 0xA3: // SET_VERTICAL_SCROLL_AREA
+    return 2;
+  case 0x29: // VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL
+  case 0x2A: // VERTICAL_AND_LEFT_HORIZONTAL_SCROLL
+    return 5;
+  case 0x26: // RIGHT_HORIZONTAL_SCROLL
+  case 0x27: // LEFT_HORIZONTAL_SCROLL
+    return 6;
+  default:
+    return 0;
+  }
+}
+
+void FakeSsd1306Panel::command(uint8_t c)
+{
+  if (pendingArgs > 0)
+  {
+    args[argIndex++] = c;
+    if (--pendingArgs > 0)
+    {
+      return;
+    }
+    switch (pendingCmd)
+    {
+    case 0x21:
+      colStart = min(args[0], (uint8_t)(width - 1));
+      colEnd = min(args[1], (uint8_t)(width - 1));
+      col = colStart;
+      break;
+    case 0x22:
+      pageStart = min(args[0], (uint8_t)(pages - 1));
+      pageEnd = min(args[1], (uint8_t)(pages - 1));
+      page = pageStart;
+      break;
+    case 0x81:
+      contrastLevel = args[0];
+      break;
+    }
+    return;
+  }
+
+  pendingArgs = argumentCount(c);
+  if (pendingArgs > 0)
+  {
+    pendingCmd = c;
+    argIndex = 0;
+    return;
+  }
+
+  switch (c)
+  {
+  case 0xAE:
+    displayOn = false;
+    break;
+  case 0xAF:
+    displayOn = true;
+    break;
+  case 0xA6:
+    inverted = false;
+    break;
+  case 0xA7:
+    inverted = true;
+    break;
+  case 0x2E:
+    scrolling = false;
+    break;
+  case 0x2F:
+    scrolling = true;
+    break;
+  }
+}
+
+void FakeSsd1306Panel::data(uint8_t d)
+{
+  // Horizontal addressing mode inside the current column/page window
+  gddram[col + page * width] = d;
+  dataWritten++;
+  if (col >= colEnd)
+  {
+    col = colStart;
+    page = (page >= pageEnd) ? pageStart : page + 1;
+  }
+  else
+  {
+    col++;
+  }
+}
+
+//////////////////////
+// HD44780 via PCF8574
+//////////////////////
+FakeHd44780Panel::FakeHd44780Panel() { memset(ddram, ' ', sizeof(ddram)); }
+
+void FakeHd44780Panel::onWrite(const uint8_t *bytes, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    uint8_t next = bytes[i];
+    // The controller samples the data lines on the falling edge of EN
+    if ((port & 0x04) && !(next & 0x04))
+    {
+      latch(port >> 4, (port & 0x01) != 0);
+    }
+    port = next;
+  }
+}
+
+void FakeHd44780Panel::latch(uint8_t nibble, bool rs)
+{
+  if (!fourBit)
+  {
+    // 8-bit interface during reset: only the upper data lines are wired
+    uint8_t value = nibble << 4;
+    if (!rs && (value & 0xF0) == 0x20)
+    {
+      fourBit = true;
+      haveHigh = false;
+    }
+    return;
+  }
+
+  if (!haveHigh)
+  {
+    high = nibble;
+    haveHigh = true;
+    return;
+  }
+  haveHigh = false;
+  execute((high << 4) | nibble, rs);
+}
+
+void FakeHd44780Panel::execute(uint8_t value, bool rs)
+{
+  if (rs)
+  {
+    ddram[address & 0x7F] = value;
+    dataWritten++;
+    address = (address == 0x27) ? 0x40 : (address == 0x67) ? 0x00 : address + 1;
+    return;
+  }
+
+  if (value & 0x80)
+  {
+    address = value & 0x7F;
+  }
+  else if (value == 0x01)
+  {
+    memset(ddram, ' ', sizeof(ddram));
+    address = 0;
+  }
+  else if ((value & 0xFE) == 0x02)
+  {
+    address = 0;
+  }
+}
+
+const char *FakeHd44780Panel::row(uint8_t r)
+{
+  const uint8_t base = r == 0 ? 0x00 : 0x40;
+  for (int i = 0; i < 16; i++)
+  {
+    uint8_t c = ddram[base + i];
+    rowText[i] = (c >= 0x20 && c < 0x7F) ? (char)c : '?';
+  }
+  rowText[16] = '\0';
+  return rowText;
+}
@@ -0,0 +1,74 @@
+// Simulated I2C display controllers for host builds
+// Decode the bytes a driver puts on the bus into panel memory, so tests can
+// check what would actually be on the glass rather than what was drawn.
+#ifndef FAKE_PANELS_H
+#define FAKE_PANELS_H
+
+#include <Wire.h>
+
+// SSD1306 controller: command parser plus 128x64 GDDRAM
+class FakeSsd1306Panel : public FakeI2cDevice
+{
+public:
+  FakeSsd1306Panel(uint8_t width = 128, uint8_t height = 64);
+
+  void onWrite(const uint8_t *data, size_t len) override;
+  uint8_t onRead() override { return displayOn ? 0x00 : 0x40; }
+
+  const uint8_t *ram() const { return gddram; }
+  bool pixel(int x, int y) const;
+  bool isOn() const { return displayOn; }
+  bool isInverted() const { return inverted; }
+  uint8_t contrast() const { return contrastLevel; }
+  bool isScrolling() const { return scrolling; }
+  uint32_t dataBytes() const { return dataWritten; }
+
+private:
+  void command(uint8_t c);
+  void data(uint8_t d);
+
+  uint8_t width;
+  uint8_t pages;
+  uint8_t gddram[128 * 8] = {};
+  uint8_t colStart = 0, colEnd = 127, pageStart = 0, pageEnd = 7;
+  uint8_t col = 0, page = 0;
+  uint8_t pendingCmd = 0;
+  uint8_t pendingArgs = 0;
+  uint8_t args[8] = {};
+  uint8_t argIndex = 0;
+  bool displayOn = false;
+  bool inverted = false;
+  bool scrolling = false;
+  uint8_t contrastLevel = 0x7F;
+  uint32_t dataWritten = 0;
+};
+
+// HD44780 behind a PCF8574 backpack (RS=P0, RW=P1, EN=P2, BL=P3, D4-D7=P4-P7)
+class FakeHd44780Panel : public FakeI2cDevice
+{
+public:
+  FakeHd44780Panel();
+
+  void onWrite(const uint8_t *data, size_t len) override;
+  uint8_t onRead() override { return port; }
+
+  // Visible characters of a row as a NUL-terminated string
+  const char *row(uint8_t r);
+  bool backlightOn() const { return (port & 0x08) != 0; }
+  uint32_t charsWritten() const { return dataWritten; }
+
+private:
+  void latch(uint8_t nibble, bool rs);
+  void execute(uint8_t value, bool rs);
+
+  uint8_t ddram[128];
+  char rowText[17];
+  uint8_t address = 0;
+  uint8_t port = 0;
+  bool fourBit = false;
+  bool haveHigh = false;
+  uint8_t high = 0;
+  uint32_t dataWritten = 0;
+};
+
+#endif
@@ -0,0 +1,421 @@
+#include "scenarios.h"
+#include <chrono>
+#include <thread>
+#include <Wire.h>
+#include "app.h"
+#include "render_task.h"
+#include "host.h"
+#include "nav_trace.h"
+
+void loop();
+
+void makeTurnIcon(uint8_t icon[288], int direction)
+{
+  memset(icon, 0, 288);
+  auto set = [&](int x, int y) {
+    if (x >= 0 && x < 48 && y >= 0 && y < 48)
+    {
+      icon[y * 6 + x / 8] |= 0x80 >> (x & 7);
+    }
+  };
+
+  if (direction == 0)
+  {
+    // Shaft plus upward head
+    for (int y = 14; y < 46; y++)
+      for (int x = 20; x < 28; x++)
+        set(x, y);
+    for (int y = 2; y < 18; y++)
+      for (int x = 24 - (y - 2); x <= 23 + (y - 2); x++)
+        set(x, y);
+    return;
+  }
+
+  // Vertical shaft, horizontal arm, head pointing sideways
+  for (int y = 20; y < 46; y++)
+    for (int x = 20; x < 28; x++)
+      set(x, y);
+  int armFrom = direction < 0 ? 12 : 20;
+  int armTo = direction < 0 ? 28 : 36;
+  for (int y = 16; y < 24; y++)
+    for (int x = armFrom; x < armTo; x++)
+      set(x, y);
+  for (int dx = 0; dx < 12; dx++)
+  {
+    int x = direction < 0 ? 12 - dx : 35 + dx;
+    for (int y = 8 + dx; y < 32 - dx; y++)
+      set(x, y);
+  }
+}
+
+//////////////////////
+// Scenario scripts
+//////////////////////
+static Navigation baseNav()
+{
+  Navigation nav = {};
+  nav.active = true;
+  nav.isNavigation = true;
+  nav.eta = "10:45";
+  nav.duration = "12 min";
+  nav.distance = "8.4 km";
+  nav.speed = "42 km/h";
+  return nav;
+}
+
+static void formatMeters(String &out, int meters)
+{
+  char buf[16];
+  if (meters >= 1000)
+  {
+    snprintf(buf, sizeof(buf), "%d.%d km", meters / 1000, (meters % 1000) / 100);
+  }
+  else
+  {
+    snprintf(buf, sizeof(buf), "%d m", meters);
+  }
+  out = buf;
+}
+
+// City driving: a turn every ~40 s, distance updates every 2 s
+static void cityTurns(uint32_t t, ChronosESP32 &chronos)
+{
+  static const char *streets[] = {
+      "Turn left onto Main Street",
+      "Turn right onto Church Road",
+      "Turn left onto Station Avenue North",
+      "Turn right",
+  };
+  const uint32_t legMs = 40000;
+  uint32_t leg = t / legMs;
+  uint32_t inLeg = t % legMs;
+
+  if (inLeg % 2000 != 0)
+  {
+    return;
+  }
+
+  Navigation nav = baseNav();
+  formatMeters(nav.title, 400 - (int)(inLeg / 2000) * 20);
+  formatMeters(nav.distance, 8400 - (int)(t / 1000) * 12);
+  char duration[12];
+  snprintf(duration, sizeof(duration), "%u min", (unsigned)(12 - t / 60000));
+  nav.duration = duration;
+  nav.directions = streets[leg % 4];
+  chronos.hostSetNavigation(nav);
+
+  if (inLeg == 0)
+  {
+    uint8_t icon[288];
+    makeTurnIcon(icon, leg % 2 == 0 ? -1 : 1);
+    chronos.hostSetIcon(icon, 0x1000 + leg);
+  }
+}
+
+// Motorway: one long leg, distance to the exit in 100 m steps
+static void motorway(uint32_t t, ChronosESP32 &chronos)
+{
+  if (t % 5000 != 0)
+  {
+    return;
+  }
+  Navigation nav = baseNav();
+  formatMeters(nav.title, 18000 - (int)(t / 5000) * 150);
+  formatMeters(nav.distance, 42000 - (int)(t / 5000) * 150);
+  nav.duration = "27 min";
+  nav.eta = "11:02";
+  nav.directions = "Continue on A1 towards Hamburg / Bremen";
+  chronos.hostSetNavigation(nav);
+  if (t == 0)
+  {
+    uint8_t icon[288];
+    makeTurnIcon(icon, 0);
+    chronos.hostSetIcon(icon, 0x2000);
+  }
+}
+
+// Reroute: the phone blanks navigation for a few seconds, then resumes
+static void reroute(uint32_t t, ChronosESP32 &chronos)
+{
+  if (t % 1000 != 0)
+  {
+    return;
+  }
+  if (t >= 8000 && t < 14000)
+  {
+    Navigation blank = {};
+    chronos.hostSetNavigation(blank);
+    return;
+  }
+  Navigation nav = baseNav();
+  formatMeters(nav.title, t < 8000 ? 300 - (int)(t / 1000) * 10 : 950);
+  nav.directions = t < 8000 ? "Turn left onto Main Street" : "Make a U-turn";
+  chronos.hostSetNavigation(nav);
+}
+
+// No route: whatever the previous scenario left is cleared at the start
+static void idleClock(uint32_t t, ChronosESP32 &chronos)
+{
+  if (t == 0)
+  {
+    chronos.hostSetNavigation(Navigation{});
+  }
+}
+
+const NavScenario navScenarios[] = {
+    {"city_turns", "urban guidance, turn every 40 s", 240000, true, cityTurns},
+    {"motorway", "long leg, 5 s distance updates", 180000, true, motorway},
+    {"reroute", "guidance drops out for 6 s", 30000, true, reroute},
+    {"idle_clock", "connected, no route", 120000, true, idleClock},
+    {"disconnected", "waiting for the phone", 60000, false, idleClock},
+};
+const size_t navScenarioCount = sizeof(navScenarios) / sizeof(navScenarios[0]);
+
+//////////////////////
+// Runner
+//////////////////////
+// Redraw counters as of the previous loop()
+struct LoopProbe
+{
+  uint32_t latencySamples;
+  uint64_t latencyTotal;
+};
+
+static LoopProbe startProbe()
+{
+  return {redrawTrigger.stats().latencySamples, redrawTrigger.stats().totalLatencyUs};
+}
+
+// One loop() with what it cost added to the report
+static void measuredLoop(ScenarioReport &report, LoopProbe &probe)
+{
+  uint32_t framesBefore = displayFrameCount;
+  WireStats busBefore = Wire.stats();
+  HostHeapStats heapBefore = hostHeapStats();
+  auto t0 = std::chrono::steady_clock::now();
+
+  loop();
+
+  auto t1 = std::chrono::steady_clock::now();
+  uint32_t allocs = hostHeapStats().allocations - heapBefore.allocations;
+  uint32_t loopBusUs = Wire.stats().busTimeUs - busBefore.busTimeUs;
+  report.loops++;
+  report.busBytes += Wire.stats().bytes - busBefore.bytes;
+  report.busTransactions += Wire.stats().transactions - busBefore.transactions;
+  report.busTimeUs += loopBusUs;
+  report.maxLoopBusUs = max(report.maxLoopBusUs, loopBusUs);
+
+  if (displayFrameCount != framesBefore)
+  {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    report.frames += displayFrameCount - framesBefore;
+    report.renderNs += ns;
+    report.maxRenderNs = max(report.maxRenderNs, ns);
+    report.allocations += allocs;
+  }
+
+  const RedrawStats &redraw = redrawTrigger.stats();
+  if (redraw.latencySamples != probe.latencySamples)
+  {
+    report.latencySamples += redraw.latencySamples - probe.latencySamples;
+    report.latencyUs += redraw.totalLatencyUs - probe.latencyTotal;
+    report.maxLatencyUs = max(report.maxLatencyUs, redraw.lastLatencyUs);
+    probe.latencySamples = redraw.latencySamples;
+    probe.latencyTotal = redraw.totalLatencyUs;
+  }
+  else
+  {
+    report.idleAllocations += allocs;
+  }
+
+  if (report.loops == 1)
+  {
+    chronosMaxGapUs = 0; // Don't count the gap since the previous run
+  }
+}
+
+// Let the last frame reach the panel and close the report
+static void finishRun(ScenarioReport &report, uint32_t serialBefore, uint32_t tickMs)
+{
+  while (!displayService())
+  {
+  }
+  report.serialBytes = hostSerialBytesOut() - serialBefore;
+  report.maxChronosGapUs = chronosMaxGapUs > tickMs * 1000 ? chronosMaxGapUs - tickMs * 1000 : 0;
+}
+
+ScenarioReport runScenario(const NavScenario &scenario, uint32_t tickMs)
+{
+  ScenarioReport report = {};
+  report.durationMs = scenario.durationMs;
+
+  if (Chronos.isConnected() != scenario.connected)
+  {
+    Chronos.hostSetConnected(scenario.connected);
+  }
+
+  unsigned long start = millis();
+  uint32_t serialBefore = hostSerialBytesOut();
+  uint32_t nextUpdate = 0;
+  LoopProbe probe = startProbe();
+  while (millis() - start < scenario.durationMs)
+  {
+    uint32_t elapsed = millis() - start;
+    // Scripts act on whole seconds' worth of fixed instants
+    while (nextUpdate <= elapsed)
+    {
+      scenario.update(nextUpdate, Chronos);
+      nextUpdate += 1000;
+    }
+    measuredLoop(report, probe);
+    hostAdvanceMillis(tickMs);
+  }
+
+  finishRun(report, serialBefore, tickMs);
+  return report;
+}
+
+//////////////////////
+// Trace replay
+//////////////////////
+static const char *const traceKindNames[] = {"connection", "navigation", "icon"};
+
+static bool nextTraceEvent(FILE *trace, NavTraceReader &reader)
+{
+  for (int c; (c = fgetc(trace)) != EOF;)
+  {
+    if (reader.feed((char)c))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Hand a recorded change to Chronos the way the phone did
+static void applyTraceEvent(const NavTraceEvent &event)
+{
+  const NavSnapshot &state = event.state;
+  switch (event.kind)
+  {
+  case NAV_TRACE_CONNECTION:
+    if (Chronos.isConnected() != state.connected)
+    {
+      Chronos.hostSetConnected(state.connected);
+    }
+    break;
+  case NAV_TRACE_NAV:
+  {
+    Navigation nav = {};
+    nav.active = state.active;
+    nav.isNavigation = state.isNavigation;
+    nav.title = state.title;
+    nav.eta = state.eta;
+    nav.duration = state.duration;
+    nav.distance = state.distance;
+    nav.speed = state.speed;
+    nav.directions = state.directions;
+    Chronos.hostSetNavigation(nav);
+    break;
+  }
+  case NAV_TRACE_ICON:
+    Chronos.hostSetIcon(state.icon, fnv1a(FNV1A_SEED, state.icon, NAV_ICON_BYTES));
+    break;
+  }
+}
+
+// What happened between one event and the next
+struct TraceEventReport
+{
+  uint32_t index;
+  uint32_t atMs; // since the first event
+  NavTraceKind kind;
+  uint32_t frames;
+  uint64_t busBytes;
+  uint32_t latencySamples;
+  uint32_t latencyUs; // of the first event-driven frame after it
+};
+
+static void printTraceEvent(const TraceEventReport &event, const ScenarioReport &report)
+{
+  printf("event %6u %10.3f s %-10s | frames %3u | bus %7llu B | latency ", event.index, event.atMs / 1000.0,
+         traceKindNames[event.kind], report.frames - event.frames,
+         (unsigned long long)(report.busBytes - event.busBytes));
+  if (report.latencySamples != event.latencySamples)
+  {
+    printf("%7.1f ms\n", event.latencyUs / 1000.0);
+  }
+  else
+  {
+    printf("      - \n");
+  }
+}
+
+ScenarioReport replayTrace(FILE *trace, const TraceReplayOptions &options)
+{
+  ScenarioReport report = {};
+  NavTraceReader reader;
+  bool pending = nextTraceEvent(trace, reader);
+  uint32_t firstMs = reader.event().ms;
+
+  unsigned long start = millis();
+  uint32_t serialBefore = hostSerialBytesOut();
+  uint32_t endMs = 0;
+  LoopProbe probe = startProbe();
+  TraceEventReport current = {};
+  bool reporting = false;
+  auto wallStart = std::chrono::steady_clock::now();
+  while (pending || millis() - start < endMs)
+  {
+    uint32_t elapsed = millis() - start;
+    while (pending && reader.event().ms - firstMs <= elapsed)
+    {
+      if (options.perEvent && reporting)
+      {
+        printTraceEvent(current, report);
+      }
+      current = {report.events, reader.event().ms - firstMs, reader.event().kind, report.frames,
+                 report.busBytes, report.latencySamples, 0};
+      reporting = true;
+      applyTraceEvent(reader.event());
+      report.events++;
+      endMs = reader.event().ms - firstMs + options.tailMs;
+      pending = nextTraceEvent(trace, reader);
+    }
+
+    uint32_t samples = report.latencySamples;
+    measuredLoop(report, probe);
+    if (samples == current.latencySamples && report.latencySamples != samples)
+    {
+      current.latencyUs = redrawTrigger.stats().lastLatencyUs;
+    }
+    hostAdvanceMillis(options.tickMs);
+    if (options.realTime)
+    {
+      std::this_thread::sleep_until(wallStart + std::chrono::milliseconds(millis() - start));
+    }
+  }
+
+  finishRun(report, serialBefore, options.tickMs);
+  if (options.perEvent && reporting)
+  {
+    printTraceEvent(current, report);
+  }
+  report.durationMs = millis() - start;
+  report.rejectedLines = reader.rejected();
+  return report;
+}
+
+void printScenarioReport(const NavScenario &scenario, const ScenarioReport &report)
+{
+  uint32_t frames = max(report.frames, (uint32_t)1);
+  uint32_t samples = max(report.latencySamples, (uint32_t)1);
+  printf("%-13s frames %5u | render avg %7.1f us max %7.1f us | bus %6.1f B/frame %5.1f tx/frame %7.1f us/frame, %5.1f ms max per loop | allocs %5.1f/frame, %u outside frames | latency avg %7.1f ms max %7.1f ms | Chronos.loop() stall %7.1f ms | serial %5.1f B/s\n",
+         scenario.name, report.frames,
+         report.renderNs / 1000.0 / frames, report.maxRenderNs / 1000.0,
+         (double)report.busBytes / frames, (double)report.busTransactions / frames,
+         (double)report.busTimeUs / frames, report.maxLoopBusUs / 1000.0,
+         (double)report.allocations / frames, report.idleAllocations,
+         report.latencyUs / 1000.0 / samples, report.maxLatencyUs / 1000.0,
+         report.maxChronosGapUs / 1000.0, report.serialBytes * 1000.0 / scenario.durationMs);
+}
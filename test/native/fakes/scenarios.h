@@ -0,0 +1,69 @@
+// Scripted navigation sessions for host runs and benchmarks
+// Each scenario feeds Chronos the way the phone app does during a drive;
+// runScenario() steps the firmware loop() on the simulated clock and
+// measures every loop iteration that produced a display frame; bus traffic
+// is counted across all loops since frames are sent in slices.
+// replayTrace() does the same with a drive recorded on the device
+// ("trace on", nav_trace.h) instead of a script.
+#ifndef FAKE_SCENARIOS_H
+#define FAKE_SCENARIOS_H
+
+#include <ChronosESP32.h>
+#include <stdio.h>
+
+struct NavScenario
+{
+  const char *name;
+  const char *description;
+  uint32_t durationMs;
+  bool connected;
+  // Push whatever the phone would have sent at this point of the drive
+  void (*update)(uint32_t elapsedMs, ChronosESP32 &chronos);
+};
+
+struct ScenarioReport
+{
+  uint32_t loops;
+  uint32_t frames;
+  uint64_t renderNs;    // host CPU time of the loop() calls that drew a frame
+  uint64_t maxRenderNs;
+  uint64_t busBytes;    // I2C bytes over the whole run
+  uint32_t busTransactions;
+  uint64_t busTimeUs;   // simulated I2C time over the whole run
+  uint32_t maxLoopBusUs; // longest I2C time inside a single loop()
+  uint32_t allocations; // heap allocations during frame loops
+  uint32_t idleAllocations; // heap allocations in loops without a frame
+  uint32_t latencySamples;  // event-driven frames
+  uint64_t latencyUs;       // Chronos event to frame on the panel, summed
+  uint32_t maxLatencyUs;
+  uint32_t maxChronosGapUs; // longest stretch without Chronos.loop(), minus the tick
+  uint32_t serialBytes;     // bytes written to Serial (telemetry, logs)
+  uint32_t durationMs;      // simulated time covered
+  uint32_t events;          // trace events replayed
+  uint32_t rejectedLines;   // trace lines that did not parse
+};
+
+struct TraceReplayOptions
+{
+  bool realTime = false; // pace the simulated clock to the wall clock
+  bool perEvent = false; // print frames, bus bytes and latency after each event
+  uint32_t tickMs = 5;
+  uint32_t tailMs = 2000; // keep running after the last event
+};
+
+extern const NavScenario navScenarios[];
+extern const size_t navScenarioCount;
+
+// Run one scenario from the current firmware state, calling loop() every tickMs
+ScenarioReport runScenario(const NavScenario &scenario, uint32_t tickMs = 5);
+
+// Replay a capture (a serial log with trace lines in it), each event at
+// its recorded time after the first
+ScenarioReport replayTrace(FILE *trace, const TraceReplayOptions &options);
+
+// Fill a 48x48 row-major icon with a simple turn arrow (-1 left, 0 ahead, 1 right)
+void makeTurnIcon(uint8_t icon[288], int direction);
+
+void printScenarioReport(const NavScenario &scenario, const ScenarioReport &report);
+
+#endif
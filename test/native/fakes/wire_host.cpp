@@ -0,0 +1,116 @@
+// Simulated I2C bus: routes transactions to attached devices and accounts
+// for the time they would take on the wire
+#include <Wire.h>
+#include "host.h"
+
+TwoWire Wire;
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+  (void)scl;
+  if (sda >= 0)
+  {
+    sdaPin = sda;
+  }
+  if (frequency != 0)
+  {
+    clock = frequency;
+  }
+  return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  txAddress = address;
+  txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+  if (txLength >= sizeof(txBuffer))
+  {
+    return 0;
+  }
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t len)
+{
+  size_t n = 0;
+  while (n < len && write(data[n]))
+  {
+    n++;
+  }
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  (void)sendStop;
+  account(1 + txLength);
+  if (sdaPin >= 0 && digitalRead(sdaPin) == LOW)
+  {
+    return 4; // Bus error: SDA held low
+  }
+  FakeI2cDevice *device = devices[txAddress & 0x7F];
+  if (device == nullptr)
+  {
+    return 2; // NACK on address
+  }
+  if (clock > device->maxClock)
+  {
+    return 3; // Too fast for it: bytes not acknowledged
+  }
+  if (dataNacks > 0 && txLength > 1)
+  {
+    dataNacks--;
+    device->onWrite(txBuffer, txLength / 2);
+    return 2; // Arduino-ESP32 2.x: any NACK
+  }
+  if (txLength > 0)
+  {
+    device->onWrite(txBuffer, txLength);
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop)
+{
+  (void)sendStop;
+  account(1 + quantity);
+  rxAddress = address & 0x7F;
+  pendingRead = devices[rxAddress] != nullptr ? quantity : 0;
+  return pendingRead;
+}
+
+int TwoWire::read()
+{
+  if (pendingRead <= 0)
+  {
+    return -1;
+  }
+  pendingRead--;
+  uint8_t value = devices[rxAddress]->onRead();
+  return clock > devices[rxAddress]->maxClock ? value ^ 0x5A : value;
+}
+
+void TwoWire::attach(uint8_t address, FakeI2cDevice *device) { devices[address & 0x7F] = device; }
+
+void TwoWire::detachAll()
+{
+  for (FakeI2cDevice *&device : devices)
+  {
+    device = nullptr;
+  }
+}
+
+void TwoWire::account(size_t bytes)
+{
+  // 9 clocks per byte (8 data + ACK) plus START and STOP
+  uint64_t us = ((uint64_t)bytes * 9 + 2) * 1000000ULL / clock;
+  counters.transactions++;
+  counters.bytes += bytes;
+  counters.busTimeUs += us;
+  hostAdvanceMicros(us); // The ESP32 driver blocks for the transfer
+}
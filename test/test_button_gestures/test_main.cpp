@@ -0,0 +1,97 @@
+// BOOT button gestures from bouncing edges
+//
+//   pio test -e native -f test_button_gestures -v
+#include <unity.h>
+#include "host.h"
+#include "button_gestures.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Press (or release) the BOOT button the way a real contact does: two
+// bounces, then hold the new level for ms, polling every millisecond.
+// Returns the last gesture seen; gesturesSeen counts them.
+static uint32_t gesturesSeen = 0;
+
+static ButtonGesture setButton(bool pressed, unsigned long ms)
+{
+  int level = pressed ? LOW : HIGH;
+  int other = pressed ? HIGH : LOW;
+  hostSetPin(0, level);
+  hostAdvanceMillis(1);
+  hostSetPin(0, other);
+  hostAdvanceMillis(1);
+  hostSetPin(0, level);
+
+  ButtonGesture seen = GESTURE_NONE;
+  for (unsigned long t = 0; t < ms; t++)
+  {
+    ButtonGesture gesture = buttonPoll();
+    if (gesture != GESTURE_NONE)
+    {
+      seen = gesture;
+      gesturesSeen++;
+    }
+    hostAdvanceMillis(1);
+  }
+  return seen;
+}
+
+static void test_button_gestures()
+{
+  hostSetPin(0, HIGH);
+  buttonBegin(0);
+
+  // Short: reported once the double-press window has passed
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(true, 120));
+  TEST_ASSERT_EQUAL(GESTURE_SHORT, setButton(false, BUTTON_DOUBLE_GAP + 10));
+
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(true, 120));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(false, 100));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(true, 120));
+  TEST_ASSERT_EQUAL(GESTURE_DOUBLE, setButton(false, BUTTON_DOUBLE_GAP + 10));
+
+  // Second press held: repeats until released
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(true, 120));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(false, 100));
+  gesturesSeen = 0;
+  TEST_ASSERT_EQUAL(GESTURE_REPEAT, setButton(true, BUTTON_REPEAT_DELAY + 3 * BUTTON_REPEAT_INTERVAL + 10));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(false, BUTTON_DOUBLE_GAP + 10));
+  TEST_ASSERT_EQUAL_UINT32(4, gesturesSeen);
+
+  // Long: fires while held, the release is swallowed
+  TEST_ASSERT_EQUAL(GESTURE_LONG, setButton(true, BUTTON_LONG_PRESS + 10));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(false, BUTTON_DOUBLE_GAP + 10));
+
+  // A press between short and long is ignored
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(true, BUTTON_SHORT_MAX + 100));
+  TEST_ASSERT_EQUAL(GESTURE_NONE, setButton(false, BUTTON_DOUBLE_GAP + 10));
+
+  // A tap shorter than the debounce: the release edge is dropped, and the
+  // pin read back once it has settled ends the press
+  uint32_t bounces = buttonStats().bounces;
+  hostSetPin(0, LOW);
+  hostAdvanceMillis(5);
+  hostSetPin(0, HIGH);
+  ButtonGesture tap = GESTURE_NONE;
+  for (unsigned long t = 0; t < BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_GAP + 10; t++)
+  {
+    ButtonGesture gesture = buttonPoll();
+    tap = gesture != GESTURE_NONE ? gesture : tap;
+    hostAdvanceMillis(1);
+  }
+  TEST_ASSERT_EQUAL(GESTURE_SHORT, tap);
+  TEST_ASSERT_EQUAL_UINT32(bounces + 1, buttonStats().bounces);
+
+  TEST_ASSERT_GREATER_THAN_UINT32(0, buttonStats().bounces);
+  TEST_ASSERT_EQUAL_UINT32(0, buttonStats().overflows);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_button_gestures);
+  return UNITY_END();
+}
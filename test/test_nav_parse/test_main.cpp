@@ -0,0 +1,282 @@
+// Navigation text parsers, and the distance countdown and refresh policy
+// built on them
+//
+//   pio test -e native -f test_nav_parse -v
+#include <unity.h>
+#include "host.h"
+#include "nav_parse.h"
+#include "nav_countdown.h"
+#include "refresh_policy.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void expectDistance(const char *text, uint32_t mm, uint8_t decimals)
+{
+  NavDistance parsed;
+  TEST_ASSERT_TRUE_MESSAGE(navParseDistance(text, parsed), text);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(mm, parsed.mm, text);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(decimals, parsed.decimals, text);
+
+  // Printed back at the same value it reads exactly as it came
+  char printed[NAV_TEXT_SHORT];
+  navFormatDistance(printed, sizeof(printed), parsed, parsed.mm);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(text, printed, text);
+}
+
+static void test_parse_distance()
+{
+  expectDistance("250m", 250000, 0);
+  expectDistance("250 m", 250000, 0);
+  expectDistance("250\xC2\xA0m", 250000, 0); // no-break space, as Android formats it
+  expectDistance("1.5 km", 1500000, 1);
+  expectDistance("2,4 km", 2400000, 1);
+  expectDistance("12 KM", 12000000, 0);
+  expectDistance("0.3 mi", 482803, 1);
+  expectDistance("800 ft", 243840, 0);
+  expectDistance("120 yd", 109728, 0);
+  expectDistance("4294.9 km", 4294900000u, 1);
+
+  NavDistance parsed;
+  parsed.mm = 1234;
+  const char *rejected[] = {"", "m", "km 5", "1.5", "abc", "12 parsecs", "1.2.3 km", "-5 m",
+                            "1234567 m", "5000 km", "250 m ahead", "250   m", "1.5 kms"};
+  for (const char *text : rejected)
+  {
+    TEST_ASSERT_FALSE_MESSAGE(navParseDistance(text, parsed), text);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1234, parsed.mm); // untouched on failure
+  TEST_ASSERT_TRUE(navParseDistance("  250 m  ", parsed));
+  TEST_ASSERT_EQUAL_UINT32(250000, parsed.mm);
+}
+
+static void test_format_distance()
+{
+  NavDistance km;
+  TEST_ASSERT_TRUE(navParseDistance("8.4 km", km));
+  char printed[NAV_TEXT_SHORT];
+  navFormatDistance(printed, sizeof(printed), km, 8350001);
+  TEST_ASSERT_EQUAL_STRING("8.4 km", printed); // nearest tenth
+  navFormatDistance(printed, sizeof(printed), km, 8349999);
+  TEST_ASSERT_EQUAL_STRING("8.3 km", printed);
+  navFormatDistance(printed, sizeof(printed), km, 950000);
+  TEST_ASSERT_EQUAL_STRING("950 m", printed); // under a kilometre
+  TEST_ASSERT_EQUAL_UINT32(100000, navDistanceStep(km, 8400000));
+  TEST_ASSERT_EQUAL_UINT32(1000, navDistanceStep(km, 950000));
+
+  NavDistance comma;
+  TEST_ASSERT_TRUE(navParseDistance("2,40km", comma));
+  navFormatDistance(printed, sizeof(printed), comma, 1050000);
+  TEST_ASSERT_EQUAL_STRING("1,05km", printed);
+  navFormatDistance(printed, 4, comma, 1050000);
+  TEST_ASSERT_EQUAL_STRING("1,0", printed); // truncated like snprintf
+}
+
+static void test_parse_speed_clock_duration()
+{
+  uint32_t speed = 0;
+  TEST_ASSERT_TRUE(navParseSpeed("42 km/h", speed));
+  TEST_ASSERT_EQUAL_UINT32(11666, speed);
+  TEST_ASSERT_TRUE(navParseSpeed("26 mph", speed));
+  TEST_ASSERT_EQUAL_UINT32(11623, speed);
+  TEST_ASSERT_TRUE(navParseSpeed("12.5 m/s", speed));
+  TEST_ASSERT_EQUAL_UINT32(12500, speed);
+  TEST_ASSERT_TRUE(navParseSpeed("0 km/h", speed));
+  TEST_ASSERT_EQUAL_UINT32(0, speed);
+  TEST_ASSERT_FALSE(navParseSpeed("42", speed));
+  TEST_ASSERT_FALSE(navParseSpeed("fast", speed));
+
+  uint16_t minute = 0;
+  TEST_ASSERT_TRUE(navParseClock("10:45", minute));
+  TEST_ASSERT_EQUAL_UINT32(645, minute);
+  TEST_ASSERT_TRUE(navParseClock("9:05 pm", minute));
+  TEST_ASSERT_EQUAL_UINT32(21 * 60 + 5, minute);
+  TEST_ASSERT_TRUE(navParseClock("12:10 AM", minute));
+  TEST_ASSERT_EQUAL_UINT32(10, minute);
+  TEST_ASSERT_TRUE(navParseClock("12:30 pm", minute));
+  TEST_ASSERT_EQUAL_UINT32(750, minute);
+  const char *badClocks[] = {"", "25:00", "10:60", "13:00 pm", "1045", "10:4", "10:45 later"};
+  for (const char *text : badClocks)
+  {
+    TEST_ASSERT_FALSE_MESSAGE(navParseClock(text, minute), text);
+  }
+
+  uint32_t seconds = 0;
+  TEST_ASSERT_TRUE(navParseDuration("12 min", seconds));
+  TEST_ASSERT_EQUAL_UINT32(720, seconds);
+  TEST_ASSERT_TRUE(navParseDuration("1 hr 5 min", seconds));
+  TEST_ASSERT_EQUAL_UINT32(3900, seconds);
+  TEST_ASSERT_TRUE(navParseDuration("1h05m", seconds));
+  TEST_ASSERT_EQUAL_UINT32(3900, seconds);
+  TEST_ASSERT_TRUE(navParseDuration("2 days 3 hours", seconds));
+  TEST_ASSERT_EQUAL_UINT32(2 * 86400 + 3 * 3600, seconds);
+  TEST_ASSERT_TRUE(navParseDuration("45 s", seconds));
+  TEST_ASSERT_EQUAL_UINT32(45, seconds);
+  const char *badDurations[] = {"", "min", "5 fortnights", "5", "1 h and 5 min"};
+  for (const char *text : badDurations)
+  {
+    TEST_ASSERT_FALSE_MESSAGE(navParseDuration(text, seconds), text);
+  }
+}
+
+static NavSnapshot packet(const char *title, const char *distance, const char *speed)
+{
+  NavSnapshot nav = {};
+  nav.active = true;
+  snprintf(nav.title, sizeof(nav.title), "%s", title);
+  snprintf(nav.distance, sizeof(nav.distance), "%s", distance);
+  snprintf(nav.speed, sizeof(nav.speed), "%s", speed);
+  snprintf(nav.eta, sizeof(nav.eta), "10:45");
+  snprintf(nav.duration, sizeof(nav.duration), "12 min");
+  return nav;
+}
+
+// Counted down from nav.speed between packets, snapped back by each one
+static void test_countdown()
+{
+  NavCountdown countdown;
+  NavSnapshot nav = packet("400 m", "8.4 km", "36 km/h"); // 10 m/s
+  TEST_ASSERT_TRUE(countdown.observe(nav, 0));
+  TEST_ASSERT_FALSE(countdown.observe(nav, 0)); // same text again
+  countdown.apply(nav, 0);
+  TEST_ASSERT_EQUAL_STRING("400 m", nav.title);
+  TEST_ASSERT_EQUAL_UINT32(645, countdown.figures().etaMinute);
+  TEST_ASSERT_EQUAL_UINT32(720, countdown.figures().durationS);
+  TEST_ASSERT_EQUAL_UINT32(NAV_COUNTDOWN_MIN_STEP_MS, countdown.msUntilStep(0));
+
+  TEST_ASSERT_FALSE(countdown.step(nav, 50)); // not due yet
+  TEST_ASSERT_TRUE(countdown.step(nav, 1000));
+  TEST_ASSERT_EQUAL_STRING("390 m", nav.title);
+  TEST_ASSERT_EQUAL_STRING("8.4 km", nav.distance);
+  TEST_ASSERT_TRUE(countdown.step(nav, 5100));
+  TEST_ASSERT_EQUAL_STRING("349 m", nav.title);
+  TEST_ASSERT_EQUAL_STRING("8.3 km", nav.distance);
+
+  // The phone stops sending: extrapolation stops after NAV_COUNTDOWN_MAX_MS
+  countdown.step(nav, 30000);
+  TEST_ASSERT_EQUAL_STRING("300 m", nav.title);
+  TEST_ASSERT_EQUAL_UINT32(NAV_COUNTDOWN_IDLE, countdown.msUntilStep(30000));
+
+  // A packet snaps back, even upwards
+  NavSnapshot next = packet("320 m", "8.2 km", "36 km/h");
+  TEST_ASSERT_TRUE(countdown.observe(next, 30000));
+  countdown.apply(next, 30000);
+  TEST_ASSERT_EQUAL_STRING("320 m", next.title);
+  TEST_ASSERT_EQUAL_STRING("8.2 km", next.distance);
+
+  // Stopped: nothing to count
+  NavSnapshot stopped = packet("320 m", "8.2 km", "0 km/h");
+  countdown.observe(stopped, 31000);
+  countdown.apply(stopped, 31000);
+  TEST_ASSERT_EQUAL_UINT32(NAV_COUNTDOWN_IDLE, countdown.msUntilStep(31000));
+  TEST_ASSERT_EQUAL_UINT32(0, countdown.stats().unparsed);
+}
+
+// Without nav.speed the turn distance's fall between packets sets the pace
+static void test_countdown_estimated_speed()
+{
+  NavCountdown countdown;
+  NavSnapshot nav = packet("400 m", "8.4 km", "");
+  countdown.observe(nav, 0);
+  countdown.apply(nav, 0);
+  TEST_ASSERT_EQUAL_UINT32(NAV_COUNTDOWN_IDLE, countdown.msUntilStep(0)); // no speed yet
+
+  nav = packet("380 m", "8.4 km", "");
+  countdown.observe(nav, 2000);
+  TEST_ASSERT_TRUE(countdown.figures().speedEstimated);
+  TEST_ASSERT_EQUAL_UINT32(10000, countdown.figures().speedMmS);
+  countdown.apply(nav, 2000);
+  countdown.step(nav, 3000);
+  TEST_ASSERT_EQUAL_STRING("370 m", nav.title);
+
+  // A new leg (the distance jumps up) keeps the pace; street names are not
+  // distances and are left alone
+  nav = packet("1.2 km", "8.1 km", "");
+  countdown.observe(nav, 4000);
+  TEST_ASSERT_EQUAL_UINT32(10000, countdown.figures().speedMmS);
+  nav = packet("Main St", "8.1 km", "");
+  countdown.observe(nav, 5000);
+  countdown.apply(nav, 5000);
+  TEST_ASSERT_EQUAL_STRING("Main St", nav.title);
+  TEST_ASSERT_FALSE(countdown.figures().hasTurn);
+}
+
+// The countdown runs between frames on the render task: no heap
+static void test_countdown_allocation_free()
+{
+  NavCountdown countdown;
+  NavSnapshot nav = packet("900 m", "8.4 km", "50 km/h");
+  HostHeapStats before = hostHeapStats();
+  uint32_t steps = 0;
+  countdown.observe(nav, 0);
+  countdown.apply(nav, 0);
+  for (unsigned long now = 0; now < NAV_COUNTDOWN_MAX_MS; now += 10)
+  {
+    steps += countdown.step(nav, now) ? 1 : 0;
+  }
+  printf("Countdown: %u steps over %u ms, %u allocations\n", steps, NAV_COUNTDOWN_MAX_MS,
+         hostHeapStats().allocations - before.allocations);
+  TEST_ASSERT_EQUAL_UINT32(before.allocations, hostHeapStats().allocations);
+  TEST_ASSERT_TRUE(steps > NAV_COUNTDOWN_MAX_MS / NAV_COUNTDOWN_MIN_STEP_MS / 2);
+}
+
+static RefreshMode adaptiveMode(const NavSnapshot &nav)
+{
+  return refreshAdaptive(refreshState(nav)).mode;
+}
+
+// Faster close to a turn, slower on a long leg and on the idle screens
+static void test_refresh_policy()
+{
+  NavSnapshot nav = packet("200 m", "8.4 km", "36 km/h");
+  nav.connected = true;
+  TEST_ASSERT_EQUAL_INT(REFRESH_APPROACH, adaptiveMode(nav));
+  snprintf(nav.title, sizeof(nav.title), "210 m");
+  TEST_ASSERT_EQUAL_INT(REFRESH_GUIDANCE, adaptiveMode(nav));
+  snprintf(nav.title, sizeof(nav.title), "5.1 km");
+  TEST_ASSERT_EQUAL_INT(REFRESH_CRUISE, adaptiveMode(nav));
+  snprintf(nav.title, sizeof(nav.title), "Main St"); // no distance to go by
+  TEST_ASSERT_EQUAL_INT(REFRESH_GUIDANCE, adaptiveMode(nav));
+  nav.active = false;
+  TEST_ASSERT_EQUAL_INT(REFRESH_IDLE, adaptiveMode(nav));
+  nav.connected = false;
+  TEST_ASSERT_EQUAL_INT(REFRESH_DISCONNECTED, adaptiveMode(nav));
+
+  // Each mode slower than the one closer to the turn
+  RefreshState state = {true, true, true, 100000};
+  RefreshRate approach = refreshAdaptive(state);
+  state.turnMm = 1000000;
+  RefreshRate guidance = refreshAdaptive(state);
+  state.turnMm = 20000000;
+  RefreshRate cruise = refreshAdaptive(state);
+  RefreshRate idle = refreshAdaptive({true, false, false, 0});
+  TEST_ASSERT_TRUE(approach.frameMs < guidance.frameMs && guidance.frameMs < cruise.frameMs);
+  TEST_ASSERT_TRUE(cruise.frameMs <= idle.frameMs && idle.heartbeatMs >= 60000);
+  TEST_ASSERT_EQUAL_UINT32(NAV_POLL_INTERVAL, refreshFixed(state).frameMs);
+
+  // The countdown steps no faster than the policy's frame interval
+  NavCountdown countdown;
+  nav = packet("900 m", "8.4 km", "90 km/h"); // metres at 25 m/s: always due
+  countdown.pace(guidance.frameMs);
+  countdown.observe(nav, 0);
+  countdown.apply(nav, 0);
+  TEST_ASSERT_EQUAL_UINT32(guidance.frameMs, countdown.msUntilStep(0));
+  countdown.pace(approach.frameMs);
+  countdown.apply(nav, 0);
+  TEST_ASSERT_EQUAL_UINT32(approach.frameMs, countdown.msUntilStep(0));
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_distance);
+  RUN_TEST(test_format_distance);
+  RUN_TEST(test_parse_speed_clock_duration);
+  RUN_TEST(test_countdown);
+  RUN_TEST(test_countdown_estimated_speed);
+  RUN_TEST(test_countdown_allocation_free);
+  RUN_TEST(test_refresh_policy);
+  return UNITY_END();
+}
@@ -0,0 +1,73 @@
+// Cycle-counter probes: histogram bucket maths, and the live profile of a
+// scenario run through the firmware
+//
+//   pio test -e native -f test_profiler -v
+#include <unity.h>
+#include <Wire.h>
+#include "app.h"
+#include "host.h"
+#include "panels.h"
+#include "scenarios.h"
+#include "profiler.h"
+
+void setup();
+
+static FakeSsd1306Panel oledPanel;
+
+void setUp() {}
+void tearDown() {}
+
+class StdoutPrint : public Print
+{
+public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  using Print::write;
+};
+
+// Bucket maths on known samples, then the live profile of one scenario
+static void test_profiler()
+{
+  profilerReset();
+  for (uint32_t i = 0; i < 98; i++)
+  {
+    profilerRecord(PROF_SAVE_TIME, 1000); // bucket 9: 512..1023
+  }
+  profilerRecord(PROF_SAVE_TIME, 5000);   // bucket 12
+  profilerRecord(PROF_SAVE_TIME, 100000); // bucket 16
+  const ProfileHistogram &h = profilerHistogram(PROF_SAVE_TIME);
+  TEST_ASSERT_EQUAL_UINT32(100, h.count);
+  TEST_ASSERT_EQUAL_UINT32(1000, h.minCycles);
+  TEST_ASSERT_EQUAL_UINT32(100000, h.maxCycles);
+  TEST_ASSERT_EQUAL_UINT32(1023, profilerPercentile(h, 50));
+  TEST_ASSERT_EQUAL_UINT32(8191, profilerPercentile(h, 99));
+  TEST_ASSERT_EQUAL_UINT32(100000, profilerPercentile(h, 100));
+
+  // DFS: 100 us at 80 MHz and at 240 MHz land in the same place
+  profilerReset();
+  hostSetCpuFreqMHz(80);
+  profilerRecord(PROF_SAVE_TIME, profilerCycles(8000));
+  hostSetCpuFreqMHz(240);
+  profilerRecord(PROF_SAVE_TIME, profilerCycles(24000));
+  TEST_ASSERT_EQUAL_UINT32(100 * PROF_CLOCK_MHZ, h.minCycles);
+  TEST_ASSERT_EQUAL_UINT32(100 * PROF_CLOCK_MHZ, h.maxCycles);
+
+  profilerReset();
+  Wire.detachAll();
+  Wire.attach(0x3C, &oledPanel);
+  hostSerialMute(true);
+  setup();
+  runScenario(navScenarios[0]);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, profilerHistogram(PROF_RENDER_OLED).count);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, profilerHistogram(PROF_CHRONOS_LOOP).count);
+  StdoutPrint out;
+  profilerDump(out);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_profiler);
+  return UNITY_END();
+}
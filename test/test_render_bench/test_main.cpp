@@ -0,0 +1,769 @@
+// Render benchmark: plays the scripted navigation scenarios on the host and
+// reports per-frame render time, I2C traffic and heap allocations.
+//
+//   pio test -e native -f test_render_bench -v
+#include <unity.h>
+#include <Wire.h>
+#include "app.h"
+#include "host.h"
+#include "panels.h"
+#include "scenarios.h"
+#include "render_task.h"
+#include "bitmap_blit.h"
+#include "profiler.h"
+#include "display_layout.h"
+#include "text_fit.h"
+#include "i2c_bus.h"
+#include "glcdfont.h"
+#include "nav_trace.h"
+#include <chrono>
+#include <SPIFFS.h>
+
+void setup();
+void loop();
+void enterDeepSleep();
+extern bool fastBoot;
+extern uint32_t bootFirstFrameUs;
+extern OledLayoutRenderer oledLayout;
+extern NavTraceWriter navTrace;
+
+static FakeSsd1306Panel oledPanel;
+static FakeHd44780Panel lcdPanel;
+
+void setUp() {}
+void tearDown() {}
+
+static void bootWith(uint8_t address, FakeI2cDevice *panel)
+{
+  Wire.detachAll();
+  Wire.attach(address, panel);
+  hostSerialMute(true);
+  setup();
+}
+
+static void runAll(const char *label)
+{
+  printf("\n--- %s ---\n", label);
+  for (size_t s = 0; s < navScenarioCount; s++)
+  {
+    ScenarioReport report = runScenario(navScenarios[s]);
+    printScenarioReport(navScenarios[s], report);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, report.frames);
+  }
+}
+
+static void test_oled_scenarios()
+{
+  bootWith(0x3C, &oledPanel);
+  TEST_ASSERT_TRUE(displays.has(DISPLAY_OLED));
+  TEST_ASSERT_FALSE(displays.has(DISPLAY_LCD));
+  runAll("OLED 128x64");
+  // What reached the panel must match what was drawn
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), oledPanel.ram(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+}
+
+static void test_lcd_scenarios()
+{
+  bootWith(0x27, &lcdPanel);
+  TEST_ASSERT_TRUE(displays.has(DISPLAY_LCD));
+  TEST_ASSERT_FALSE(displays.has(DISPLAY_OLED));
+  runAll("LCD 16x2");
+  // Both rows are driven: clock and link status on top, status below
+  char top[17];
+  snprintf(top, sizeof(top), "%02d:%02d BLE:X", Chronos.getHourC(), Chronos.getMinute());
+  TEST_ASSERT_EQUAL_STRING_LEN(top, lcdPanel.row(0), strlen(top));
+  TEST_ASSERT_EQUAL_STRING("Wait Chronos... ", lcdPanel.row(1));
+  const LcdFlushStats &lcdStats = lcdFlush.stats();
+  printf("LCD: %u frames, %u cells written, %u unchanged cells skipped, %u transactions\n",
+         lcdStats.frames, lcdStats.chars, lcdStats.skipped, lcdStats.transactions);
+}
+
+// Both panels on one bus: each shows the same model, and the OLED keeps its
+// frame rate while the LCD takes only every LCD_MIN_FRAME_MS-th model
+static void test_both_panels()
+{
+  Wire.detachAll();
+  Wire.attach(0x3C, &oledPanel);
+  Wire.attach(0x27, &lcdPanel);
+  hostSerialMute(true);
+  setup();
+  TEST_ASSERT_TRUE(displays.has(DISPLAY_OLED));
+  TEST_ASSERT_TRUE(displays.has(DISPLAY_LCD));
+  runAll("OLED + LCD");
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), oledPanel.ram(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+  TEST_ASSERT_EQUAL_STRING("Wait Chronos... ", lcdPanel.row(1));
+
+  // A distance countdown every 50 ms, as fast as the redraw trigger allows
+  NavSnapshot nav = {};
+  Navigation source = {};
+  source.active = true;
+  source.isNavigation = true;
+  source.title = "Main St";
+  source.directions = "Turn left";
+  navSnapshotFill(nav, source, true, "1.0");
+  snprintf(nav.clock, sizeof(nav.clock), "12:34");
+  nav.showNavigation = true;
+
+  DisplayStats oledBefore = *displays.stats(DISPLAY_OLED);
+  DisplayStats lcdBefore = *displays.stats(DISPLAY_LCD);
+  for (int i = 0; i < 40; i++)
+  {
+    snprintf(nav.distance, sizeof(nav.distance), "%d m", 400 - i * 10);
+    renderFrame(nav);
+    unsigned long start = millis();
+    while (!displayService())
+    {
+    }
+    TEST_ASSERT_TRUE(millis() - start < 50); // neither panel's transfer runs into the next model
+    hostAdvanceMillis(50 - (millis() - start));
+    displayAnimate();
+  }
+  // The last model reaches the LCD once its interval has passed
+  hostAdvanceMillis(LCD_MIN_FRAME_MS);
+  displayAnimate();
+  while (!displayService())
+  {
+  }
+  TEST_ASSERT_EQUAL_STRING("10 m    Turn lef", lcdPanel.row(1));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), oledPanel.ram(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+
+  const DisplayStats &oledStats = *displays.stats(DISPLAY_OLED);
+  const DisplayStats &lcdStats = *displays.stats(DISPLAY_LCD);
+  uint32_t oledFrames = oledStats.framesDone - oledBefore.framesDone;
+  uint32_t lcdFrames = lcdStats.framesDone - lcdBefore.framesDone;
+  printf("OLED + LCD: 40 models -> OLED %u frames, LCD %u frames (%u superseded)\n", oledFrames, lcdFrames,
+         lcdStats.superseded - lcdBefore.superseded);
+  TEST_ASSERT_EQUAL_UINT32(40, oledFrames);
+  TEST_ASSERT_TRUE(lcdFrames >= 40 * 50 / LCD_MIN_FRAME_MS && lcdFrames < 20);
+  TEST_ASSERT_GREATER_THAN_UINT32(lcdBefore.superseded, lcdStats.superseded);
+}
+
+// A slow LCD frame going out does not hold back the OLED marquee
+static void test_animate_beside_slow_panel()
+{
+  Wire.detachAll();
+  Wire.attach(0x3C, &oledPanel);
+  Wire.attach(0x27, &lcdPanel);
+  hostSerialMute(true);
+  setup();
+  NavSnapshot nav = {};
+  Navigation source = {};
+  source.active = true;
+  source.isNavigation = true;
+  source.title = "250m";
+  source.directions = "Turn left onto Kurfuerstendamm, then keep right towards Berlin Zentrum";
+  navSnapshotFill(nav, source, true, "1.0");
+  nav.connected = true;
+  nav.showNavigation = true;
+  renderFrame(nav);
+  while (!renderService())
+  {
+  }
+  hostAdvanceMillis(MARQUEE_PAUSE_MS);
+
+  // A new model every LCD_MIN_FRAME_MS, each rewriting every LCD cell at
+  // one slice per 25 ms (a bus shared with something slow): count the
+  // steps while the LCD sends
+  uint32_t steps = 0;
+  uint32_t lcdBusyMs = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    hostAdvanceMillis(LCD_MIN_FRAME_MS);
+    while (!renderService())
+    {
+    }
+    snprintf(nav.distance, sizeof(nav.distance), "%d.%d km", 9 - i, i);
+    lcdFlush.invalidate();
+    renderFrame(nav);
+    uint32_t lcdDone = displays.stats(DISPLAY_LCD)->framesDone;
+    uint32_t before = oledLayout.stats().marqueeSteps;
+    unsigned long start = millis();
+    for (int slice = 0; slice < 100 && displays.stats(DISPLAY_LCD)->framesDone == lcdDone; slice++)
+    {
+      renderService();
+      hostAdvanceMillis(25);
+    }
+    lcdBusyMs += millis() - start;
+    steps += oledLayout.stats().marqueeSteps - before;
+  }
+  printf("Marquee beside the LCD: %u steps in %u ms of LCD frames\n", steps, lcdBusyMs);
+  TEST_ASSERT_TRUE(lcdBusyMs >= 4 * MARQUEE_STEP_MS);
+  TEST_ASSERT_TRUE(steps >= lcdBusyMs / MARQUEE_STEP_MS / 2);
+}
+
+// The render path works only on the snapshot: drawing and sending frames
+// must not touch the heap at all
+static void renderWithoutHeap(const char *label)
+{
+  NavSnapshot nav = {};
+  Navigation source = {};
+  source.active = true;
+  source.isNavigation = true;
+  source.title = "Main St";
+  source.directions = "Turn left onto Main Street";
+  makeTurnIcon(source.icon, -1);
+  navSnapshotFill(nav, source, true, "1.0");
+  snprintf(nav.clock, sizeof(nav.clock), "12:34");
+  nav.showNavigation = true;
+
+  HostHeapStats before = hostHeapStats();
+  uint32_t freeBefore = ESP.getFreeHeap();
+  for (int i = 0; i < 50; i++)
+  {
+    snprintf(nav.distance, sizeof(nav.distance), "%d m", 500 - i * 10);
+    renderFrame(nav);
+    while (!displayService())
+    {
+    }
+  }
+  uint32_t allocations = hostHeapStats().allocations - before.allocations;
+  printf("%s: %u allocations over 50 frames, free heap %u -> %u\n", label, allocations,
+         freeBefore, ESP.getFreeHeap());
+  TEST_ASSERT_EQUAL_UINT32(0, allocations);
+  TEST_ASSERT_EQUAL_UINT32(freeBefore, ESP.getFreeHeap());
+}
+
+static void test_render_allocation_free()
+{
+  bootWith(0x3C, &oledPanel);
+  renderWithoutHeap("OLED");
+  bootWith(0x27, &lcdPanel);
+  renderWithoutHeap("LCD");
+}
+
+// blitBitmap() must produce exactly what drawBitmap() does, at every page
+// offset and for odd sizes, and be faster on the 48x48 turn icon
+static void test_blit_matches_drawBitmap()
+{
+  static uint8_t bitmap[48 * 6];
+  uint32_t seed = 1;
+  for (size_t i = 0; i < sizeof(bitmap); i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    bitmap[i] = seed >> 16;
+  }
+
+  const size_t size = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+  static uint8_t expected[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+  const int16_t sizes[][2] = {{48, 48}, {16, 16}, {13, 11}, {5, 3}};
+  const uint16_t colors[] = {SSD1306_WHITE, SSD1306_BLACK, SSD1306_INVERSE};
+  for (auto &dim : sizes)
+  {
+    for (uint16_t color : colors)
+    {
+      for (int16_t y = -3; y < 20; y++)
+      {
+        for (int16_t x : {-2, 0, 7, 70, SCREEN_WIDTH - dim[0] + 1})
+        {
+          // Start from a noisy background so clears and XOR show up
+          for (size_t i = 0; i < size; i++)
+          {
+            oled.getBuffer()[i] = (uint8_t)(i * 37 + y);
+          }
+          oled.drawBitmap(x, y, bitmap, dim[0], dim[1], color);
+          memcpy(expected, oled.getBuffer(), size);
+          for (size_t i = 0; i < size; i++)
+          {
+            oled.getBuffer()[i] = (uint8_t)(i * 37 + y);
+          }
+          blitBitmap(oled, x, y, bitmap, dim[0], dim[1], color);
+          TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, oled.getBuffer(), size);
+        }
+      }
+    }
+  }
+
+  const int runs = 20000;
+  auto time = [&](bool blit, int16_t y) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++)
+    {
+      if (blit)
+      {
+        blitBitmap(oled, 0, y, bitmap, 48, 48, SSD1306_WHITE);
+      }
+      else
+      {
+        oled.drawBitmap(0, y, bitmap, 48, 48, SSD1306_WHITE);
+      }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1000.0 / runs;
+  };
+  double gfx = time(false, 8);
+  double aligned = time(true, 8);
+  double unaligned = time(true, 5);
+  printf("48x48 icon: drawBitmap %.2f us | blit %.2f us aligned (%.1fx), %.2f us unaligned (%.1fx)\n",
+         gfx, aligned, gfx / aligned, unaligned, gfx / unaligned);
+  oled.clearDisplay();
+  TEST_ASSERT_TRUE(aligned < gfx);
+}
+
+// Turn icons repeat, so the cache should mostly hit, draw exactly what
+// drawBitmap() would, and come back warm from SPIFFS after a reboot
+static void test_icon_cache()
+{
+  SPIFFS.hostReset();
+  bootWith(0x3C, &oledPanel);
+  TEST_ASSERT_EQUAL_UINT32(0, iconCache.stats().restored);
+
+  runScenario(navScenarios[0]);
+  IconCacheStats warm = iconCache.stats();
+  printf("Icons: %u hits, %u misses, %.1f us saved\n", warm.hits, warm.misses,
+         warm.savedCycles / (double)PROF_CLOCK_MHZ);
+  TEST_ASSERT_GREATER_THAN_UINT32(warm.misses, warm.hits);
+
+  const size_t size = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+  static uint8_t expected[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+  uint8_t icon[NAV_ICON_BYTES];
+  for (int direction = -1; direction <= 1; direction++)
+  {
+    makeTurnIcon(icon, direction);
+    for (int16_t y : {8, 5})
+    {
+      oled.clearDisplay();
+      oled.drawBitmap(0, y, icon, 48, 48, SSD1306_WHITE);
+      memcpy(expected, oled.getBuffer(), size);
+      oled.clearDisplay();
+      iconCache.draw(oled, 0, y, icon);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, oled.getBuffer(), size);
+    }
+  }
+
+  // Deep sleep writes the cache; the next boot starts with it loaded
+  TEST_ASSERT_TRUE(iconCache.save(true));
+  bootWith(0x3C, &oledPanel);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, iconCache.stats().restored);
+  makeTurnIcon(icon, 1);
+  iconCache.draw(oled, 0, 8, icon);
+  TEST_ASSERT_EQUAL_UINT32(1, iconCache.stats().restoredHits);
+  TEST_ASSERT_EQUAL_UINT32(0, iconCache.stats().misses);
+  // ... and the hit counts as saved with the cost measured before the save
+  TEST_ASSERT_GREATER_THAN_UINT32(0, (uint32_t)iconCache.stats().savedCycles);
+}
+
+// Redrawing only the changed widget gives the same pixels as a full redraw
+static void test_layout_dirty_widgets()
+{
+  bootWith(0x3C, &oledPanel);
+  NavSnapshot nav = {};
+  Navigation source = {};
+  source.active = true;
+  source.isNavigation = true;
+  source.title = "250m";
+  source.eta = "10:45";
+  source.duration = "5 min";
+  source.distance = "2.3 km";
+  source.directions = "Turn left onto Main Street towards the station";
+  makeTurnIcon(source.icon, 1);
+  navSnapshotFill(nav, source, true, "1.0");
+
+  OledLayoutRenderer layout;
+  layout.draw(oled, iconCache, nav);
+  TEST_ASSERT_EQUAL_UINT32(OLED_WIDGET_COUNT, layout.stats().drawn);
+
+  snprintf(nav.title, sizeof(nav.title), "1.2km");
+  layout.draw(oled, iconCache, nav);
+  TEST_ASSERT_EQUAL_UINT32(OLED_WIDGET_COUNT + 1, layout.stats().drawn);
+  TEST_ASSERT_EQUAL_UINT32(OLED_WIDGET_COUNT - 1, layout.stats().skipped);
+
+  const size_t size = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+  static uint8_t partial[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+  memcpy(partial, oled.getBuffer(), size);
+  layout.invalidate();
+  layout.draw(oled, iconCache, nav);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), partial, size);
+
+  // LCD widgets clip to their own cells
+  char row[LAYOUT_LCD_COLS + 1] = "                ";
+  layoutLcdText(row, lcdNavLayout[LCD_DIRECTIONS], nav.directions);
+  TEST_ASSERT_EQUAL_STRING("        Turn lef", row);
+}
+
+// The constexpr metrics match the font bitmaps; wrapping and ellipsis
+// stay inside the box without allocating, unlike the String cut they replace
+static void test_text_fit()
+{
+  for (int c = TEXT_FIRST_GLYPH + 1; c <= TEXT_LAST_GLYPH; c++)
+  {
+    int left = -1, right = -1;
+    for (int column = 0; column < 5; column++)
+    {
+      if (font[c * 5 + column] != 0)
+      {
+        left = left < 0 ? column : left;
+        right = column;
+      }
+    }
+    uint8_t glyph = textGlyph((char)c);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(left, glyph >> 4, "left column");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(right - left + 1, glyph & 0x0F, "ink width");
+  }
+
+  TEST_ASSERT_EQUAL_UINT16(0, textWidth("", 0, 1));
+  TEST_ASSERT_EQUAL_UINT16(5, textWidth("W", 1, 1));
+  TEST_ASSERT_EQUAL_UINT16(2 * (4 + 3 + 6 + 5 + 5), textWidth("1.2km", 5, 2));
+
+  // Breaks between words, skips the space, never splits a word that fits
+  const char *text = "Turn left onto Main Street";
+  TextLine line = textWrap(text, 80, 1, false);
+  TEST_ASSERT_EQUAL_UINT32(14, line.length);
+  TEST_ASSERT_EQUAL_UINT32(15, line.next);
+  TEST_ASSERT_FALSE(line.ellipsis);
+  TEST_ASSERT_TRUE(textWidth(text, line.length, 1) <= 80);
+  line = textWrap(text + 15, 128, 1, true);
+  TEST_ASSERT_EQUAL_UINT32(11, line.length);
+  TEST_ASSERT_FALSE(line.ellipsis);
+
+  // A word wider than the line is split; the last line ends in "..."
+  line = textWrap("Kurfuerstendammstrasse", 48, 1, false);
+  TEST_ASSERT_TRUE(line.length > 0 && line.length < 22);
+  TEST_ASSERT_EQUAL_UINT32(line.length, line.next);
+  const char *longer = "Continue on the motorway for 12 km";
+  line = textWrap(longer, 78, 1, true);
+  TEST_ASSERT_TRUE(line.ellipsis);
+  TEST_ASSERT_TRUE(textWidth(longer, line.length, 1) + textAdvanceOf(TEXT_ELLIPSIS) <= 78);
+  TEST_ASSERT_NOT_EQUAL(' ', longer[line.length - 1]);
+
+  // Nothing is drawn outside the box
+  oled.clearDisplay();
+  oled.fillRect(0, 0, 128, 64, SSD1306_WHITE);
+  oled.fillRect(10, 20, 70, 16, SSD1306_BLACK);
+  textBox(oled, 10, 20, 70, 16, "Keep right at the fork towards the airport", 1, SSD1306_WHITE, true);
+  for (int16_t y = 0; y < 64; y++)
+  {
+    for (int16_t x = 0; x < 128; x++)
+    {
+      if (x < 10 || x >= 80 || y < 20 || y >= 36)
+      {
+        TEST_ASSERT_TRUE(oled.getPixel(x, y));
+      }
+    }
+  }
+
+  // Fitting cost: the old String cut against one textWrap() pass
+  const char *directions = "Turn left onto Main Street towards the station";
+  const int runs = 20000;
+  HostHeapStats before = hostHeapStats();
+  size_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; i++)
+  {
+    String cut = directions;
+    if (cut.length() > 21)
+    {
+      cut = cut.substring(0, 18) + "...";
+    }
+    sink += cut.length();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  uint32_t stringAllocations = hostHeapStats().allocations - before.allocations;
+  before = hostHeapStats();
+  for (int i = 0; i < runs; i++)
+  {
+    sink += textWrap(directions, 128, 1, true).length;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  uint32_t fitAllocations = hostHeapStats().allocations - before.allocations;
+  auto us = [&](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / 1000.0 / runs;
+  };
+  printf("Fit directions: String cut %.3f us, %.1f allocs | textWrap %.3f us, %u allocs (%zu)\n",
+         us(t0, t1), (double)stringAllocations / runs, us(t1, t2), fitAllocations, sink);
+  TEST_ASSERT_EQUAL_UINT32(0, fitAllocations);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, stringAllocations);
+}
+
+// Long directions scroll on the bottom page only, a few bytes per step
+static void test_marquee()
+{
+  bootWith(0x3C, &oledPanel);
+  NavSnapshot nav = {};
+  Navigation source = {};
+  source.active = true;
+  source.isNavigation = true;
+  source.title = "250m";
+  source.distance = "2.3 km";
+  source.directions = "Turn left onto Kurfuerstendamm, then keep right towards Berlin Zentrum";
+  source.speed = "0 km/h"; // standing still: only the marquee moves
+  navSnapshotFill(nav, source, true, "1.0");
+  nav.connected = true;
+  nav.showNavigation = true;
+  renderFrame(nav);
+  while (!displayService())
+  {
+  }
+  uint32_t pause = displayAnimate(); // resting at the start of the text
+  TEST_ASSERT_TRUE(pause > 0 && pause <= MARQUEE_PAUSE_MS);
+
+  const size_t size = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+  static uint8_t first[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+  memcpy(first, oled.getBuffer(), size);
+  hostAdvanceMillis(pause);
+  uint32_t stepsBefore = oledLayout.stats().marqueeSteps;
+  uint32_t steps = 0, maxBytes = 0, maxWindows = 0;
+  do
+  {
+    TEST_ASSERT_EQUAL_UINT32(0, displayAnimate());
+    while (!displayService())
+    {
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, oled.getBuffer(), size - SCREEN_WIDTH);
+    maxBytes = max(maxBytes, oledFlush.lastFrame().bytes);
+    maxWindows = max(maxWindows, oledFlush.lastFrame().windows);
+    steps++;
+    hostAdvanceMillis(oledLayout.msUntilAnimate());
+  } while (memcmp(first, oled.getBuffer(), size) != 0 && steps < 1000);
+  printf("Marquee: %u steps per pass, at most %u bytes / %u windows per step (full frame %u)\n", steps,
+         maxBytes, maxWindows, (unsigned)size);
+  TEST_ASSERT_EQUAL_UINT32(stepsBefore + steps, oledLayout.stats().marqueeSteps);
+  TEST_ASSERT_TRUE(steps > 50 && steps < 1000); // came back round to the start
+  TEST_ASSERT_TRUE(maxBytes < SCREEN_WIDTH + 32);
+
+  // Text that fits, or another screen, stops it
+  snprintf(nav.directions, sizeof(nav.directions), "Turn left onto Main Street");
+  renderFrame(nav);
+  TEST_ASSERT_EQUAL_UINT32(MARQUEE_IDLE, oledLayout.msUntilAnimate());
+  snprintf(nav.directions, sizeof(nav.directions), "%s", source.directions.c_str());
+  renderFrame(nav);
+  TEST_ASSERT_NOT_EQUAL(MARQUEE_IDLE, oledLayout.msUntilAnimate());
+  nav.page = PAGE_TRIP;
+  renderFrame(nav);
+  TEST_ASSERT_EQUAL_UINT32(MARQUEE_IDLE, oledLayout.msUntilAnimate());
+  while (!displayService())
+  {
+  }
+}
+
+// Each panel gets the fastest clock it passes the self-test at; a stuck
+// SDA line is released, and a frame hit by it is resent until the panel
+// matches the buffer
+static void test_i2c_bus()
+{
+  oledPanel.maxClock = I2C_CLOCK_FAST_PLUS;
+  bootWith(0x3C, &oledPanel);
+  TEST_ASSERT_EQUAL_UINT32(I2C_CLOCK_FAST_PLUS, i2cBus.device(OLED_ADDRESS)->clock);
+  oledPanel.maxClock = I2C_CLOCK_FAST;
+  bootWith(0x3C, &oledPanel);
+  TEST_ASSERT_EQUAL_UINT32(I2C_CLOCK_FAST, i2cBus.device(OLED_ADDRESS)->clock);
+
+  lcdPanel.maxClock = I2C_CLOCK_STANDARD; // readback fails at 400 kHz
+  bootWith(0x27, &lcdPanel);
+  TEST_ASSERT_EQUAL_UINT32(I2C_CLOCK_STANDARD, i2cBus.device(LCD_ADDRESS)->clock);
+  TEST_ASSERT_EQUAL(0, i2cBus.device(OLED_ADDRESS)->clock);
+  lcdPanel.maxClock = I2C_CLOCK_FAST;
+
+  // A slave holding SDA for five more bits: the write fails, the pulses free it
+  bootWith(0x3C, &oledPanel);
+  I2cBusStats before = i2cBus.stats();
+  uint32_t errors = i2cBus.device(OLED_ADDRESS)->errors;
+  oled.fillRect(0, 0, 128, 64, SSD1306_WHITE);
+  oledFlush.commit();
+  hostI2cStuck(I2C_SDA_PIN, I2C_SCL_PIN, 5);
+  uint32_t steps = 0;
+  while (!oledFlush.step() && steps < 1000)
+  {
+    steps++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(before.stuck + 1, i2cBus.stats().stuck);
+  TEST_ASSERT_EQUAL_UINT32(before.recoveries + 1, i2cBus.stats().recoveries);
+  TEST_ASSERT_EQUAL_UINT32(errors + 1, i2cBus.device(OLED_ADDRESS)->errors);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), oledPanel.ram(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+
+  // Held for longer than nine pulses: reported, and the next flush still ends
+  hostI2cStuck(I2C_SDA_PIN, I2C_SCL_PIN, 20);
+  oled.clearDisplay();
+  oledFlush.flush();
+  TEST_ASSERT_EQUAL_UINT32(before.failedRecoveries + 1, i2cBus.stats().failedRecoveries);
+  hostI2cStuck(I2C_SDA_PIN, I2C_SCL_PIN, 0);
+
+  // A NACK partway through the data: not resent by the bus (the panel
+  // already took some of it), so the flush repairs the frame itself
+  uint32_t retries = i2cBus.device(OLED_ADDRESS)->retries;
+  errors = i2cBus.device(OLED_ADDRESS)->errors;
+  oled.fillRect(0, 0, 128, 64, SSD1306_WHITE);
+  oled.fillRect(10, 10, 60, 30, SSD1306_BLACK);
+  Wire.nackData(3);
+  oledFlush.flush();
+  TEST_ASSERT_EQUAL_UINT32(retries, i2cBus.device(OLED_ADDRESS)->retries);
+  TEST_ASSERT_EQUAL_UINT32(errors + 3, i2cBus.device(OLED_ADDRESS)->errors);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), oledPanel.ram(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+
+  // A device that stops answering: a write fails at once, a probe is
+  // retried, then reported
+  Wire.detachAll();
+  const uint8_t nop = 0xE3;
+  TEST_ASSERT_FALSE(i2cBus.write(OLED_ADDRESS, 0x00, &nop, 1));
+  TEST_ASSERT_EQUAL_UINT32(retries, i2cBus.device(OLED_ADDRESS)->retries);
+  TEST_ASSERT_FALSE(i2cBus.probe(OLED_ADDRESS));
+  TEST_ASSERT_EQUAL_UINT32(retries + I2C_PROBE_RETRIES, i2cBus.device(OLED_ADDRESS)->retries);
+  Wire.attach(OLED_ADDRESS, &oledPanel);
+  TEST_ASSERT_TRUE(i2cBus.probe(OLED_ADDRESS));
+  TEST_ASSERT_TRUE(i2cBus.write(OLED_ADDRESS, 0x00, &nop, 1));
+}
+
+// Boot until the first frame is on the panel; returns the bus transactions
+static uint32_t bootToFirstFrame(uint8_t address, FakeI2cDevice *panel)
+{
+  bootFirstFrameUs = 0;
+  Wire.resetStats();
+  bootWith(address, panel);
+  while (bootFirstFrameUs == 0)
+  {
+    loop();
+    hostAdvanceMillis(1);
+  }
+  return Wire.stats().transactions;
+}
+
+// A button wake reuses the display found before sleeping: no probe, no
+// panel init, no splash screens
+static void test_fast_boot()
+{
+  const struct
+  {
+    uint8_t address;
+    FakeI2cDevice *panel;
+  } panels[] = {{0x3C, &oledPanel}, {0x27, &lcdPanel}};
+
+  for (const auto &display : panels)
+  {
+    hostReboot(0);
+    hostSetWakeupCause(ESP_SLEEP_WAKEUP_UNDEFINED);
+    hostSetPin(0, LOW); // BOOT held at power-up
+    uint32_t coldTransactions = bootToFirstFrame(display.address, display.panel);
+    uint32_t coldUs = bootFirstFrameUs;
+    uint32_t coldClock = i2cBus.device(display.address)->clock;
+    TEST_ASSERT_FALSE(fastBoot);
+    hostSetPin(0, HIGH);
+
+    try
+    {
+      enterDeepSleep();
+    }
+    catch (const HostDeepSleep &)
+    {
+    }
+    hostReboot(60000);
+    hostSetWakeupCause(ESP_SLEEP_WAKEUP_EXT0);
+    uint32_t fastTransactions = bootToFirstFrame(display.address, display.panel);
+    TEST_ASSERT_TRUE(fastBoot);
+    TEST_ASSERT_EQUAL_UINT32(coldClock, i2cBus.device(display.address)->clock);
+    printf("0x%02X first frame: cold %lu us / %lu tx, wake %lu us / %lu tx\n", display.address,
+           (unsigned long)coldUs, (unsigned long)coldTransactions, (unsigned long)bootFirstFrameUs,
+           (unsigned long)fastTransactions);
+    TEST_ASSERT_LESS_THAN_UINT32(coldTransactions, fastTransactions);
+  }
+
+  // The cached panel (the LCD) is gone and an OLED is fitted instead: the
+  // first write fails and the bus is probed as on a cold boot
+  try
+  {
+    enterDeepSleep();
+  }
+  catch (const HostDeepSleep &)
+  {
+  }
+  hostReboot(60000);
+  hostSetWakeupCause(ESP_SLEEP_WAKEUP_EXT0);
+  bootToFirstFrame(0x3C, &oledPanel);
+  TEST_ASSERT_TRUE(fastBoot);
+  TEST_ASSERT_TRUE(displays.has(DISPLAY_OLED));
+  TEST_ASSERT_FALSE(displays.has(DISPLAY_LCD));
+}
+
+// A drive captured with "trace on" replays to the same Chronos state,
+// with telemetry and log output mixed into the capture
+static void test_trace_replay()
+{
+  bootWith(0x3C, &oledPanel);
+  FILE *capture = tmpfile();
+  TEST_ASSERT_NOT_NULL(capture);
+  hostSerialCapture(capture);
+  uint32_t linesBefore = navTrace.stats().lines;
+  hostSerialInput("trace on\n");
+  ScenarioReport recorded = runScenario(navScenarios[0]);
+  hostSerialInput("trace off\n");
+  loop();
+  hostSerialCapture(nullptr);
+  uint32_t lines = navTrace.stats().lines - linesBefore;
+  Navigation last = Chronos.getNavigation();
+
+  Chronos.hostSetNavigation(Navigation{});
+  Chronos.hostSetConnected(false);
+  bootWith(0x3C, &oledPanel);
+  rewind(capture);
+  TraceReplayOptions options;
+  ScenarioReport replayed = replayTrace(capture, options);
+  fclose(capture);
+
+  NavScenario recordedRun = navScenarios[0];
+  NavScenario replayRun = {"replay", "city_turns trace", replayed.durationMs, true, nullptr};
+  printf("Trace: %u lines for %u ms of driving\n", lines, recorded.durationMs);
+  printScenarioReport(recordedRun, recorded);
+  printScenarioReport(replayRun, replayed);
+  TEST_ASSERT_EQUAL_UINT32(lines, replayed.events);
+  TEST_ASSERT_EQUAL_UINT32(0, replayed.rejectedLines);
+  Navigation now = Chronos.getNavigation();
+  TEST_ASSERT_EQUAL_STRING(last.title.c_str(), now.title.c_str());
+  TEST_ASSERT_EQUAL_STRING(last.directions.c_str(), now.directions.c_str());
+  TEST_ASSERT_EQUAL_STRING(last.duration.c_str(), now.duration.c_str());
+  TEST_ASSERT_EQUAL_MEMORY(last.icon, now.icon, sizeof(now.icon));
+  TEST_ASSERT_TRUE(replayed.latencySamples > 0);
+  TEST_ASSERT_TRUE(replayed.frames >= recorded.frames / 2);
+}
+
+// The adaptive policy against one fixed rate: faster into the city turns,
+// quieter on the disconnected screen
+static void test_refresh_policy()
+{
+  const NavScenario &city = navScenarios[0];
+  const NavScenario &disconnected = navScenarios[navScenarioCount - 1];
+  ScenarioReport fixed[2], adaptive[2];
+  bootWith(0x3C, &oledPanel);
+  redrawTrigger.setPolicy(refreshFixed);
+  fixed[0] = runScenario(city);
+  fixed[1] = runScenario(disconnected);
+
+  bootWith(0x3C, &oledPanel);
+  redrawTrigger.setPolicy(refreshAdaptive);
+  uint32_t changesBefore = redrawTrigger.stats().rateChanges;
+  adaptive[0] = runScenario(city);
+  uint32_t changes = redrawTrigger.stats().rateChanges - changesBefore;
+  adaptive[1] = runScenario(disconnected);
+  TEST_ASSERT_EQUAL_INT(REFRESH_DISCONNECTED, redrawTrigger.rate().mode);
+
+  printf("\n--- refresh: fixed / adaptive ---\n");
+  for (int i = 0; i < 2; i++)
+  {
+    const NavScenario &scenario = i == 0 ? city : disconnected;
+    printScenarioReport(scenario, fixed[i]);
+    printScenarioReport(scenario, adaptive[i]);
+  }
+  printf("Refresh mode changes over %s: %u\n", city.name, changes);
+  TEST_ASSERT_TRUE(changes >= 2 * city.durationMs / 40000); // into and out of each turn
+  TEST_ASSERT_GREATER_THAN_UINT32(fixed[0].frames, adaptive[0].frames);
+  TEST_ASSERT_LESS_THAN_UINT32(fixed[1].frames, adaptive[1].frames);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_oled_scenarios);
+  RUN_TEST(test_lcd_scenarios);
+  RUN_TEST(test_both_panels);
+  RUN_TEST(test_animate_beside_slow_panel);
+  RUN_TEST(test_render_allocation_free);
+  RUN_TEST(test_blit_matches_drawBitmap);
+  RUN_TEST(test_icon_cache);
+  RUN_TEST(test_layout_dirty_widgets);
+  RUN_TEST(test_text_fit);
+  RUN_TEST(test_marquee);
+  RUN_TEST(test_i2c_bus);
+  RUN_TEST(test_fast_boot);
+  RUN_TEST(test_trace_replay);
+  RUN_TEST(test_refresh_policy);
+  return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// Golden images of the OLED screens: each sample goes through the real
+// render path and the bus to the simulated panel, and what is on the glass
+// must match test/test_render_golden/golden/<sample>.pbm pixel for pixel.
+// A mismatch leaves <sample>.pbm (actual) and <sample>.diff.pbm (the
+// differing pixels) in .pio/golden/.
+//
+//   pio test -e native -f test_render_golden -v
+//   GOLDEN_UPDATE=1 pio test -e native -f test_render_golden   rewrite the goldens
+#include <unity.h>
+#include <Wire.h>
+#include <chrono>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "app.h"
+#include "host.h"
+#include "panels.h"
+#include "scenarios.h"
+#include "render_task.h"
+#include "frame_image.h"
+
+#define GOLDEN_DIR "test/test_render_golden/golden"
+#define GOLDEN_OUT ".pio/golden"
+#define FRAME_BYTES (SCREEN_WIDTH * SCREEN_HEIGHT / 8)
+
+void setup();
+
+static FakeSsd1306Panel oledPanel;
+
+void setUp() {}
+void tearDown() {}
+
+static NavSnapshot navigation(const char *title, const char *directions, int icon)
+{
+  NavSnapshot nav = {};
+  nav.connected = true;
+  nav.active = true;
+  nav.isNavigation = true;
+  nav.showNavigation = true;
+  nav.page = PAGE_MAIN;
+  snprintf(nav.clock, sizeof(nav.clock), "12:34");
+  snprintf(nav.title, sizeof(nav.title), "%s", title);
+  snprintf(nav.eta, sizeof(nav.eta), "10:45");
+  snprintf(nav.duration, sizeof(nav.duration), "5 min");
+  snprintf(nav.distance, sizeof(nav.distance), "2.3 km");
+  snprintf(nav.speed, sizeof(nav.speed), "0 km/h");
+  snprintf(nav.directions, sizeof(nav.directions), "%s", directions);
+  if (icon >= -1 && icon <= 1)
+  {
+    nav.hasIcon = true;
+    makeTurnIcon(nav.icon, icon);
+  }
+  return nav;
+}
+
+struct GoldenSample
+{
+  const char *name;
+  NavSnapshot nav;
+};
+
+static const uint8_t *renderToPanel(const NavSnapshot &nav)
+{
+  renderFrame(nav);
+  while (!displayService())
+  {
+  }
+  return oledPanel.ram();
+}
+
+static void test_golden_frames()
+{
+  Wire.detachAll();
+  Wire.attach(0x3C, &oledPanel);
+  hostSerialMute(true);
+  setup();
+
+  GoldenSample samples[] = {
+      {"nav_left_turn", navigation("250 m", "Turn left onto Main Street", -1)},
+      {"nav_long_directions",
+       navigation("1.2 km", "Turn right onto Kurfuerstendamm, then keep left towards Berlin Zentrum", 1)},
+      {"nav_no_icon", navigation("Main St", "Continue straight", 2)},
+      {"nav_clipped", navigation("12345 m", "Keep", 0)},
+      {"trip_page", navigation("250 m", "Turn left onto Main Street", -1)},
+      {"connected_idle", {}},
+      {"disconnected", {}},
+  };
+  snprintf(samples[3].nav.eta, sizeof(samples[3].nav.eta), "10:45 AM");
+  snprintf(samples[3].nav.duration, sizeof(samples[3].nav.duration), "1 hr 25 min");
+  snprintf(samples[3].nav.distance, sizeof(samples[3].nav.distance), "1234.5 km");
+  samples[4].nav.page = PAGE_TRIP;
+  samples[5].nav.connected = true;
+  snprintf(samples[5].nav.clock, sizeof(samples[5].nav.clock), "12:34");
+  snprintf(samples[6].nav.clock, sizeof(samples[6].nav.clock), "12:34");
+
+  bool update = getenv("GOLDEN_UPDATE") != nullptr;
+  mkdir(".pio", 0755);
+  mkdir(GOLDEN_OUT, 0755);
+  uint32_t failed = 0;
+  for (const GoldenSample &sample : samples)
+  {
+    const uint8_t *frame = renderToPanel(sample.nav);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(oled.getBuffer(), frame, FRAME_BYTES);
+
+    char path[96];
+    snprintf(path, sizeof(path), GOLDEN_DIR "/%s.pbm", sample.name);
+    if (update)
+    {
+      TEST_ASSERT_TRUE_MESSAGE(writePbm(path, frame, SCREEN_WIDTH, SCREEN_HEIGHT), path);
+      continue;
+    }
+
+    static uint8_t golden[FRAME_BYTES];
+    static uint8_t diff[FRAME_BYTES];
+    uint32_t pixels = FRAME_BYTES * 8;
+    if (readPbm(path, golden, SCREEN_WIDTH, SCREEN_HEIGHT))
+    {
+      pixels = frameDiff(golden, frame, diff, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+    printf("%-20s %4u pixels differ\n", sample.name, pixels);
+    if (pixels != 0)
+    {
+      failed++;
+      snprintf(path, sizeof(path), GOLDEN_OUT "/%s.pbm", sample.name);
+      writePbm(path, frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+      snprintf(path, sizeof(path), GOLDEN_OUT "/%s.diff.pbm", sample.name);
+      writePbm(path, diff, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, failed, "frames differ from their golden image, see " GOLDEN_OUT);
+}
+
+// Layout sweep: every text length through the same path as the goldens
+static void test_batch_render()
+{
+  static const char words[] = "Turn right onto Kurfuerstendamm, then keep left towards Berlin Zentrum";
+  const uint32_t count = 5000;
+  uint32_t mismatches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < count; i++)
+  {
+    char title[NAV_TEXT_SHORT];
+    snprintf(title, sizeof(title), "%u m", (unsigned)(i * 37 % 100000));
+    NavSnapshot nav = navigation(title, "", (int)(i % 4) - 1);
+    snprintf(nav.directions, sizeof(nav.directions), "%.*s", (int)(i % sizeof(words)), words);
+    const uint8_t *frame = renderToPanel(nav);
+    mismatches += memcmp(oled.getBuffer(), frame, FRAME_BYTES) != 0 ? 1 : 0;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Batch render: %u samples in %.3f s, %.0f samples/s through the panel\n", count, seconds,
+         count / seconds);
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// The PNG writer: signature, size and 4x scaling of a known frame
+static void test_png_writer()
+{
+  static uint8_t frame[FRAME_BYTES];
+  memset(frame, 0, sizeof(frame));
+  frame[0] = 0x01; // pixel (0, 0)
+  char path[] = "/tmp/writer_testXXXXXX"; // a scratch file, gone after the test
+  int fd = mkstemp(path);
+  TEST_ASSERT_TRUE(fd >= 0);
+  close(fd);
+  bool written = writePng(path, frame, SCREEN_WIDTH, SCREEN_HEIGHT, 4);
+  uint8_t head[24];
+  size_t got = 0;
+  FILE *file = fopen(path, "rb");
+  if (file != nullptr)
+  {
+    got = fread(head, 1, sizeof(head), file);
+    fclose(file);
+  }
+  remove(path);
+  TEST_ASSERT_TRUE(written);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(head), got);
+  TEST_ASSERT_EQUAL_MEMORY("\x89PNG\r\n\x1A\n", head, 8);
+  TEST_ASSERT_EQUAL_UINT32(SCREEN_WIDTH * 4, head[16] << 24 | head[17] << 16 | head[18] << 8 | head[19]);
+  TEST_ASSERT_EQUAL_UINT32(SCREEN_HEIGHT * 4, head[20] << 24 | head[21] << 16 | head[22] << 8 | head[23]);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_golden_frames);
+  RUN_TEST(test_batch_render);
+  RUN_TEST(test_png_writer);
+  return UNITY_END();
+}
@@ -0,0 +1,205 @@
+// Route log: delta records, page-sized flash writes, the segment ring and
+// recovery from a torn page
+//
+//   pio test -e native -f test_route_log -v
+#include <unity.h>
+#include <SPIFFS.h>
+#include <string>
+#include "host.h"
+#include "route_log.h"
+
+void setUp()
+{
+  FS::hostReset();
+  routeLogBegin(&SPIFFS);
+}
+
+void tearDown() {}
+
+class CapturePrint : public Print
+{
+public:
+  size_t write(uint8_t c) override
+  {
+    text += (char)c;
+    return 1;
+  }
+  using Print::write;
+  std::string text;
+};
+
+static NavSnapshot packet(unsigned metres)
+{
+  NavSnapshot nav = {};
+  nav.connected = true;
+  nav.active = true;
+  nav.isNavigation = true;
+  snprintf(nav.title, sizeof(nav.title), "%u m", metres);
+  snprintf(nav.distance, sizeof(nav.distance), "8.4 km");
+  snprintf(nav.eta, sizeof(nav.eta), "10:45");
+  snprintf(nav.duration, sizeof(nav.duration), "12 min");
+  snprintf(nav.speed, sizeof(nav.speed), "36 km/h");
+  snprintf(nav.directions, sizeof(nav.directions), "Turn left onto Main St");
+  return nav;
+}
+
+static std::string dump()
+{
+  CapturePrint out;
+  routeLogDump(out);
+  return out.text;
+}
+
+static uint8_t segmentFiles()
+{
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < ROUTE_LOG_SEGMENTS; i++)
+  {
+    char path[16];
+    snprintf(path, sizeof(path), "/route%u.log", (unsigned)i);
+    count += SPIFFS.exists(path) ? 1 : 0;
+  }
+  return count;
+}
+
+// Only what changed is kept, and nothing reaches flash until a page is done
+static void test_delta_records()
+{
+  routeLogRecord(packet(400), 0);
+  routeLogRecord(packet(400), 500); // nothing new
+  NavSnapshot turn = packet(380);
+  routeLogRecord(turn, 2000);
+  turn.connected = false;
+  routeLogRecord(turn, 2500);
+  TEST_ASSERT_EQUAL_UINT32(3, routeLogStats().records);
+  routeLogService();
+  TEST_ASSERT_EQUAL_UINT32(0, FS::hostWriteBytes());
+
+  std::string text = dump();
+  printf("%s", text.c_str());
+  TEST_ASSERT_EQUAL_UINT32(ROUTE_LOG_PAGE_BYTES, FS::hostWriteBytes()); // the dump sealed one page
+  TEST_ASSERT_TRUE(text.find(" flags=7 title=\"400 m\" distance=\"8.4 km\" eta=\"10:45\" duration=\"12 min\" "
+                             "speed=\"36 km/h\" directions=\"Turn left onto Main St\" icon=00000000\r\n") !=
+                   std::string::npos);
+  TEST_ASSERT_TRUE(text.find(" title=\"380 m\"\r\n") != std::string::npos);
+  TEST_ASSERT_TRUE(text.find(" flags=6\r\n") != std::string::npos);
+  TEST_ASSERT_TRUE(text.find("=== 1 pages, 0 damaged ===") != std::string::npos);
+}
+
+// Recording is RAM only and allocation free; pages are written whole, one
+// at a time
+static void test_pages_written_whole()
+{
+  HostHeapStats before = hostHeapStats();
+  for (unsigned i = 0; i < 200; i++)
+  {
+    routeLogRecord(packet(1000 - i), i * 1000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(before.allocations, hostHeapStats().allocations);
+  TEST_ASSERT_EQUAL_UINT32(0, FS::hostWriteBytes());
+
+  const RouteLogStats &stats = routeLogStats();
+  TEST_ASSERT_TRUE(stats.sealed + stats.dropped > 0);
+  routeLogService();
+  TEST_ASSERT_EQUAL_UINT32(1, stats.written); // one page program per writer run
+  routeLogFlush();
+  printf("Route log: %u records in %u pages, %u dropped, %u bytes written\n", stats.records, stats.written,
+         stats.dropped, FS::hostWriteBytes());
+  TEST_ASSERT_EQUAL_UINT32(stats.written * ROUTE_LOG_PAGE_BYTES, FS::hostWriteBytes());
+  TEST_ASSERT_EQUAL_UINT32(stats.sealed, stats.written);
+}
+
+// The ring keeps ROUTE_LOG_SEGMENTS files and the newest pages
+static void test_wraparound()
+{
+  unsigned long now = 0;
+  uint32_t target = ROUTE_LOG_SEGMENTS * ROUTE_LOG_SEGMENT_PAGES + ROUTE_LOG_SEGMENT_PAGES / 2;
+  for (unsigned i = 0; routeLogStats().written < target; i++, now += 1000)
+  {
+    routeLogRecord(packet(i % 1000), now);
+    routeLogService();
+  }
+  routeLogFlush();
+  TEST_ASSERT_EQUAL_UINT32(0, routeLogStats().dropped);
+  TEST_ASSERT_EQUAL_UINT8(ROUTE_LOG_SEGMENTS, segmentFiles());
+
+  // After a reboot the log goes on where it stopped
+  uint32_t written = routeLogStats().written;
+  routeLogBegin(&SPIFFS);
+  TEST_ASSERT_EQUAL_UINT32(0, routeLogStats().damaged);
+  uint32_t newestSegment = (written - 1) % ROUTE_LOG_SEGMENT_PAGES + 1;
+  TEST_ASSERT_EQUAL_UINT32((ROUTE_LOG_SEGMENTS - 1) * ROUTE_LOG_SEGMENT_PAGES + newestSegment,
+                           routeLogStats().stored);
+  routeLogRecord(packet(5), now);
+  routeLogFlush();
+  std::string text = dump();
+  TEST_ASSERT_EQUAL_UINT8(ROUTE_LOG_SEGMENTS, segmentFiles());
+  size_t last = text.rfind("title=");
+  TEST_ASSERT_TRUE(last != std::string::npos);
+  TEST_ASSERT_EQUAL_STRING("title=\"5 m\"", text.substr(last, 11).c_str());
+
+  // The oldest segment lost the pages its deltas were against, so it and
+  // every other segment open with a full record
+  size_t first = text.find('\n') + 1;
+  TEST_ASSERT_TRUE(text.find(" flags=7 ", first) < text.find('\n', first));
+  unsigned full = 0;
+  for (size_t at = text.find(" directions="); at != std::string::npos; at = text.find(" directions=", at + 1))
+  {
+    full++;
+  }
+  TEST_ASSERT_TRUE(full >= ROUTE_LOG_SEGMENTS);
+}
+
+// A write cut short by a power loss is skipped and never appended to
+static void test_torn_page()
+{
+  for (unsigned i = 0; i < 3; i++)
+  {
+    routeLogRecord(packet(900 - i), i * 1000);
+  }
+  routeLogFlush();
+  TEST_ASSERT_EQUAL_UINT32(1, routeLogStats().written);
+
+  // Half a page, then a whole page of garbage
+  uint8_t junk[ROUTE_LOG_PAGE_BYTES + ROUTE_LOG_PAGE_BYTES / 2];
+  memset(junk, 0x5A, sizeof(junk));
+  File file = SPIFFS.open("/route0.log", FILE_APPEND);
+  file.write(junk, sizeof(junk));
+  file.close();
+
+  routeLogBegin(&SPIFFS);
+  TEST_ASSERT_EQUAL_UINT32(1, routeLogStats().stored);
+  TEST_ASSERT_EQUAL_UINT32(1, routeLogStats().damaged);
+  routeLogRecord(packet(700), 10000);
+  routeLogFlush();
+  TEST_ASSERT_TRUE(SPIFFS.exists("/route1.log")); // a new segment, not after the tear
+
+  std::string text = dump();
+  printf("%s", text.c_str());
+  TEST_ASSERT_TRUE(text.find("title=\"898 m\"") < text.find("title=\"700 m\""));
+  TEST_ASSERT_TRUE(text.find("=== 2 pages, 1 damaged ===") != std::string::npos);
+}
+
+// Without flash nothing is kept and nothing fails
+static void test_no_flash()
+{
+  routeLogBegin(nullptr);
+  routeLogRecord(packet(400), 0);
+  routeLogService();
+  routeLogFlush();
+  TEST_ASSERT_EQUAL_UINT32(0, routeLogStats().records);
+  TEST_ASSERT_TRUE(dump().find("no flash") != std::string::npos);
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_delta_records);
+  RUN_TEST(test_pages_written_whole);
+  RUN_TEST(test_wraparound);
+  RUN_TEST(test_torn_page);
+  RUN_TEST(test_no_flash);
+  return UNITY_END();
+}
@@ -0,0 +1,57 @@
+// Time kept in RTC memory across deep sleep, with an hourly NVS copy
+//
+//   pio test -e native -f test_time_keeper -v
+#include <unity.h>
+#include <sys/time.h>
+#include <Preferences.h>
+#include "host.h"
+#include "time_keeper.h"
+
+void setUp() {}
+void tearDown() {}
+
+// The wall clock as the firmware set it
+static time_t wallClock()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec;
+}
+
+// Time asleep comes back from the RTC timer; flash is written
+// at most hourly however often the device sleeps
+static void test_time_keeper()
+{
+  const time_t start = 1750000000;
+  struct timeval tv = {start, 0};
+  settimeofday(&tv, NULL);
+  uint32_t writes = Preferences::hostWriteCount();
+
+  for (int cycle = 0; cycle < 10; cycle++)
+  {
+    hostAdvanceMillis(30000);
+    timeKeeperService();
+    timeKeeperBeforeSleep();
+    hostReboot(60000);
+    timeKeeperBegin(true);
+    TEST_ASSERT_EQUAL(TIME_FROM_RTC, timeKeeperStats().source);
+    TEST_ASSERT_EQUAL_UINT32(60000, timeKeeperStats().sleptMs);
+  }
+  TEST_ASSERT_EQUAL(start + 10 * 90, wallClock());
+  TEST_ASSERT_EQUAL_UINT32(1, Preferences::hostWriteCount() - writes);
+
+  // Power loss: RTC memory is gone, NVS brings back the last hourly copy
+  hostReboot(0);
+  timeKeeperBegin(false);
+  TEST_ASSERT_EQUAL(TIME_FROM_NVS, timeKeeperStats().source);
+  TEST_ASSERT_EQUAL(start + 30, wallClock());
+}
+
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_time_keeper);
+  return UNITY_END();
+}
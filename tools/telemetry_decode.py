@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Telemetry decoder
+Turns the binary telemetry records the firmware writes to Serial back into
+readable log lines. Plain text on the same port (boot messages) is passed
+through unchanged.
+
+    python tools/telemetry_decode.py capture.bin
+    python tools/telemetry_decode.py /dev/ttyUSB0      (needs pyserial)
+    pio device monitor --raw | python tools/telemetry_decode.py -
+
+The event table is read from include/telemetry.h, so the decoder always
+matches the firmware it was checked out with.
+"""
+
+import os
+import re
+import struct
+import sys
+
+SYNC = b'\xa5\x5a'
+RECORD = struct.Struct('<IBBHII')  # us, event, level, a, b, c
+FRAME_SIZE = len(SYNC) + RECORD.size + 1
+
+LEVELS = {1: 'E', 2: 'I', 3: 'D'}
+TEXT_FIELDS = ['title', 'eta', 'duration', 'distance', 'directions', 'speed']
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'include', 'telemetry.h')
+
+
+def load_events(header=HEADER):
+    """Event names and formats, in enum order, from the TELEMETRY_EVENTS table"""
+    with open(header) as f:
+        source = f.read()
+    return re.findall(r'X\((TEL_\w+),\s*"((?:[^"\\]|\\.)*)"\)', source)
+
+
+class Decoder:
+    def __init__(self, events, out=sys.stdout):
+        self.events = events
+        self.out = out
+        self.buffer = b''
+        self.last_us = None
+        self.base_us = 0  # adds 2^32 for every micros() wrap
+        self.text = {}
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                # Keep a possible half sync byte for the next read
+                keep = 1 if self.buffer.endswith(SYNC[:1]) else 0
+                self.passthrough(self.buffer[:len(self.buffer) - keep])
+                self.buffer = self.buffer[len(self.buffer) - keep:]
+                return
+            if start > 0:
+                self.passthrough(self.buffer[:start])
+                self.buffer = self.buffer[start:]
+            if len(self.buffer) < FRAME_SIZE:
+                return
+
+            payload = self.buffer[len(SYNC):len(SYNC) + RECORD.size]
+            if sum(payload) & 0xFF != self.buffer[FRAME_SIZE - 1]:
+                # Not a record after all (or corrupted); treat as text
+                self.passthrough(self.buffer[:1])
+                self.buffer = self.buffer[1:]
+                continue
+            self.record(*RECORD.unpack(payload))
+            self.buffer = self.buffer[FRAME_SIZE:]
+
+    def passthrough(self, data):
+        if data:
+            self.out.write(data.decode('utf-8', errors='replace'))
+
+    def timestamp(self, us):
+        if self.last_us is not None and us < self.last_us:
+            self.base_us += 1 << 32
+        self.last_us = us
+        return (self.base_us + us) / 1e6
+
+    def record(self, us, event, level, a, b, c):
+        seconds = self.timestamp(us)
+        if event >= len(self.events):
+            self.emit(seconds, level, f'unknown event {event}: a={a} b={b} c={c}')
+            return
+
+        name, fmt = self.events[event]
+        if fmt == '%t':
+            self.text_chunk(seconds, level, a, b, c)
+            return
+        message = fmt.replace('%a', str(a)).replace('%b', str(b)).replace('%c', str(c))
+        self.emit(seconds, level, message)
+
+    def text_chunk(self, seconds, level, a, b, c):
+        field, offset = a >> 8, a & 0xFF
+        chunk = struct.pack('<II', b, c)
+        parts = self.text.setdefault(field, bytearray())
+        if offset == 0:
+            parts.clear()
+        parts += chunk
+        end = parts.find(b'\0')
+        if end >= 0:
+            name = TEXT_FIELDS[field] if field < len(TEXT_FIELDS) else f'field {field}'
+            value = parts[:end].decode('utf-8', errors='replace')
+            self.emit(seconds, level, f'nav {name}: {value}')
+            parts.clear()
+
+    def emit(self, seconds, level, message):
+        self.out.write(f'[{seconds:10.3f}] {LEVELS.get(level, "?")} {message}\n')
+
+
+def open_input(path):
+    if path == '-':
+        return sys.stdin.buffer
+    if path.startswith('/dev/') or path.upper().startswith('COM'):
+        import serial  # pyserial
+        return serial.Serial(path, 115200, timeout=0.1)
+    return open(path, 'rb')
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip())
+        return 1
+
+    decoder = Decoder(load_events())
+    source = open_input(sys.argv[1])
+    try:
+        while True:
+            data = source.read(256)
+            if not data:
+                if hasattr(source, 'in_waiting'):
+                    continue  # serial port: keep waiting
+                break
+            decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())